@@ -18,18 +18,13 @@ int main(void) {
     debugUart.begin();
     debugUart.sendString("MPU6050 WHO_AM_I test\r\n");
 
-    const uint8_t cfg[2] = {0x6B, 0x00};
-    if (!i2c.writeMessage(0x68, cfg, 2)) {
+    if (!i2c.writeRegister(0x68, 0x6B, 0x00)) {
         debugUart.sendString("Wake write failed\r\n");
     }
 
-    uint8_t reg = 0x75;
-    if (!i2c.writeMessage(0x68, &reg, 1)) {
-        debugUart.sendString("WHO_AM_I pointer write failed\r\n");
-    }
-
+    // Register pointer write + repeated START + read in one transaction
     uint8_t whoami = 0xFF;
-    if (!i2c.readMessage(0x68, &whoami, 1)) {
+    if (!i2c.readRegister(0x68, 0x75, whoami)) {
         debugUart.sendString("Read failed\r\n");
     } else {
         debugUart.sendString("WHO_AM_I: 0x");
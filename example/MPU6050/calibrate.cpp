@@ -0,0 +1,121 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <protocol_UART.h>
+#include <device_MPU6050.h>
+
+// Bias calibration kept in EEPROM. On reset the offsets saved by an earlier
+// run are written back into the sensor; if there are none (or
+// FORCE_CALIBRATION is set) the board must lie still and level, Z axis up,
+// for about 2.5 s while calibrate() measures the bias, then the offsets
+// are saved. After that it prints the mean of 100 samples once per second
+// in mg and centi-°/s: about 0,0,1000 and 0,0,0 at rest, with no
+// correction done on the AVR.
+// MPU6050 on A4/A5 (TWI at 400 kHz).
+
+static constexpr bool FORCE_CALIBRATION = false;
+static constexpr uint16_t OFFSETS_EEPROM_ADDRESS = 0;
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+static MPU6050 mpu(&PINC, &DDRC, &PORTC, PC4,   // SDA
+                   &PINC, &DDRC, &PORTC, PC5);  // SCL
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void debugPrintSigned(int32_t value) {
+    if (value < 0) {
+        debugUart.sendByte('-');
+        debugPrintDecimal((uint32_t)(-value));
+    } else {
+        debugPrintDecimal((uint32_t)value);
+    }
+}
+
+static void halt(const char *message) {
+    debugUart.sendString(message);
+    while (1) {
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("MPU6050 calibration\r\n");
+
+    mpu.setBackend(I2C::Backend::Hardware);
+    mpu.setClock(400000);
+    if (!mpu.initialize() || !mpu.setDigitalLowPass(1) || !mpu.setSampleRate(1000)) {
+        halt("setup failed\r\n");
+    }
+
+    if (!FORCE_CALIBRATION && mpu.restoreOffsets(OFFSETS_EEPROM_ADDRESS)) {
+        debugUart.sendString("offsets restored from EEPROM\r\n");
+    } else {
+        debugUart.sendString("calibrating, keep still...\r\n");
+        if (!mpu.calibrate() || !mpu.saveOffsets(OFFSETS_EEPROM_ADDRESS)) {
+            halt("calibration failed\r\n");
+        }
+        debugUart.sendString("offsets saved\r\n");
+    }
+
+    MPU6050::Offsets offsets;
+    if (mpu.readOffsets(offsets)) {
+        debugUart.sendString("accel offsets=");
+        debugPrintSigned(offsets.accel_x);
+        debugUart.sendString(",");
+        debugPrintSigned(offsets.accel_y);
+        debugUart.sendString(",");
+        debugPrintSigned(offsets.accel_z);
+        debugUart.sendString(" gyro offsets=");
+        debugPrintSigned(offsets.gyro_x);
+        debugUart.sendString(",");
+        debugPrintSigned(offsets.gyro_y);
+        debugUart.sendString(",");
+        debugPrintSigned(offsets.gyro_z);
+        debugUart.sendString("\r\n");
+    }
+
+    while (1) {
+        int32_t sums[6] = {0, 0, 0, 0, 0, 0};
+        MPU6050::MPU6050_Fixed sample;
+        for (uint8_t i = 0; i < 100; ++i) {
+            if (mpu.readAllSensors(sample)) {
+                sums[0] += sample.accel_x;
+                sums[1] += sample.accel_y;
+                sums[2] += sample.accel_z;
+                sums[3] += sample.gyro_x;
+                sums[4] += sample.gyro_y;
+                sums[5] += sample.gyro_z;
+            }
+            _delay_ms(1);
+        }
+
+        debugUart.sendString("accel=");
+        debugPrintSigned(sums[0] / 100);
+        debugUart.sendString(",");
+        debugPrintSigned(sums[1] / 100);
+        debugUart.sendString(",");
+        debugPrintSigned(sums[2] / 100);
+        debugUart.sendString(" mg gyro=");
+        debugPrintSigned(sums[3] / 100);
+        debugUart.sendString(",");
+        debugPrintSigned(sums[4] / 100);
+        debugUart.sendString(",");
+        debugPrintSigned(sums[5] / 100);
+        debugUart.sendString(" cdps\r\n");
+        _delay_ms(900);
+    }
+
+    return 0;
+}
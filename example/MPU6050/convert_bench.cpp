@@ -0,0 +1,118 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <protocol_UART.h>
+#include <device_MPU6050.h>
+
+// Cycles per converted sample, float vs fixed point. Each round fetches one
+// sample with startReadAllSensors() on the TWI engine, waits for it, then
+// times collectAllSensors() with Timer1 at clk/1 (TCNT1 counts CPU cycles).
+// collectAllSensors() does no bus work, so the figure is the conversion of
+// one 14-byte burst into MPU6050_Data (float g, °/s, °C) or MPU6050_Fixed
+// (mg, centi-°/s, centi-°C). Once per pass it prints the mean cycles of both
+// and the last sample in each form.
+// MPU6050 on A4/A5 (TWI at 400 kHz).
+
+static constexpr uint16_t ROUNDS = 256;
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+static MPU6050 mpu(&PINC, &DDRC, &PORTC, PC4,   // SDA
+                   &PINC, &DDRC, &PORTC, PC5);  // SCL
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void debugPrintSigned(int32_t value) {
+    if (value < 0) {
+        debugUart.sendByte('-');
+        debugPrintDecimal((uint32_t)(-value));
+    } else {
+        debugPrintDecimal((uint32_t)value);
+    }
+}
+
+static bool fetch() {
+    if (!mpu.startReadAllSensors()) {
+        return false;
+    }
+    while (mpu.asyncReadPending()) {
+    }
+    return true;
+}
+
+template <typename Sample>
+static uint32_t measure(Sample &sample) {
+    uint32_t cycles = 0;
+    uint16_t rounds = 0;
+    for (uint16_t i = 0; i < ROUNDS; ++i) {
+        if (!fetch()) {
+            continue;
+        }
+        uint16_t start = TCNT1;
+        bool ok = mpu.collectAllSensors(sample);
+        uint16_t elapsed = (uint16_t)(TCNT1 - start);
+        if (ok) {
+            cycles += elapsed;
+            rounds++;
+        }
+    }
+    return rounds ? cycles / rounds : 0;
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("MPU6050 conversion benchmark\r\n");
+
+    if (!mpu.setBackend(I2C::Backend::Hardware)) {
+        debugUart.sendString("TWI backend unavailable\r\n");
+        while (1) {
+        }
+    }
+    mpu.setClock(400000);
+    if (!mpu.initialize()) {
+        debugUart.sendString("MPU6050 not responding\r\n");
+        while (1) {
+        }
+    }
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+    MPU6050::MPU6050_Data floatSample;
+    MPU6050::MPU6050_Fixed fixedSample;
+    while (1) {
+        uint32_t floatCycles = measure(floatSample);
+        uint32_t fixedCycles = measure(fixedSample);
+
+        debugUart.sendString("float=");
+        debugPrintDecimal(floatCycles);
+        debugUart.sendString(" cycles fixed=");
+        debugPrintDecimal(fixedCycles);
+        debugUart.sendString(" cycles | az=");
+        debugPrintSigned((int32_t)(floatSample.accel_z * 1000.0f));
+        debugUart.sendString("/");
+        debugPrintSigned(fixedSample.accel_z);
+        debugUart.sendString(" mg gx=");
+        debugPrintSigned((int32_t)(floatSample.gyro_x * 100.0f));
+        debugUart.sendString("/");
+        debugPrintSigned(fixedSample.gyro_x);
+        debugUart.sendString(" cdps t=");
+        debugPrintSigned((int32_t)(floatSample.temperature * 100.0f));
+        debugUart.sendString("/");
+        debugPrintSigned(fixedSample.temperature);
+        debugUart.sendString(" cC\r\n");
+        _delay_ms(1000);
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <protocol_UART.h>
+#include <device_MPU6050.h>
+
+// 500 Hz sampling paced by the MPU6050 data-ready interrupt. The INT pin
+// (wired to D2, INT0) pulses once per sample; the main loop reads a sample
+// only when dataReady() says one arrived, so no bus time goes on re-reading
+// an old sample. Once per second (Timer1 at clk/1024) it prints the samples
+// read, the samples skipped because the loop was late (0 unless something
+// blocks it for longer than a 2 ms sample period) and the latest sample.
+// MPU6050 on A4/A5 (TWI at 400 kHz), INT on D2.
+
+static constexpr uint16_t SAMPLE_RATE_HZ = 500;
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+static MPU6050 mpu(&PINC, &DDRC, &PORTC, PC4,   // SDA
+                   &PINC, &DDRC, &PORTC, PC5,   // SCL
+                   &PIND, &DDRD, &PORTD, PD2);  // INT
+
+static const uint16_t TICKS_PER_SECOND = (uint16_t)(F_CPU / 1024UL);
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void debugPrintSigned(int16_t value) {
+    if (value < 0) {
+        debugUart.sendByte('-');
+        debugPrintDecimal((uint32_t)(-(int32_t)value));
+    } else {
+        debugPrintDecimal((uint32_t)value);
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("MPU6050 data-ready interrupt\r\n");
+
+    mpu.setBackend(I2C::Backend::Hardware);
+    mpu.setClock(400000);
+    if (!mpu.initialize() || !mpu.setDigitalLowPass(1) || !mpu.setSampleRate(SAMPLE_RATE_HZ) || !mpu.enableInterrupt()) {
+        debugUart.sendString("setup failed\r\n");
+        while (1) {
+        }
+    }
+
+    MPU6050::RawSample sample = {};
+    uint32_t samples = 0;
+    uint16_t skippedBefore = 0;
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10);
+    TCNT1 = 0;
+    while (1) {
+        if (mpu.dataReady() && mpu.readReadySample(sample)) {
+            samples++;
+        }
+
+        if (TCNT1 < TICKS_PER_SECOND) {
+            continue;
+        }
+        TCNT1 = 0;
+
+        uint16_t skipped = mpu.skippedSamples();
+        debugUart.sendString("samples=");
+        debugPrintDecimal(samples);
+        debugUart.sendString(" skipped=");
+        debugPrintDecimal((uint16_t)(skipped - skippedBefore));
+        debugUart.sendString(" accel=");
+        debugPrintSigned(sample.accel_x);
+        debugUart.sendString(",");
+        debugPrintSigned(sample.accel_y);
+        debugUart.sendString(",");
+        debugPrintSigned(sample.accel_z);
+        debugUart.sendString(" gyro=");
+        debugPrintSigned(sample.gyro_x);
+        debugUart.sendString(",");
+        debugPrintSigned(sample.gyro_y);
+        debugUart.sendString(",");
+        debugPrintSigned(sample.gyro_z);
+        debugUart.sendString("\r\n");
+        samples = 0;
+        skippedBefore = skipped;
+    }
+
+    return 0;
+}
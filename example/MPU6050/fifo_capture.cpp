@@ -0,0 +1,107 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <protocol_UART.h>
+#include <device_MPU6050.h>
+
+// 1 kHz capture through the MPU6050 FIFO. The main loop drains the FIFO into
+// a ring, then stalls for 40 ms every tenth pass (standing in for a blocking
+// DFPlayer command); the FIFO covers the stall, so the count stays at 1000
+// samples per second with no overflows. Once per second (Timer1 at clk/1024)
+// it prints samples consumed, FIFO overflows and the latest sample.
+// MPU6050 on A4/A5 (TWI at 400 kHz).
+
+static constexpr uint16_t SAMPLE_RATE_HZ = 1000;
+static constexpr uint16_t STALL_MS = 40;
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+static MPU6050 mpu(&PINC, &DDRC, &PORTC, PC4,   // SDA
+                   &PINC, &DDRC, &PORTC, PC5);  // SCL
+
+static const uint16_t TICKS_PER_SECOND = (uint16_t)(F_CPU / 1024UL);
+
+static MPU6050::RawSample ringStorage[64];
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void debugPrintSigned(int16_t value) {
+    if (value < 0) {
+        debugUart.sendByte('-');
+        debugPrintDecimal((uint32_t)(-(int32_t)value));
+    } else {
+        debugPrintDecimal((uint32_t)value);
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("MPU6050 FIFO capture\r\n");
+
+    mpu.setBackend(I2C::Backend::Hardware);
+    mpu.setClock(400000);
+    if (!mpu.initialize() || !mpu.setDigitalLowPass(1) || !mpu.setSampleRate(SAMPLE_RATE_HZ) || !mpu.startFifo()) {
+        debugUart.sendString("setup failed\r\n");
+        while (1) {
+        }
+    }
+
+    MPU6050::SampleRing ring = {ringStorage, sizeof(ringStorage) / sizeof(ringStorage[0]), 0, 0};
+    MPU6050::RawSample sample = {};
+    uint32_t consumed = 0;
+    uint8_t pass = 0;
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10);
+    TCNT1 = 0;
+    while (1) {
+        if (!mpu.drainFifo(ring)) {
+            debugUart.sendString("drain failed\r\n");
+        }
+        while (ring.pop(sample)) {
+            consumed++;
+        }
+
+        if (++pass == 10) {
+            pass = 0;
+            _delay_ms(STALL_MS);
+        }
+
+        if (TCNT1 < TICKS_PER_SECOND) {
+            continue;
+        }
+        TCNT1 = 0;
+
+        debugUart.sendString("samples=");
+        debugPrintDecimal(consumed);
+        debugUart.sendString(" overflows=");
+        debugPrintDecimal(mpu.fifoOverflows());
+        debugUart.sendString(" accel=");
+        debugPrintSigned(sample.accel_x);
+        debugUart.sendString(",");
+        debugPrintSigned(sample.accel_y);
+        debugUart.sendString(",");
+        debugPrintSigned(sample.accel_z);
+        debugUart.sendString(" gyro=");
+        debugPrintSigned(sample.gyro_x);
+        debugUart.sendString(",");
+        debugPrintSigned(sample.gyro_y);
+        debugUart.sendString(",");
+        debugPrintSigned(sample.gyro_z);
+        debugUart.sendString("\r\n");
+        consumed = 0;
+    }
+
+    return 0;
+}
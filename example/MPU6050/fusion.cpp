@@ -0,0 +1,115 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <protocol_UART.h>
+#include <device_MPU6050.h>
+#include <device_MPU6050Fusion.h>
+
+// Roll, pitch and yaw from the fixed-point Mahony filter at 200 Hz. Samples
+// are paced by the data-ready interrupt (INT on D2); each one goes through
+// MPU6050Fusion::update(), timed with Timer1 at clk/1 (TCNT1 counts CPU
+// cycles). Gyro offsets saved by calibrate.cpp are restored first, otherwise
+// yaw drifts by the raw gyro bias. Once per second (200 samples) it prints
+// the attitude in centi-degrees, the mean and worst cycles per update and
+// the cycles for one getEulerAngles().
+// MPU6050 on A4/A5 (TWI at 400 kHz), INT on D2.
+
+static constexpr uint16_t SAMPLE_RATE_HZ = 200;
+static constexpr uint8_t GYRO_RANGE = 1; // ±500°/s
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+static MPU6050 mpu(&PINC, &DDRC, &PORTC, PC4,   // SDA
+                   &PINC, &DDRC, &PORTC, PC5,   // SCL
+                   &PIND, &DDRD, &PORTD, PD2);  // INT
+static MPU6050Fusion fusion;
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void debugPrintSigned(int16_t value) {
+    if (value < 0) {
+        debugUart.sendByte('-');
+        debugPrintDecimal((uint32_t)(-(int32_t)value));
+    } else {
+        debugPrintDecimal((uint32_t)value);
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("MPU6050 attitude fusion\r\n");
+
+    mpu.setBackend(I2C::Backend::Hardware);
+    mpu.setClock(400000);
+    if (!mpu.initialize() || !mpu.setGyroRange(GYRO_RANGE) || !mpu.setDigitalLowPass(3) ||
+        !mpu.setSampleRate(SAMPLE_RATE_HZ) || !mpu.enableInterrupt() ||
+        !fusion.begin(SAMPLE_RATE_HZ, (uint8_t)mpu.getGyroRange())) {
+        debugUart.sendString("setup failed\r\n");
+        while (1) {
+        }
+    }
+    if (!mpu.restoreOffsets()) {
+        debugUart.sendString("no saved offsets, yaw will drift\r\n");
+    }
+
+    MPU6050::RawSample sample;
+    uint32_t updateCycles = 0;
+    uint16_t worstCycles = 0;
+    uint16_t updates = 0;
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+    while (1) {
+        if (!mpu.dataReady() || !mpu.readReadySample(sample)) {
+            continue;
+        }
+
+        uint16_t start = TCNT1;
+        fusion.update(sample);
+        uint16_t cycles = (uint16_t)(TCNT1 - start);
+        updateCycles += cycles;
+        if (cycles > worstCycles) {
+            worstCycles = cycles;
+        }
+        if (++updates < SAMPLE_RATE_HZ) {
+            continue;
+        }
+
+        int16_t roll;
+        int16_t pitch;
+        int16_t yaw;
+        start = TCNT1;
+        fusion.getEulerAngles(roll, pitch, yaw);
+        uint16_t eulerCycles = (uint16_t)(TCNT1 - start);
+
+        debugUart.sendString("roll=");
+        debugPrintSigned(roll);
+        debugUart.sendString(" pitch=");
+        debugPrintSigned(pitch);
+        debugUart.sendString(" yaw=");
+        debugPrintSigned(yaw);
+        debugUart.sendString(" update=");
+        debugPrintDecimal(updateCycles / updates);
+        debugUart.sendString(" cycles (worst ");
+        debugPrintDecimal(worstCycles);
+        debugUart.sendString(") euler=");
+        debugPrintDecimal(eulerCycles);
+        debugUart.sendString(" cycles\r\n");
+        updateCycles = 0;
+        worstCycles = 0;
+        updates = 0;
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <protocol_UART.h>
+#include <device_MPU6050.h>
+
+// Achievable readAllSensors() rate for each I2C engine.
+// Wire the MPU6050 to A4 (SDA) / A5 (SCL) so the TWI peripheral can be used.
+// Each configuration reads back to back for one second (Timer1 at clk/1024).
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static MPU6050 mpu(&PINC, &DDRC, &PORTC, PC4,   // SDA
+                   &PINC, &DDRC, &PORTC, PC5);  // SCL
+
+static const uint16_t TICKS_PER_SECOND = (uint16_t)(F_CPU / 1024UL);
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void measure(const char *label) {
+    uint16_t samples = 0;
+    uint16_t failures = 0;
+    MPU6050::MPU6050_Data data;
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10);
+    TCNT1 = 0;
+    while (TCNT1 < TICKS_PER_SECOND) {
+        if (mpu.readAllSensors(data)) {
+            samples++;
+        } else {
+            failures++;
+        }
+    }
+
+    debugUart.sendString(label);
+    debugUart.sendString(": ");
+    debugPrintDecimal(samples);
+    debugUart.sendString(" samples/s, ");
+    debugPrintDecimal(failures);
+    debugUart.sendString(" failed\r\n");
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("MPU6050 sample rate benchmark\r\n");
+
+    _delay_ms(100);
+    if (!mpu.initialize()) {
+        debugUart.sendString("MPU6050 not responding\r\n");
+        while (1) {
+        }
+    }
+
+    mpu.setBackend(I2C::Backend::Software);
+    mpu.setClock(100000UL);
+    measure("bit-banged 100 kHz");
+    mpu.setClock(400000UL);
+    measure("bit-banged 400 kHz");
+
+    if (mpu.setBackend(I2C::Backend::Hardware)) {
+        mpu.setClock(100000UL);
+        measure("TWI        100 kHz");
+        mpu.setClock(400000UL);
+        measure("TWI        400 kHz");
+    }
+
+    while (1) {
+    }
+
+    return 0;
+}
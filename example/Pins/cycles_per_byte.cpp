@@ -0,0 +1,119 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <protocol_SPI.h>
+#include <protocol_I2C.h>
+#include <protocol_UART.h>
+
+// Cycles-per-byte comparison: pointer-based protocol classes vs the
+// compile-time *Pins template variants on the same pins.
+// Timer1 runs at clk/1, so TCNT1 deltas are CPU cycles.
+//
+// SPI runs with zero phase delays (pure pin-toggle cost).
+// I2C writes the MPU6050 WHO_AM_I register pointer (needs a device at 0x68).
+// UART prints the cycles spent per byte at 115200 baud next to the ideal
+// frame time, showing how closely each form hits the bit timing.
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+static UARTPins<PortD, PD1> debugUartPins(115200UL);
+
+static SPI spi(&PINB, &DDRB, &PORTB, PB3,
+               &PINB, &DDRB, &PORTB, PB4,
+               &PINB, &DDRB, &PORTB, PB5,
+               &PINB, &DDRB, &PORTB, PB2);
+static SPIPins<PortB, PB3, PortB, PB4, PortB, PB5, PortB, PB2> spiPins;
+
+static I2C i2c(&PINC, &DDRC, &PORTC, PC4, &PINC, &DDRC, &PORTC, PC5);
+static I2CPins<PortC, PC4, PortC, PC5> i2cPins;
+
+static const uint8_t SPI_BYTES = 32;
+static const uint8_t UART_BYTES = 8;
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void printResult(const char *label, uint16_t cycles, uint8_t bytes) {
+    debugUart.sendString(label);
+    debugUart.sendString(": ");
+    debugPrintDecimal(cycles / bytes);
+    debugUart.sendString(" cycles/byte\r\n");
+}
+
+static inline void timerStart() {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+    TCNT1 = 0;
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUartPins.begin();
+    debugUart.sendString("Pointer vs compile-time pins (cycles per byte)\r\n");
+
+    uint8_t payload[SPI_BYTES];
+    for (uint8_t i = 0; i < SPI_BYTES; ++i) {
+        payload[i] = (uint8_t)(i * 37);
+    }
+
+    spi.begin();
+    spi.setDelaysMicroseconds(0, 0);
+    timerStart();
+    spi.transferBytes(payload, payload, SPI_BYTES);
+    uint16_t spiCycles = TCNT1;
+
+    spiPins.begin();
+    spiPins.setDelayLoops(0, 0);
+    timerStart();
+    spiPins.transferBytes(payload, payload, SPI_BYTES);
+    uint16_t spiPinsCycles = TCNT1;
+
+    const uint8_t whoAmI = 0x75;
+    i2c.setDelay(1);
+    timerStart();
+    bool i2cOk = i2c.writeMessage(0x68, &whoAmI, 1);
+    uint16_t i2cCycles = TCNT1;
+
+    i2cPins.setDelay(1);
+    timerStart();
+    bool i2cPinsOk = i2cPins.writeMessage(0x68, &whoAmI, 1);
+    uint16_t i2cPinsCycles = TCNT1;
+
+    timerStart();
+    debugUart.sendBytes((const uint8_t *)"........", UART_BYTES);
+    uint16_t uartCycles = TCNT1;
+
+    timerStart();
+    debugUartPins.sendBytes((const uint8_t *)"........", UART_BYTES);
+    uint16_t uartPinsCycles = TCNT1;
+
+    debugUart.sendString("\r\n");
+    printResult("SPI  pointer ", spiCycles, SPI_BYTES);
+    printResult("SPI  template", spiPinsCycles, SPI_BYTES);
+    if (i2cOk && i2cPinsOk) {
+        printResult("I2C  pointer ", i2cCycles, 2);  // address + register
+        printResult("I2C  template", i2cPinsCycles, 2);
+    } else {
+        debugUart.sendString("I2C: no ACK from 0x68, skipped\r\n");
+    }
+    printResult("UART pointer ", uartCycles, UART_BYTES);
+    printResult("UART template", uartPinsCycles, UART_BYTES);
+    debugUart.sendString("UART ideal   : ");
+    debugPrintDecimal((F_CPU / 115200UL) * 11UL); // start + 8 data + stop + 1 gap
+    debugUart.sendString(" cycles/byte\r\n");
+
+    while (1) {
+    }
+
+    return 0;
+}
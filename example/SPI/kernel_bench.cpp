@@ -0,0 +1,113 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <protocol_SPI.h>
+#include <protocol_UART.h>
+
+// Bit-banged SPI throughput for every mode and bit order.
+// Nothing needs to be connected: MISO just reads whatever is on PB4.
+// Each line reports bytes/second for a 64-byte transferBytes() with zero
+// phase delays (unrolled kernels), for the pointer-based SPI class and the
+// compile-time SPIPins variant, followed by the paced 1 us/phase default and
+// the hardware peripheral at F_CPU/2 as references.
+// Timer1 runs at clk/1, so TCNT1 deltas are CPU cycles.
+
+static const uint8_t BYTES = 64;
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static SPI spi(&PINB, &DDRB, &PORTB, PB3,
+               &PINB, &DDRB, &PORTB, PB4,
+               &PINB, &DDRB, &PORTB, PB5,
+               &PINB, &DDRB, &PORTB, PB2);
+static SPIPins<PortB, PB3, PortB, PB4, PortB, PB5, PortB, PB2> spiPins;
+
+static uint8_t payload[BYTES];
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static inline void timerStart() {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+    TCNT1 = 0;
+}
+
+static void printRate(uint16_t cycles) {
+    debugPrintDecimal((F_CPU * BYTES) / cycles);
+    debugUart.sendString(" B/s");
+}
+
+static uint16_t timeSpi() {
+    timerStart();
+    spi.transferBytes(payload, payload, BYTES);
+    return TCNT1;
+}
+
+static uint16_t timeSpiPins() {
+    timerStart();
+    spiPins.transferBytes(payload, payload, BYTES);
+    return TCNT1;
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("Bit-banged SPI kernels (bytes/second)\r\n");
+
+    for (uint8_t i = 0; i < BYTES; ++i) {
+        payload[i] = (uint8_t)(i * 37);
+    }
+
+    spi.begin();
+    spiPins.begin();
+    spi.setDelaysMicroseconds(0, 0);
+    spiPins.setDelayLoops(0, 0);
+
+    for (uint8_t order = 0; order < 2; ++order) {
+        SPI::BitOrder bitOrder = order ? SPI::BitOrder::LSBFirst : SPI::BitOrder::MSBFirst;
+        spi.setBitOrder(bitOrder);
+        spiPins.setBitOrder(bitOrder);
+
+        for (uint8_t mode = 0; mode < 4; ++mode) {
+            spi.setDataMode(mode);
+            spiPins.setDataMode(mode);
+
+            debugUart.sendString("mode ");
+            debugPrintDecimal(mode);
+            debugUart.sendString(order ? " LSB: pointer " : " MSB: pointer ");
+            printRate(timeSpi());
+            debugUart.sendString(", template ");
+            printRate(timeSpiPins());
+            debugUart.sendString("\r\n");
+        }
+    }
+
+    spi.setBitOrder(SPI::BitOrder::MSBFirst);
+    spi.setDataMode(0);
+    spi.setDelaysMicroseconds(1, 1);
+    debugUart.sendString("paced 1 us/phase: ");
+    printRate(timeSpi());
+    debugUart.sendString("\r\n");
+
+    if (spi.setBackend(SPI::Backend::Hardware)) {
+        spi.setClockHz(F_CPU / 2UL);
+        debugUart.sendString("hardware F_CPU/2: ");
+        printRate(timeSpi());
+        debugUart.sendString("\r\n");
+    }
+
+    while (1) {
+    }
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <device_NRF24.h>
+#include <protocol_UART.h>
+
+// Request/response latency: reply in the ACK payload vs switching roles.
+//
+// Flash one board with ROLE_REQUESTER = true and one with false.
+// The requester alternates two exchanges and prints the round trip in us
+// (Timer1 at clk/8):
+//   'A' - reply comes back inside the auto-ACK of the request
+//   'S' - requester starts listening, responder stops listening, writes the
+//         reply and starts listening again (three 130 us settles plus the
+//         extra register traffic)
+
+static constexpr bool ROLE_REQUESTER = true;
+static constexpr uint8_t RADIO_CHANNEL = 76;
+static constexpr uint8_t REPLY_SIZE = 8;
+
+static const uint8_t PIPE0_ADDRESS[5] = {'N', 'R', 'F', '2', '4'};
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7
+);
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static inline void timerStart() {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS11);
+    TCNT1 = 0;
+}
+
+static void report(const char *label, bool ok, uint16_t ticks) {
+    debugUart.sendString(label);
+    if (ok) {
+        debugPrintDecimal(ticks / 2U);
+        debugUart.sendString(" us\r\n");
+    } else {
+        debugUart.sendString("no reply\r\n");
+    }
+}
+
+static void requester() {
+    uint8_t request[1];
+    uint8_t reply[NRF24::MAX_PAYLOAD_SIZE];
+
+    radio.stopListening();
+    while (1) {
+        request[0] = 'A';
+        timerStart();
+        bool ok = radio.write(request, sizeof(request)) && radio.isAckPayloadAvailable() &&
+                  radio.read(reply, sizeof(reply));
+        uint16_t ticks = TCNT1;
+        report("ACK payload : ", ok, ticks);
+        radio.flushRx();
+
+        request[0] = 'S';
+        timerStart();
+        ok = radio.write(request, sizeof(request));
+        radio.startListening();
+        uint16_t guard = 0;
+        while (ok && !radio.available() && ++guard < 20000) {
+        }
+        ok = ok && radio.read(reply, sizeof(reply));
+        ticks = TCNT1;
+        radio.stopListening();
+        report("role switch : ", ok, ticks);
+
+        _delay_ms(500);
+    }
+}
+
+static void responder() {
+    uint8_t request[NRF24::MAX_PAYLOAD_SIZE];
+    uint8_t reply[REPLY_SIZE] = {'R', 'E', 'P', 'L', 'Y', 0, 0, 0};
+
+    radio.startListening();
+    radio.writeAckPayload(0, reply, sizeof(reply));
+    while (1) {
+        if (!radio.available() || !radio.read(request, sizeof(request))) {
+            continue;
+        }
+        reply[7]++;
+        if (request[0] == 'S') {
+            radio.stopListening();
+            radio.flushTx(); // drop the preloaded ACK payload before transmitting
+            radio.write(reply, sizeof(reply));
+            radio.startListening();
+        }
+        radio.writeAckPayload(0, reply, sizeof(reply));
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("nRF24 ACK payload vs role switch latency\r\n");
+
+    radio.begin(true, RADIO_CHANNEL);
+    radio.setSpiBackend(SPI::Backend::Hardware);
+    radio.setDataRate(NRF24::DataRate::Rate2Mbps);
+    radio.enableAckPayload();
+    radio.openWritingPipe(PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS));
+    radio.openReadingPipe(0, PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS), true);
+
+    if (ROLE_REQUESTER) {
+        requester();
+    } else {
+        responder();
+    }
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <device_NRF24.h>
+#include <protocol_UART.h>
+
+// 2.4 GHz occupancy from the nRF24 received power detector.
+// Prints one character per channel (0-125): '.' never busy, 1-9 RPD hits,
+// '+' ten or more; then the scan time in ms (Timer1 at clk/1024) and the
+// quietest channel overall and below 84 (inside the 2.4 GHz ISM band
+// everywhere).
+
+static constexpr uint8_t SAMPLES = 8;
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7
+);
+
+static uint8_t histogram[NRF24::CHANNEL_COUNT];
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("nRF24 channel scanner\r\n");
+
+    radio.begin(false);
+    radio.setSpiBackend(SPI::Backend::Hardware);
+
+    while (1) {
+        TCCR1A = 0;
+        TCCR1B = (1 << CS12) | (1 << CS10);
+        TCNT1 = 0;
+        radio.scanChannels(histogram, SAMPLES);
+        uint32_t elapsedUs = (uint32_t)TCNT1 * 64UL;
+
+        for (uint8_t ch = 0; ch < NRF24::CHANNEL_COUNT; ++ch) {
+            uint8_t hits = histogram[ch];
+            debugUart.sendByte(hits == 0 ? '.' : (hits < 10 ? (char)('0' + hits) : '+'));
+        }
+        debugUart.sendString("\r\nscan ");
+        debugPrintDecimal(elapsedUs / 1000UL);
+        debugUart.sendString(" ms, quietest ");
+        debugPrintDecimal(NRF24::quietestChannel(histogram));
+        debugUart.sendString(", below 84: ");
+        debugPrintDecimal(NRF24::quietestChannel(histogram, 0, 83));
+        debugUart.sendString("\r\n");
+
+        _delay_ms(1000);
+    }
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <device_NRF24.h>
+#include <protocol_NRF24Hopper.h>
+#include <protocol_UART.h>
+
+// Frequency-hopping link. Flash one board with ROLE_SENDER = true and one with
+// false. The sender sends a 16-byte message with a sequence number every
+// 10 ms and prints once per second the messages delivered and failed, the
+// attempts (hops) they took and the worst send() latency, timed with Timer1
+// at clk/1024 (64 us per tick). The receiver prints messages received,
+// sequence gaps and the channel it sits on.
+// Park a jammer (another nRF24 in constant-carrier mode, a busy Wi-Fi
+// channel) on one of HOP_CHANNELS: a fixed-channel link stalls there, this
+// one loses one attempt per visit.
+
+static constexpr bool ROLE_SENDER = true;
+static constexpr uint16_t HOP_SEED = 0x2B1D;
+static constexpr uint16_t SEND_INTERVAL_MS = 10;
+
+static const uint8_t PIPE0_ADDRESS[5] = {'N', 'R', 'F', '2', '4'};
+static const uint8_t HOP_CHANNELS[8] = {5, 20, 35, 50, 65, 80, 95, 110};
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7
+);
+
+static NRF24Hopper hopper(radio);
+
+static const uint16_t TICKS_PER_SECOND = (uint16_t)(F_CPU / 1024UL);
+static const uint16_t US_PER_TICK = (uint16_t)(1024000000UL / F_CPU);
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void sender() {
+    uint8_t payload[16] = {0};
+    uint16_t sequence = 0;
+    uint16_t delivered = 0;
+    uint16_t failed = 0;
+    uint16_t attempts = 0;
+    uint16_t worstTicks = 0;
+    uint16_t elapsed = 0;
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10);
+    while (1) {
+        payload[0] = (uint8_t)sequence;
+        payload[1] = (uint8_t)(sequence >> 8);
+        sequence++;
+
+        TCNT1 = 0;
+        bool ok = hopper.send(payload, sizeof(payload));
+        uint16_t ticks = TCNT1;
+        attempts += hopper.attemptsUsed();
+        if (ok) {
+            delivered++;
+        } else {
+            failed++;
+        }
+        if (ticks > worstTicks) {
+            worstTicks = ticks;
+        }
+
+        _delay_ms(SEND_INTERVAL_MS);
+        elapsed += ticks + (uint16_t)(SEND_INTERVAL_MS * (TICKS_PER_SECOND / 1000U));
+        if (elapsed < TICKS_PER_SECOND) {
+            continue;
+        }
+
+        debugUart.sendString("delivered=");
+        debugPrintDecimal(delivered);
+        debugUart.sendString(" failed=");
+        debugPrintDecimal(failed);
+        debugUart.sendString(" attempts=");
+        debugPrintDecimal(attempts);
+        debugUart.sendString(" worst=");
+        debugPrintDecimal((uint32_t)worstTicks * US_PER_TICK);
+        debugUart.sendString("us\r\n");
+        delivered = 0;
+        failed = 0;
+        attempts = 0;
+        worstTicks = 0;
+        elapsed = 0;
+    }
+}
+
+static void receiver() {
+    uint8_t buffer[NRF24Hopper::MAX_PAYLOAD];
+    uint8_t length = 0;
+    uint16_t received = 0;
+    uint16_t gaps = 0;
+    uint16_t lastSequence = 0;
+    bool first = true;
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10);
+    TCNT1 = 0;
+    hopper.startReceiving();
+    while (1) {
+        if (hopper.receive(buffer, sizeof(buffer), length, 10) && length >= 2) {
+            uint16_t sequence = (uint16_t)(buffer[0] | (buffer[1] << 8));
+            if (!first && sequence != (uint16_t)(lastSequence + 1)) {
+                gaps++;
+            }
+            first = false;
+            lastSequence = sequence;
+            received++;
+        }
+
+        if (TCNT1 < TICKS_PER_SECOND) {
+            continue;
+        }
+        TCNT1 = 0;
+
+        debugUart.sendString("received=");
+        debugPrintDecimal(received);
+        debugUart.sendString(" gaps=");
+        debugPrintDecimal(gaps);
+        debugUart.sendString(" ch=");
+        debugPrintDecimal(hopper.channel());
+        debugUart.sendString("\r\n");
+        received = 0;
+        gaps = 0;
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("nRF24 frequency hopping\r\n");
+
+    radio.begin(true, HOP_CHANNELS[0], 32);
+    radio.setSpiBackend(SPI::Backend::Hardware);
+    radio.setDataRate(NRF24::DataRate::Rate2Mbps);
+    radio.setDynamicPayloads(true);
+    radio.openWritingPipe(PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS));
+    radio.openReadingPipe(0, PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS), true);
+
+    if (!hopper.begin(HOP_CHANNELS, sizeof(HOP_CHANNELS), HOP_SEED)) {
+        debugUart.sendString("bad channel set\r\n");
+        while (1) {
+        }
+    }
+
+    if (ROLE_SENDER) {
+        sender();
+    } else {
+        receiver();
+    }
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <device_NRF24.h>
+#include <protocol_UART.h>
+
+// Packets/second: polled receive vs IRQ-driven receive queue.
+//
+// Flash one board with ROLE_TRANSMITTER = true (streams sequence-numbered
+// packets without ACK as fast as write() allows) and one with false.
+// The receiver wires the nRF24 IRQ pin to D2 (INT0) and alternates one
+// second of each mode. Its main loop simulates APP_WORK_MS of application
+// work between receive calls, which is what overflows the radio's 3-deep FIFO
+// in polled mode; the IRQ path buffers RX_QUEUE_DEPTH + 3 packets per work
+// slice. Each line reports packets received and packets lost (sequence gaps).
+
+static constexpr bool ROLE_TRANSMITTER = false;
+static constexpr uint8_t RADIO_CHANNEL = 76;
+static constexpr uint8_t PAYLOAD_SIZE = 32;
+static constexpr uint8_t APP_WORK_MS = 2;
+
+static const uint8_t PIPE0_ADDRESS[5] = {'N', 'R', 'F', '2', '4'};
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7,   // CE
+    &PIND, &DDRD, &PORTD, PD2    // IRQ (INT0)
+);
+
+// Timer1 at clk/1024
+static const uint16_t TICKS_PER_SECOND = (uint16_t)(F_CPU / 1024UL);
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void transmitForever() {
+    uint8_t payload[PAYLOAD_SIZE] = {0};
+    uint16_t sequence = 0;
+    radio.stopListening();
+    while (1) {
+        payload[0] = (uint8_t)(sequence >> 8);
+        payload[1] = (uint8_t)sequence;
+        radio.write(payload, PAYLOAD_SIZE, false);
+        sequence++;
+    }
+}
+
+static void measure(const char *label) {
+    uint8_t payload[PAYLOAD_SIZE];
+    uint16_t received = 0;
+    uint16_t lost = 0;
+    int32_t last = -1;
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10);
+    TCNT1 = 0;
+    while (TCNT1 < TICKS_PER_SECOND) {
+        while (radio.available()) {
+            if (!radio.read(payload, PAYLOAD_SIZE)) {
+                break;
+            }
+            uint16_t sequence = (uint16_t)((payload[0] << 8) | payload[1]);
+            if (last >= 0) {
+                lost += (uint16_t)(sequence - (uint16_t)last - 1);
+            }
+            last = sequence;
+            received++;
+        }
+        _delay_ms(APP_WORK_MS);
+    }
+
+    debugUart.sendString(label);
+    debugUart.sendString(": ");
+    debugPrintDecimal(received);
+    debugUart.sendString(" pkt/s, ");
+    debugPrintDecimal(lost);
+    debugUart.sendString(" lost\r\n");
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("nRF24 polled vs IRQ receive benchmark\r\n");
+
+    radio.begin(false, RADIO_CHANNEL, PAYLOAD_SIZE);
+    radio.setSpiBackend(SPI::Backend::Hardware);
+    radio.setDataRate(NRF24::DataRate::Rate2Mbps);
+    radio.openWritingPipe(PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS));
+    radio.openReadingPipe(0, PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS), false);
+
+    if (ROLE_TRANSMITTER) {
+        transmitForever();
+    }
+
+    radio.startListening();
+    while (1) {
+        radio.disableIrq();
+        radio.flushRx();
+        measure("polled");
+
+        if (!radio.enableIrq()) {
+            debugUart.sendString("IRQ pin is not on INT0/INT1\r\n");
+            continue;
+        }
+        measure("IRQ   ");
+    }
+
+    return 0;
+}
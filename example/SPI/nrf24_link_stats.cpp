@@ -0,0 +1,129 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <device_NRF24.h>
+#include <protocol_UART.h>
+
+// Link statistics once per second, for tuning channel, data rate and retries.
+// Build the whole project with -DNRF24_ENABLE_STATS=1.
+//
+// Flash one board with ROLE_SENDER = true and one with false. The sender
+// prints delivered packets, retransmissions per 100 packets and MAX_RT
+// events; the receiver prints packets per pipe, RX FIFO/queue overflows and
+// the share of packets above -64 dBm (RPD).
+
+static_assert(NRF24::STATS_ENABLED, "build with -DNRF24_ENABLE_STATS=1");
+
+static constexpr bool ROLE_SENDER = true;
+static constexpr uint8_t RADIO_CHANNEL = 76;
+static constexpr uint8_t PAYLOAD_SIZE = 32;
+
+static const uint8_t PIPE0_ADDRESS[5] = {'N', 'R', 'F', '2', '4'};
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7,
+    &PIND, &DDRD, &PORTD, PD2
+);
+
+static const uint16_t TICKS_PER_SECOND = (uint16_t)(F_CPU / 1024UL);
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static inline void timerStart() {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10);
+    TCNT1 = 0;
+}
+
+static void sender() {
+    uint8_t payload[PAYLOAD_SIZE] = {0};
+    NRF24::Stats stats;
+
+    radio.stopListening();
+    while (1) {
+        radio.resetStats();
+        timerStart();
+        while (TCNT1 < TICKS_PER_SECOND) {
+            payload[0]++;
+            radio.writeFast(payload, PAYLOAD_SIZE);
+        }
+        radio.txStandby();
+        radio.readStats(stats);
+
+        debugUart.sendString("delivered=");
+        debugPrintDecimal(stats.txDelivered);
+        debugUart.sendString(" retx/100=");
+        debugPrintDecimal(stats.txDelivered ? (stats.txRetransmits * 100UL) / stats.txDelivered : 0);
+        debugUart.sendString(" maxRt=");
+        debugPrintDecimal(stats.txMaxRt);
+        debugUart.sendString("\r\n");
+    }
+}
+
+static void receiver() {
+    uint8_t payload[PAYLOAD_SIZE];
+    NRF24::Stats stats;
+
+    radio.startListening();
+    radio.enableIrq();
+    while (1) {
+        radio.resetStats();
+        timerStart();
+        while (TCNT1 < TICKS_PER_SECOND) {
+            radio.read(payload, sizeof(payload));
+        }
+        radio.readStats(stats);
+
+        debugUart.sendString("rx");
+        for (uint8_t pipe = 0; pipe < 6; ++pipe) {
+            debugUart.sendString(" p");
+            debugPrintDecimal(pipe);
+            debugUart.sendString("=");
+            debugPrintDecimal(stats.rxPackets[pipe]);
+        }
+        debugUart.sendString(" fifoFull=");
+        debugPrintDecimal(stats.rxFifoFull);
+        debugUart.sendString(" queueFull=");
+        debugPrintDecimal(stats.rxQueueFull);
+        debugUart.sendString(" rpd%=");
+        debugPrintDecimal(stats.rpdSamples ? (stats.rpdHits * 100UL) / stats.rpdSamples : 0);
+        debugUart.sendString("\r\n");
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("nRF24 link statistics\r\n");
+
+    radio.begin(true, RADIO_CHANNEL, PAYLOAD_SIZE);
+    radio.setSpiBackend(SPI::Backend::Hardware);
+    radio.setDataRate(NRF24::DataRate::Rate2Mbps);
+    radio.openWritingPipe(PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS));
+    radio.openReadingPipe(0, PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS), true);
+
+    if (ROLE_SENDER) {
+        sender();
+    } else {
+        receiver();
+    }
+
+    return 0;
+}
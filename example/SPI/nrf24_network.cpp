@@ -0,0 +1,131 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <device_NRF24.h>
+#include <protocol_NRF24Network.h>
+#include <protocol_UART.h>
+
+// Star network throughput. Flash NODE_ID = 0 on the hub and 1..5 (children)
+// or 011..045 (octal, grandchildren behind relay 1..5) on the others; relays
+// forward automatically from update().
+// Every non-hub node sends a 28-byte frame with a sequence number to the hub
+// as fast as it can; the hub prints once per second (Timer1 at clk/1024) the
+// messages received from each node and in total, plus gaps in the sequence
+// and suppressed duplicates.
+
+static constexpr uint8_t NODE_ID = 0;
+static constexpr uint8_t RADIO_CHANNEL = 76;
+static constexpr uint8_t MSG_SEQUENCE = 1;
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7
+);
+
+static NRF24Network network(radio);
+
+static const uint16_t TICKS_PER_SECOND = (uint16_t)(F_CPU / 1024UL);
+
+static uint16_t received[64];
+static uint16_t lastSequence[64];
+static uint16_t gaps = 0;
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void hub() {
+    NRF24Network::Message message;
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10);
+    TCNT1 = 0;
+    while (1) {
+        network.update();
+        while (network.read(message)) {
+            uint8_t from = message.from & 0x3F;
+            uint16_t sequence = (uint16_t)(message.data[0] | (message.data[1] << 8));
+            if (received[from] != 0 && sequence != (uint16_t)(lastSequence[from] + 1)) {
+                gaps++;
+            }
+            lastSequence[from] = sequence;
+            received[from]++;
+        }
+
+        if (TCNT1 < TICKS_PER_SECOND) {
+            continue;
+        }
+        TCNT1 = 0;
+
+        uint32_t total = 0;
+        for (uint8_t id = 1; id < 64; ++id) {
+            if (received[id] == 0) {
+                continue;
+            }
+            debugUart.sendString("0");
+            debugPrintDecimal((id >> 3) * 10 + (id & 0x07));
+            debugUart.sendString(":");
+            debugPrintDecimal(received[id]);
+            debugUart.sendString(" ");
+            total += received[id];
+            received[id] = 0;
+        }
+        debugUart.sendString("total=");
+        debugPrintDecimal(total);
+        debugUart.sendString(" msgs/s gaps=");
+        debugPrintDecimal(gaps);
+        debugUart.sendString(" dups=");
+        debugPrintDecimal(network.duplicates());
+        debugUart.sendString("\r\n");
+        gaps = 0;
+    }
+}
+
+static void node() {
+    uint8_t payload[NRF24Network::MAX_PAYLOAD] = {0};
+    uint16_t sequence = 0;
+    while (1) {
+        payload[0] = (uint8_t)sequence;
+        payload[1] = (uint8_t)(sequence >> 8);
+        network.send(NRF24Network::HUB, MSG_SEQUENCE, payload, sizeof(payload));
+        sequence++;
+        network.update(); // relay duty
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("nRF24 star network\r\n");
+
+    radio.begin(true, RADIO_CHANNEL);
+    radio.setSpiBackend(SPI::Backend::Hardware);
+    radio.setDataRate(NRF24::DataRate::Rate2Mbps);
+    radio.setRetries(250, 15);
+    if (!network.begin(NODE_ID)) {
+        debugUart.sendString("invalid NODE_ID\r\n");
+        while (1) {
+        }
+    }
+
+    if (NODE_ID == NRF24Network::HUB) {
+        hub();
+    } else {
+        node();
+    }
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <device_NRF24.h>
+#include <protocol_UART.h>
+
+// Delivered packets per second with stop-and-wait write() for three retry
+// settings: the begin() default (1250 us x 15), the shortest delay
+// (250 us x 15) and adaptive ARD/ARC. Each runs for one second
+// (Timer1 at clk/1024). Run example/SPI/nrf24_irq_rx_bench.cpp (receiver
+// role) on a second board; move the boards apart or add Wi-Fi traffic to see
+// the settings diverge.
+
+static constexpr uint8_t RADIO_CHANNEL = 76;
+static constexpr uint8_t PAYLOAD_SIZE = 32;
+
+static const uint8_t PIPE0_ADDRESS[5] = {'N', 'R', 'F', '2', '4'};
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7
+);
+
+static const uint16_t TICKS_PER_SECOND = (uint16_t)(F_CPU / 1024UL);
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void run(const char *label) {
+    uint8_t payload[PAYLOAD_SIZE] = {0};
+    uint16_t delivered = 0;
+    uint16_t failed = 0;
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10);
+    TCNT1 = 0;
+    while (TCNT1 < TICKS_PER_SECOND) {
+        payload[0]++;
+        if (radio.write(payload, PAYLOAD_SIZE)) {
+            delivered++;
+        } else {
+            failed++;
+        }
+    }
+
+    debugUart.sendString(label);
+    debugUart.sendString(": ");
+    debugPrintDecimal(delivered);
+    debugUart.sendString(" delivered/s, ");
+    debugPrintDecimal(failed);
+    debugUart.sendString(" failed, ARD=");
+    debugPrintDecimal(radio.retryDelay());
+    debugUart.sendString(" ARC=");
+    debugPrintDecimal(radio.retryCount());
+    debugUart.sendString("\r\n");
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("nRF24 fixed vs adaptive retries\r\n");
+
+    radio.begin(true, RADIO_CHANNEL, PAYLOAD_SIZE);
+    radio.setSpiBackend(SPI::Backend::Hardware);
+    radio.setDataRate(NRF24::DataRate::Rate2Mbps);
+    radio.openWritingPipe(PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS));
+    radio.stopListening();
+
+    while (1) {
+        radio.setAdaptiveRetries(false);
+        radio.setRetries(1250, 15);
+        run("fixed 1250us x15");
+
+        radio.setRetries(250, 15);
+        run("fixed  250us x15");
+
+        radio.setRetries(1250, 15);
+        radio.setAdaptiveRetries(true);
+        run("adaptive        ");
+    }
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <device_NRF24.h>
+#include <protocol_UART.h>
+
+// Bit-banged vs hardware SPI backend for the nRF24 driver.
+// Reports, for each backend:
+//   - CPU cycles for a one-byte command (getStatus)
+//   - microseconds for a full 32-byte write() without ACK (upload + CE pulse + TX)
+// Timer1 runs at clk/1 for the command and clk/8 (0.5 us/tick) for write().
+
+static constexpr uint8_t RADIO_CHANNEL = 76;
+static constexpr uint8_t PAYLOAD_SIZE = 32;
+static constexpr uint8_t RUNS = 16;
+
+static const uint8_t PIPE0_ADDRESS[5] = {'N', 'R', 'F', '2', '4'};
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7
+);
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void runBenchmark(const char *label) {
+    uint8_t payload[PAYLOAD_SIZE];
+    for (uint8_t i = 0; i < PAYLOAD_SIZE; ++i) {
+        payload[i] = i;
+    }
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+    TCNT1 = 0;
+    radio.getStatus();
+    uint16_t commandCycles = TCNT1;
+
+    uint32_t writeTicks = 0;
+    TCCR1B = (1 << CS11);
+    for (uint8_t run = 0; run < RUNS; ++run) {
+        TCNT1 = 0;
+        radio.write(payload, PAYLOAD_SIZE, false);
+        writeTicks += TCNT1;
+    }
+
+    debugUart.sendString(label);
+    debugUart.sendString(": command=");
+    debugPrintDecimal(commandCycles);
+    debugUart.sendString(" cycles, write(32B)=");
+    debugPrintDecimal(writeTicks / (2UL * RUNS));
+    debugUart.sendString(" us\r\n");
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("nRF24 SPI backend benchmark\r\n");
+
+    radio.begin(false, RADIO_CHANNEL, PAYLOAD_SIZE);
+    radio.openWritingPipe(PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS));
+    radio.stopListening();
+
+    radio.setSpiBackend(SPI::Backend::Software);
+    runBenchmark("software");
+
+    if (radio.setSpiBackend(SPI::Backend::Hardware)) {
+        runBenchmark("hardware");
+    } else {
+        debugUart.sendString("hardware backend unavailable on these pins\r\n");
+    }
+
+    while (1) {
+    }
+
+    return 0;
+}
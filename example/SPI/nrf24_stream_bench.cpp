@@ -0,0 +1,118 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <device_NRF24.h>
+#include <protocol_UART.h>
+
+// Transmit throughput at 2 Mbps: stop-and-wait write() vs streaming
+// writeFast() + txStandby() using the radio's 3-slot TX FIFO.
+// Each mode sends for one second (Timer1 at clk/1024) and reports packets
+// queued and packets confirmed by TX_DS.
+// Without ACK no receiver is needed; set REQUEST_ACK = true and run
+// example/SPI/nrf24_irq_rx_bench.cpp (receiver role) on a second board to
+// measure acknowledged delivery.
+
+static constexpr bool REQUEST_ACK = false;
+static constexpr uint8_t RADIO_CHANNEL = 76;
+static constexpr uint8_t PAYLOAD_SIZE = 32;
+
+static const uint8_t PIPE0_ADDRESS[5] = {'N', 'R', 'F', '2', '4'};
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7
+);
+
+static const uint16_t TICKS_PER_SECOND = (uint16_t)(F_CPU / 1024UL);
+
+static uint16_t delivered = 0;
+static uint16_t failed = 0;
+
+static void onTxDone(bool ok, void *) {
+    if (ok) {
+        delivered++;
+    } else {
+        failed++;
+    }
+}
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void report(const char *label, uint16_t sent) {
+    debugUart.sendString(label);
+    debugUart.sendString(": ");
+    debugPrintDecimal(sent);
+    debugUart.sendString(" sent/s, ");
+    debugPrintDecimal(delivered);
+    debugUart.sendString(" delivered, ");
+    debugPrintDecimal(failed);
+    debugUart.sendString(" failed\r\n");
+}
+
+static inline void timerStart() {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS12) | (1 << CS10);
+    TCNT1 = 0;
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("nRF24 stop-and-wait vs streaming TX\r\n");
+
+    radio.begin(REQUEST_ACK, RADIO_CHANNEL, PAYLOAD_SIZE);
+    radio.setSpiBackend(SPI::Backend::Hardware);
+    radio.setDataRate(NRF24::DataRate::Rate2Mbps);
+    radio.openWritingPipe(PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS));
+    radio.stopListening();
+    radio.onTxComplete(onTxDone);
+
+    uint8_t payload[PAYLOAD_SIZE] = {0};
+
+    while (1) {
+        uint16_t sent = 0;
+        delivered = 0;
+        failed = 0;
+        timerStart();
+        while (TCNT1 < TICKS_PER_SECOND) {
+            payload[0]++;
+            if (radio.write(payload, PAYLOAD_SIZE, REQUEST_ACK)) {
+                delivered++;
+            } else {
+                failed++;
+            }
+            sent++;
+        }
+        report("write()    ", sent);
+
+        sent = 0;
+        delivered = 0;
+        failed = 0;
+        timerStart();
+        while (TCNT1 < TICKS_PER_SECOND) {
+            payload[0]++;
+            if (radio.writeFast(payload, PAYLOAD_SIZE, REQUEST_ACK)) {
+                sent++;
+            }
+        }
+        radio.txStandby();
+        report("writeFast()", sent);
+    }
+
+    return 0;
+}
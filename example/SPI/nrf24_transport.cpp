@@ -0,0 +1,122 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <device_NRF24.h>
+#include <protocol_NRF24Transport.h>
+#include <protocol_UART.h>
+
+// 1 KB messages over NRF24Transport.
+// Flash one board with ROLE_SENDER = true and one with false.
+// The sender reports goodput (message bytes per second of send()), the
+// fragments put on air including resends, and the rounds used. The receiver
+// verifies each message against the expected pattern.
+
+static constexpr bool ROLE_SENDER = true;
+static constexpr uint8_t RADIO_CHANNEL = 76;
+static constexpr uint16_t MESSAGE_SIZE = 1024;
+
+static const uint8_t PIPE0_ADDRESS[5] = {'N', 'R', 'F', '2', '4'};
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7
+);
+
+static NRF24Transport transport(radio);
+static uint8_t message[MESSAGE_SIZE];
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void fillPattern(uint8_t seed) {
+    for (uint16_t i = 0; i < MESSAGE_SIZE; ++i) {
+        message[i] = (uint8_t)(i * 7 + seed);
+    }
+}
+
+static void sender() {
+    uint8_t seed = 0;
+    radio.stopListening();
+    while (1) {
+        fillPattern(seed);
+
+        TCCR1A = 0;
+        TCCR1B = (1 << CS12) | (1 << CS10); // 64 us per tick
+        TCNT1 = 0;
+        bool ok = transport.send(message, MESSAGE_SIZE);
+        uint32_t elapsedUs = (uint32_t)TCNT1 * 64UL;
+
+        debugUart.sendString(ok ? "sent " : "FAILED ");
+        debugPrintDecimal(elapsedUs ? (MESSAGE_SIZE * 1000000UL) / elapsedUs : 0);
+        debugUart.sendString(" B/s, fragments=");
+        debugPrintDecimal(transport.fragmentsSent());
+        debugUart.sendString(", rounds=");
+        debugPrintDecimal(transport.roundsUsed());
+        debugUart.sendString("\r\n");
+
+        seed++;
+        _delay_ms(200);
+    }
+}
+
+static void receiver() {
+    uint8_t seed = 0;
+    transport.setReceiveBuffer(message, sizeof(message));
+    radio.startListening();
+    while (1) {
+        if (!transport.poll()) {
+            continue;
+        }
+        uint16_t errors = 0;
+        for (uint16_t i = 0; i < transport.messageLength(); ++i) {
+            if (message[i] != (uint8_t)(i * 7 + message[0])) {
+                errors++;
+            }
+        }
+        transport.releaseMessage();
+
+        debugUart.sendString("message ");
+        debugPrintDecimal(seed++);
+        debugUart.sendString(": ");
+        debugPrintDecimal(transport.messageLength());
+        debugUart.sendString(" bytes, ");
+        debugPrintDecimal(errors);
+        debugUart.sendString(" bad\r\n");
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("NRF24 transport 1 KB test\r\n");
+
+    radio.begin(true, RADIO_CHANNEL);
+    radio.setSpiBackend(SPI::Backend::Hardware);
+    radio.setDataRate(NRF24::DataRate::Rate2Mbps);
+    transport.begin();
+    radio.openWritingPipe(PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS));
+    radio.openReadingPipe(0, PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS), true);
+
+    if (ROLE_SENDER) {
+        sender();
+    } else {
+        receiver();
+    }
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include <string.h>
+#include <device_NRF24.h>
+#include <protocol_UART.h>
+
+// 32-byte ping-pong, staged vs zero-copy. Flash one board with
+// ROLE_SENDER = true and one with false. The sender sends a Sample, the other
+// board echoes it and the sender checks it. Odd seconds use the copy path
+// (encode into a buffer, write(), read(), decode); even seconds stream the
+// struct fields straight to the radio and decode the echo from the
+// readPayload() handler while the bytes are still shifting in.
+// Timer1 runs at clk/1, so TCNT1 counts CPU cycles; once per second the
+// sender prints the mean round trip and the mean cycles spent unloading the
+// echo (R_RX_PAYLOAD plus decode).
+
+static constexpr bool ROLE_SENDER = true;
+static constexpr uint8_t RADIO_CHANNEL = 76;
+
+static const uint8_t PIPE0_ADDRESS[5] = {'N', 'R', 'F', '2', '4'};
+
+struct Sample {
+    uint32_t sequence;
+    int16_t axes[6];
+    uint8_t status[16];
+};
+
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 115200UL);
+
+static NRF24 radio(
+    &PINB, &DDRB, &PORTB, PB3,
+    &PINB, &DDRB, &PORTB, PB4,
+    &PINB, &DDRB, &PORTB, PB5,
+    &PINB, &DDRB, &PORTB, PB2,
+    &PIND, &DDRD, &PORTD, PD7
+);
+
+static const uint16_t ROUNDS_PER_REPORT = 256;
+
+static void debugPrintDecimal(uint32_t value) {
+    char buf[11];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static bool waitForPacket(uint16_t timeoutMs) {
+    uint32_t loops = (uint32_t)timeoutMs * 20U;
+    while (!radio.available()) {
+        if (loops-- == 0) {
+            return false;
+        }
+        _delay_us(50);
+    }
+    return true;
+}
+
+// Decodes straight into the struct: byte i of the payload is byte i of Sample
+static void decodeByte(size_t index, uint8_t value, void *context) {
+    reinterpret_cast<uint8_t *>(context)[index] = value;
+}
+
+static bool roundTripStaged(const Sample &out, Sample &in, uint16_t &unloadCycles) {
+    uint8_t buffer[NRF24::MAX_PAYLOAD_SIZE];
+    memcpy(buffer, &out, sizeof(out));
+    if (!radio.write(buffer, sizeof(buffer))) {
+        return false;
+    }
+    radio.startListening();
+    if (!waitForPacket(10)) {
+        radio.stopListening();
+        return false;
+    }
+    uint16_t start = TCNT1;
+    bool ok = radio.read(buffer, sizeof(buffer));
+    memcpy(&in, buffer, sizeof(in));
+    unloadCycles = (uint16_t)(TCNT1 - start);
+    radio.stopListening();
+    return ok;
+}
+
+static bool roundTripStreamed(const Sample &out, Sample &in, uint16_t &unloadCycles) {
+    radio.beginPayloadWrite(sizeof(out));
+    radio.writePayloadBytes(&out.sequence, sizeof(out.sequence));
+    radio.writePayloadBytes(out.axes, sizeof(out.axes));
+    radio.writePayloadBytes(out.status, sizeof(out.status));
+    if (!radio.endPayloadWrite()) {
+        return false;
+    }
+    radio.startListening();
+    if (!waitForPacket(10)) {
+        radio.stopListening();
+        return false;
+    }
+    uint16_t start = TCNT1;
+    bool ok = radio.readPayload(decodeByte, &in);
+    unloadCycles = (uint16_t)(TCNT1 - start);
+    radio.stopListening();
+    return ok;
+}
+
+static void sender() {
+    static_assert(sizeof(Sample) == NRF24::MAX_PAYLOAD_SIZE, "Sample must fill one payload");
+    Sample out;
+    Sample in;
+    memset(&out, 0, sizeof(out));
+    for (uint8_t i = 0; i < sizeof(out.status); ++i) {
+        out.status[i] = i;
+    }
+
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+    bool streamed = false;
+    while (1) {
+        uint32_t roundCycles = 0;
+        uint32_t unloadCycles = 0;
+        uint16_t good = 0;
+        uint16_t bad = 0;
+        for (uint16_t round = 0; round < ROUNDS_PER_REPORT; ++round) {
+            out.sequence++;
+            out.axes[round % 6] = (int16_t)round;
+            uint16_t unload = 0;
+            uint16_t start = TCNT1;
+            bool ok = streamed ? roundTripStreamed(out, in, unload) : roundTripStaged(out, in, unload);
+            uint16_t cycles = (uint16_t)(TCNT1 - start);
+            if (ok && memcmp(&in, &out, sizeof(out)) == 0) {
+                good++;
+                roundCycles += cycles;
+                unloadCycles += unload;
+            } else {
+                bad++;
+            }
+            _delay_ms(1);
+        }
+
+        debugUart.sendString(streamed ? "streamed" : "staged  ");
+        debugUart.sendString(" round trip=");
+        debugPrintDecimal(good ? roundCycles / good : 0);
+        debugUart.sendString(" cycles unload=");
+        debugPrintDecimal(good ? unloadCycles / good : 0);
+        debugUart.sendString(" cycles ok=");
+        debugPrintDecimal(good);
+        debugUart.sendString(" bad=");
+        debugPrintDecimal(bad);
+        debugUart.sendString("\r\n");
+        streamed = !streamed;
+    }
+}
+
+static void echo() {
+    NRF24::Packet packet;
+    radio.startListening();
+    while (1) {
+        if (!radio.readPacket(packet)) {
+            continue;
+        }
+        _delay_us(200); // the sender's write() returns and it turns to RX
+        radio.write(packet.data, packet.length);
+    }
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    debugUart.sendString("nRF24 zero-copy payloads\r\n");
+
+    radio.begin(true, RADIO_CHANNEL, NRF24::MAX_PAYLOAD_SIZE);
+    radio.setSpiBackend(SPI::Backend::Hardware);
+    radio.setDataRate(NRF24::DataRate::Rate2Mbps);
+    radio.setRetries(250, 15);
+    radio.openWritingPipe(PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS));
+    radio.openReadingPipe(0, PIPE0_ADDRESS, sizeof(PIPE0_ADDRESS), true);
+
+    if (ROLE_SENDER) {
+        sender();
+    } else {
+        echo();
+    }
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <protocol_UART.h>
+
+// Timer-driven (non-blocking) software UART TX on D5.
+// D6 toggles continuously in the main loop: with TxMode::Timer it keeps
+// toggling while a frame is on the wire, with TxMode::Blocking it stalls.
+// The toggle writes PIND instead of PORTD ^= ...: a read-modify-write of
+// PORTD could be interrupted by the COMPA ISR driving D5 and then write back
+// a stale TX level.
+//
+// test/uart_timer_tx.cpp checks this waveform against a simulated Timer1:
+// every edge on the bit grid, (10 + gap) bit times per byte, hand-off
+// between UARTs and flushTx() with interrupts off.
+static UART softSerial(&PIND, &DDRD, &PORTD, PD5,  // TX
+                       &PIND, &DDRD, &PORTD, PD4,  // RX
+                       9600UL);
+
+static const uint8_t frame[10] = {0x7E, 0xFF, 0x06, 0x03, 0x00, 0x00, 0x01, 0xFE, 0xF7, 0xEF};
+
+int main(void) {
+    DDRD |= (1 << PD6);
+
+    sei();
+    softSerial.begin();
+    softSerial.setTxMode(UART::TxMode::Timer);
+    softSerial.setInterByteGap(1);
+
+    while (1) {
+        softSerial.sendBytes(frame, sizeof(frame)); // returns immediately
+        while (softSerial.txPending()) {
+            PIND = (1 << PD6); // other work keeps running; writing PIND toggles atomically
+        }
+        softSerial.flushTx();
+        _delay_ms(100);
+    }
+
+    return 0;
+}
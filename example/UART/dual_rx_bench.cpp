@@ -0,0 +1,126 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <protocol_UART.h>
+
+// Throughput / loss benchmark for two simultaneous 9600-baud RX streams.
+//
+// Feed D4 and D3 from two independent senders (e.g. two USB-TTL adapters)
+// that both stream an incrementing byte counter (0x00, 0x01, ... 0xFF, 0x00 ...)
+// back to back. Once per second the sketch reports, per stream:
+//   bytes received, sequence gaps (lost bytes), frame errors, buffer overflows.
+// Switch RX_MODE to compare the blocking PCINT sampler with the timer engine.
+// Windows are counted in TIMER1_OVF, so the time spent printing a report
+// stays inside the next window instead of stretching it.
+static const UART::RxMode RX_MODE = UART::RxMode::Timer;
+
+static UART streamA(&PIND, &DDRD, &PORTD, PD5,  // TX (unused)
+                    &PIND, &DDRD, &PORTD, PD4,  // RX
+                    9600UL);
+static UART streamB(&PIND, &DDRD, &PORTD, PD6,  // TX (unused)
+                    &PIND, &DDRD, &PORTD, PD3,  // RX
+                    9600UL);
+static UART debugUart(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 57600UL);
+
+// Timer1 overflows every 65536 cycles: 16 MHz / 65536 = ~244 per second
+static const uint16_t OVERFLOWS_PER_SECOND = (uint16_t)(F_CPU / 65536UL);
+
+static volatile uint16_t overflows = 0;
+
+ISR(TIMER1_OVF_vect) {
+    overflows++;
+}
+
+static uint16_t overflowCount() {
+    uint8_t sreg = SREG; cli();
+    uint16_t count = overflows;
+    SREG = sreg;
+    return count;
+}
+
+struct StreamStats {
+    uint16_t bytes;
+    uint16_t lost;
+    int16_t last;
+};
+
+static void debugPrintDecimal(uint16_t value) {
+    char buf[6];
+    uint8_t len = 0;
+    do {
+        buf[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (len--) {
+        debugUart.sendByte(buf[len]);
+    }
+}
+
+static void drain(UART &uart, StreamStats &stats) {
+    int c;
+    while ((c = uart.read()) >= 0) {
+        if (stats.last >= 0) {
+            uint8_t expected = (uint8_t)(stats.last + 1);
+            stats.lost += (uint8_t)((uint8_t)c - expected);
+        }
+        stats.last = c;
+        stats.bytes++;
+    }
+}
+
+static void report(const char *name, const UART &uart, const StreamStats &stats) {
+    debugUart.sendString(name);
+    debugUart.sendString(" bytes/s=");
+    debugPrintDecimal(stats.bytes);
+    debugUart.sendString(" lost=");
+    debugPrintDecimal(stats.lost);
+    debugUart.sendString(" frameErr=");
+    debugPrintDecimal(uart.frameErrorCount());
+    debugUart.sendString(" overflow=");
+    debugPrintDecimal(uart.overflowCount());
+    debugUart.sendString("\r\n");
+}
+
+int main(void) {
+    sei();
+    debugUart.begin();
+    // The debug port must not block interrupts while the streams are sampled
+    debugUart.setTxMode(UART::TxMode::Timer);
+
+    streamA.begin();
+    streamB.begin();
+    streamA.setRxMode(RX_MODE);
+    streamB.setRxMode(RX_MODE);
+
+    debugUart.sendString("Dual RX benchmark (");
+    debugUart.sendString(RX_MODE == UART::RxMode::Timer ? "timer" : "blocking");
+    debugUart.sendString(" RX)\r\n");
+
+    // Timer1 free-running at clk/1 (the timer engines set the same mode)
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+    TIFR1 = (1 << TOV1);
+    TIMSK1 |= (1 << TOIE1);
+
+    StreamStats a = {0, 0, -1};
+    StreamStats b = {0, 0, -1};
+    uint16_t windowStart = overflowCount();
+
+    while (1) {
+        drain(streamA, a);
+        drain(streamB, b);
+
+        if ((uint16_t)(overflowCount() - windowStart) >= OVERFLOWS_PER_SECOND) {
+            // Close the window first, then print outside it
+            windowStart += OVERFLOWS_PER_SECOND;
+            StreamStats doneA = a;
+            StreamStats doneB = b;
+            a.bytes = a.lost = 0;
+            b.bytes = b.lost = 0;
+            report("A", streamA, doneA);
+            report("B", streamB, doneB);
+        }
+    }
+
+    return 0;
+}
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <protocol_I2C.h>
+#include <protocol_ExtInt.h>
 
 class MPU6050 : protected I2C { 
     
@@ -19,8 +20,69 @@ public:
         float temperature;
     } MPU6050_Data;
 
+    typedef struct { // accel in mg, gyro in centi-°/s, temp in centi-°C
+        int16_t accel_x;
+        int16_t accel_y;
+        int16_t accel_z;
+
+        int32_t gyro_x;  // ±200000 at ±2000°/s
+        int32_t gyro_y;
+        int32_t gyro_z;
+
+        int16_t temperature;
+    } MPU6050_Fixed;
+
+    // Raw counts as the sensor outputs them; also the layout of one FIFO
+    // frame (accelerometer then gyroscope, 12 bytes)
+    typedef struct {
+        int16_t accel_x;
+        int16_t accel_y;
+        int16_t accel_z;
+
+        int16_t gyro_x;
+        int16_t gyro_y;
+        int16_t gyro_z;
+    } RawSample;
+
+    // User offset registers as the sensor holds them: accel in ±16g counts
+    // (2048 per g; bit 0 is reserved and kept as read), gyro in ±1000°/s
+    // counts (32.8 per °/s). Added to every sample inside the sensor.
+    typedef struct {
+        int16_t accel_x;
+        int16_t accel_y;
+        int16_t accel_z;
+
+        int16_t gyro_x;
+        int16_t gyro_y;
+        int16_t gyro_z;
+    } Offsets;
+
+    // Caller-owned ring for drainFifo(). head is the next slot drainFifo()
+    // fills, tail the next one the consumer takes; one slot stays empty so
+    // head == tail means empty.
+    struct SampleRing {
+        RawSample *samples;
+        uint16_t capacity;
+        uint16_t head;
+        uint16_t tail;
+
+        uint16_t available() const {
+            return head >= tail ? static_cast<uint16_t>(head - tail) : static_cast<uint16_t>(capacity - tail + head);
+        }
+
+        bool pop(RawSample &sample) {
+            if (head == tail) {
+                return false;
+            }
+            sample = samples[tail];
+            tail = static_cast<uint16_t>(tail + 1 == capacity ? 0 : tail + 1);
+            return true;
+        }
+    };
+
     MPU6050(volatile uint8_t *sda_pin_reg, volatile uint8_t *sda_ddr, volatile uint8_t *sda_port, uint8_t sda_pin,
-            volatile uint8_t *scl_pin_reg, volatile uint8_t *scl_ddr, volatile uint8_t *scl_port, uint8_t scl_pin);
+            volatile uint8_t *scl_pin_reg, volatile uint8_t *scl_ddr, volatile uint8_t *scl_port, uint8_t scl_pin,
+            volatile uint8_t *int_pin_reg = nullptr, volatile uint8_t *int_ddr = nullptr, volatile uint8_t *int_port = nullptr, uint8_t int_pin = 0);
 
     MPU6050() = delete;
 
@@ -28,8 +90,90 @@ public:
     bool readGyroscope(int16_t &gx, int16_t &gy, int16_t &gz);
     bool readTemperature(int16_t &temp);
     bool readAllSensors(MPU6050::MPU6050_Data &data);
+    bool readAllSensors(MPU6050::MPU6050_Fixed &data);
+
+    // Fixed-point scaling, one multiply and a shift per axis (no float, no
+    // divide): mg = raw * (4000 << range) >> 16 is exact; centi-°/s uses a
+    // Q12 factor per gyro range (within 0.02% of full scale); centi-°C = raw * 100/340 in
+    // Q14 plus 3653. The MPU6050_Data paths convert the same raw counts with
+    // one float multiply per value.
+    int16_t accelMilliG(int16_t raw) const {
+        return static_cast<int16_t>((static_cast<int32_t>(raw) * accel_mg_scale + 0x8000) >> 16);
+    }
+    int32_t gyroCentiDps(int16_t raw) const {
+        return (static_cast<int32_t>(raw) * gyro_cdps_scale + 0x800) >> 12;
+    }
+    static int16_t temperatureCentiC(int16_t raw) {
+        return static_cast<int16_t>(((static_cast<int32_t>(raw) * 4819 + 0x2000) >> 14) + 3653);
+    }
+
+    // Non-blocking burst read on the interrupt-driven TWI engine
+    // (setBackend(I2C::Backend::Hardware) first). Start it, do other work,
+    // then collect: collectAllSensors() returns false while the read is still
+    // in flight or if it failed (check asyncReadPending() to tell apart).
+    bool startReadAllSensors();
+    bool asyncReadPending() const;
+    bool collectAllSensors(MPU6050::MPU6050_Data &data);
+    bool collectAllSensors(MPU6050::MPU6050_Fixed &data);
     bool initialize();
 
+    // Output data rate. The gyro samples at 8 kHz with the low-pass filter off
+    // (CONFIG 0, the power-on state) and 1 kHz with it on; SMPLRT_DIV divides
+    // that down. setSampleRate() fails if the rate can't be reached exactly.
+    bool setDigitalLowPass(uint8_t config);  // DLPF_CFG 0..6
+    bool setSampleRate(uint16_t hz);
+
+    // FIFO capture: the sensor queues one frame per sample in its 1 KB FIFO
+    // (85 frames), so nothing is lost while the main loop is busy for up to
+    // 85 sample periods. drainFifo() reads FIFO_COUNT and then moves every
+    // whole frame that fits into the ring in a single burst read from
+    // FIFO_R_W (a second one only when the batch wraps the ring end). When
+    // the ring is full the frames stay in the sensor. If the FIFO overflowed
+    // the oldest bytes were overwritten and frame alignment is lost, so it is
+    // reset, the batch dropped and fifoOverflows() counts the event. The bus
+    // has to read faster than the sensor fills: a frame is 12 bytes (~270 us
+    // at 400 kHz, ~1.1 ms at 100 kHz), so 1 kHz needs the 400 kHz bus.
+    bool startFifo();
+    bool stopFifo();
+    bool resetFifo();
+    bool readFifoCount(uint16_t &bytes);
+    bool drainFifo(SampleRing &ring);
+    uint16_t fifoOverflows() const { return fifoOverflowCount; }
+
+    // Data-ready interrupt on the INT pin (push-pull, active high, a 50 us
+    // pulse per event). The pulse only counts the event in ISR context; the
+    // bus is used from the main loop. readReadySample() reads INT_STATUS and
+    // the sample registers in one 15-byte burst and returns a sample only if
+    // DATA_RDY was set, so every sample is read once even when the next one
+    // lands between the pulse and the read; pulses the loop was too slow for
+    // are counted by skippedSamples(). While the FIFO runs its overflow
+    // pulses the pin too; then dataReady() is the cue to call drainFifo().
+    // enableInterrupt() attaches INT0/INT1 when the INT pin is PD2/PD3; for
+    // any other pin pass attachInterrupt = false and call handleInterrupt()
+    // from your own interrupt handler (e.g. a PCINT vector).
+    bool enableInterrupt(bool attachInterrupt = true);
+    void disableInterrupt();
+    void handleInterrupt();
+    bool dataReady() const { return pendingInterrupts != 0; }
+    bool readReadySample(MPU6050::MPU6050_Data &data);
+    bool readReadySample(MPU6050::MPU6050_Fixed &data);
+    bool readReadySample(RawSample &sample);
+    uint16_t skippedSamples() const { return skippedSampleCount; }
+
+    // Bias calibration. Hold the sensor still and level, Z axis up, and call
+    // calibrate(): it averages readings, moves the offset registers by the
+    // measured bias (gravity removed from Z) and repeats once to take out
+    // the residual, leaving every later sample corrected by the sensor
+    // itself. The offset registers reset at power-up, so saveOffsets() keeps
+    // them in EEPROM (14 bytes at eepromAddress) and restoreOffsets() writes
+    // them back after initialize(); it fails, leaving the factory values, if
+    // nothing valid was saved there.
+    bool calibrate(uint16_t samples = 500);
+    bool readOffsets(Offsets &offsets);
+    bool writeOffsets(const Offsets &offsets);
+    bool saveOffsets(uint16_t eepromAddress = 0);
+    bool restoreOffsets(uint16_t eepromAddress = 0);
+
     int getAccelRange() const { return accel_range; }
     int getGyroRange() const { return gyro_range; }
 
@@ -41,15 +185,42 @@ public:
 
     bool isDeviceAwake() const { return isAwake; } 
 
+    // Bus selection passthrough (e.g. TWI at 400 kHz when wired to A4/A5)
+    using I2C::setBackend;
+    using I2C::setClock;
+
 private:
     // config variables
-    float accel_sensitivity = 0; 
-    float gyro_sensitivity = 0;  
+    float accel_scale = 1.0f / 16384;  // g per count
+    float gyro_scale = 1.0f / 131;     // °/s per count
+    int16_t accel_mg_scale = 4000;     // mg per count, Q16
+    int16_t gyro_cdps_scale = 3127;    // centi-°/s per count, Q12
 
     int accel_range = 0;
     int gyro_range = 0;
     
     bool isAwake = false;
+
+    uint16_t fifoOverflowCount = 0;
+    bool fifoOverflowSeen = false; // FIFO_OFLOW read by readReadySample()
+
+    // INT pin
+    volatile uint8_t *INT_PIN_REG;
+    volatile uint8_t *INT_DDR;
+    volatile uint8_t *INT_PORT;
+    uint8_t INT_PIN;
+    uint8_t INT_MASK;
+    bool hasIntPin;
+
+    bool intAttached = false;
+    ExtInt::Line intLine = ExtInt::Line::Int0;
+    volatile uint8_t pendingInterrupts = 0;
+    uint16_t skippedSampleCount = 0;
+
+    // Asynchronous burst read state
+    I2C::Transaction burstRead = {};
+    uint8_t burstRegister = ACCEL_XOUT_H;
+    uint8_t burstBuffer[14];
     
     
     // Reading 14 bytes starting from ACCEL_XOUT_H (0x3B) will get all sensor data:
@@ -58,6 +229,10 @@ private:
     // [8-13]:  Gyroscope (X,Y,Z
 
 
+    // Accelerometer X-axis user offset high byte register address (Y at 0x08, Z at 0x0A)
+    static const auto XA_OFFS_H = 0x06;
+    // Gyroscope X-axis user offset high byte register address (Y at 0x15, Z at 0x17)
+    static const auto XG_OFFS_USRH = 0x13;
     // Accelerometer X-axis high byte register address
     static const auto ACCEL_XOUT_H = 0x3B;
     // Gyroscope X-axis high byte register address
@@ -102,8 +277,44 @@ private:
     static const auto SMPLRT_DIV = 0x19;
     // Configuration register - sets external synchronization and digital low pass filter
     static const auto CONFIG = 0x1A;
+    // FIFO enable register - selects which sensor outputs are written to the FIFO
+    static const auto FIFO_EN = 0x23;
+    // User control register - FIFO enable and FIFO reset bits
+    static const auto USER_CTRL = 0x6A;
+    // Interrupt pin configuration register - INT level, drive, latch and clear mode
+    static const auto INT_PIN_CFG = 0x37;
+    // Interrupt enable register - selects which events drive the INT pin
+    static const auto INT_ENABLE = 0x38;
+    // Interrupt status register - event flags, cleared when read
+    static const auto INT_STATUS = 0x3A;
+    // FIFO byte count high byte register address (low byte follows at 0x73)
+    static const auto FIFO_COUNT_H = 0x72;
+    // FIFO read/write register - successive reads return successive FIFO bytes
+    static const auto FIFO_R_W = 0x74;
+
+    // FIFO_EN: accelerometer and all three gyro axes
+    static const uint8_t FIFO_EN_ACCEL_GYRO = 0x78;
+    // INT_ENABLE / INT_STATUS bits: FIFO overflow, new sample
+    static const uint8_t INT_FIFO_OFLOW = 0x10;
+    static const uint8_t INT_DATA_RDY = 0x01;
+    // INT_PIN_CFG: INT_LEVEL, INT_OPEN, LATCH_INT_EN, INT_RD_CLEAR; all clear
+    // gives an active-high push-pull pulse and INT_STATUS cleared only when read
+    static const uint8_t INT_PIN_CFG_MODE_MASK = 0xF0;
+    // USER_CTRL bits
+    static const uint8_t USER_CTRL_FIFO_EN = 0x40;
+    static const uint8_t USER_CTRL_FIFO_RESET = 0x04;
+    // FIFO size in bytes and bytes per accelerometer + gyroscope frame
+    static const uint16_t FIFO_SIZE = 1024;
+    static const uint8_t FIFO_FRAME_SIZE = sizeof(RawSample);
 
-    bool setRegisterPointer(uint8_t reg);
+    void updateScales();
+    void convertSample(const uint8_t *buffer, MPU6050::MPU6050_Data &data) const;
+    void convertSample(const uint8_t *buffer, MPU6050::MPU6050_Fixed &data) const;
+    bool readFifoFrames(RawSample *samples, uint16_t count);
+    bool readReadyBurst(uint8_t *buffer);
+    bool measureBias(int16_t *accelBias, int16_t *gyroBias, uint16_t samples);
+    uint8_t takePendingInterrupts();
+    static void interruptTrampoline(void *context);
 };
 
 #endif // MPU6050_H
\ No newline at end of file
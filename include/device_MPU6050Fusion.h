@@ -0,0 +1,64 @@
+#ifndef MPU6050FUSION_H
+#define MPU6050FUSION_H
+
+#include <stdint.h>
+#include <device_MPU6050.h>
+
+// Attitude from MPU6050 raw samples: a Mahony filter (gyro integration,
+// with the accelerometer pulling the estimated gravity direction back into
+// line through a PI term) in integer arithmetic only.
+//
+// The quaternion is kept as int32 Q30 so a slow rotation still moves it
+// (one ±250°/s count at 200 Hz is a 3e-7 rad half-angle step); products use
+// the top 16 bits of one side (Q15), two 16x16 hardware multiplies each.
+// The accelerometer is normalized with a table-seeded Newton inverse square
+// root, the quaternion with a first-order (3 - |q|^2) / 2 step per update,
+// and the Euler angles come from a 65-entry atan table in flash.
+//
+// Feed it at the rate the sensor samples (setSampleRate()), e.g. from
+// readReadySample() or drainFifo(). Yaw is gyro only and drifts; roll and
+// pitch settle on the accelerometer with a time constant of about 1/Kp.
+class MPU6050Fusion {
+public:
+    MPU6050Fusion() = default;
+
+    // sampleRateHz as set with MPU6050::setSampleRate(), gyroRange as
+    // MPU6050::getGyroRange(). Fails for rates too low to scale the gyro
+    // (under 9 Hz at ±2000°/s). Resets the attitude; gains stay.
+    bool begin(uint16_t sampleRateHz, uint8_t gyroRange);
+
+    // Proportional and integral gain in thousandths (1000 = 1.0 rad/s per
+    // unit of error); Ki > 0 also learns a residual gyro bias. Defaults
+    // Kp = 1.0, Ki = 0. Call after begin().
+    bool setGains(uint16_t kpMilli, uint16_t kiMilli);
+
+    // Level, heading 0, integral cleared
+    void reset();
+
+    void update(const MPU6050::RawSample &sample);
+
+    // w, x, y, z in Q15
+    void getQuaternion(int16_t *quaternion) const;
+    // Centi-degrees: roll and yaw ±18000, pitch ±9000 (aerospace ZYX order)
+    void getEulerAngles(int16_t &roll, int16_t &pitch, int16_t &yaw) const;
+
+    // Building blocks, exposed for reuse and testing
+    static int16_t atan2Centi(int16_t y, int16_t x);
+    static uint16_t sqrt32(uint32_t value);
+
+private:
+    int32_t q[4] = {1L << 30, 0, 0, 0};  // w, x, y, z, Q30
+    int32_t integral[3] = {0, 0, 0};     // Q38 half-angle per update
+
+    uint16_t sampleRate = 0;
+    uint16_t gyroMultiplier = 0;  // half-angle per count in Q30 = raw * multiplier >> gyroShift
+    uint8_t gyroShift = 0;
+    int32_t kpStep = 0;           // Kp * dt / 2, Q30
+    int32_t kiStep = 0;           // Ki * dt * dt / 2, Q38
+    uint16_t kpMilli = 1000;
+    uint16_t kiMilli = 0;
+
+    void quaternionQ15(int16_t *out) const;
+};
+
+#endif // MPU6050FUSION_H
@@ -4,10 +4,42 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <protocol_SPI.h>
+#include <protocol_ExtInt.h>
+
+// Link statistics (NRF24::readStats()). Off by default; when 0 the counters
+// and the extra OBSERVE_TX/RPD reads are compiled out. It changes the class
+// layout, so set it for the whole build (-DNRF24_ENABLE_STATS=1), not per file.
+#ifndef NRF24_ENABLE_STATS
+#define NRF24_ENABLE_STATS 0
+#endif
 
 class NRF24 : protected SPI {
 public:
     static constexpr uint8_t MAX_PAYLOAD_SIZE = 32;
+    static constexpr uint8_t RX_QUEUE_DEPTH = 4;
+    static constexpr uint8_t CHANNEL_COUNT = 126;
+
+    // Received packet as queued by the IRQ-driven receive path
+    struct Packet {
+        uint8_t pipe;
+        uint8_t length;
+        uint8_t data[MAX_PAYLOAD_SIZE];
+    };
+
+    static constexpr bool STATS_ENABLED = NRF24_ENABLE_STATS != 0;
+
+    struct Stats {
+        uint32_t txDelivered;    // payloads confirmed by TX_DS
+        uint32_t txRetransmits;  // OBSERVE_TX ARC_CNT summed over deliveries and MAX_RT; a
+                                 // writeFast() stream reads it once per completion batch
+                                 // (last payload only), so there it is a lower bound
+        uint16_t txMaxRt;        // MAX_RT events (each one flushes the TX FIFO)
+        uint32_t rxPackets[6];   // per pipe
+        uint16_t rxFifoFull;     // IRQ drain found FIFO_STATUS RX_FULL (radio drops while full)
+        uint16_t rxQueueFull;    // IRQ drain stopped because the RX_QUEUE_DEPTH queue was full
+        uint32_t rpdSamples;     // RPD read after a receive
+        uint32_t rpdHits;        // ...of which the packet was above -64 dBm
+    };
 
     enum class DataRate : uint8_t {
         Rate250Kbps,
@@ -33,30 +65,143 @@ public:
 
     bool begin(bool enableAutoAck = true, uint8_t channel = 76, uint8_t payloadSize = MAX_PAYLOAD_SIZE);
 
+    // Select bit-banged or SPI-peripheral transfers (hardware needs MOSI/MISO/SCK
+    // on PB3/PB4/PB5). Can be called before or after begin().
+    bool setSpiBackend(SPI::Backend backend);
+
     void setAutoAck(bool enabled);
+    // Variable-length payloads (DYNPD/EN_DPL) on every enabled pipe; both ends
+    // must agree. Disabling also disables ACK payloads.
+    void setDynamicPayloads(bool enabled);
     bool setChannel(uint8_t channel);
+    uint8_t getChannel() const { return shadowRfCh; }
     bool setPayloadSize(uint8_t size);
     bool setDataRate(DataRate rate);
     void setPowerLevel(PowerLevel level);
 
+    // Auto-retransmit delay (250..4000 us, rounded up to the 250 us step) and
+    // count (0..15). The delay is raised to what the data rate and ACK
+    // payloads need: 500 us at 250 kbps, 500 us with ACK payloads (1500 us at
+    // 250 kbps).
+    bool setRetries(uint16_t delayUs, uint8_t count);
+    // Adaptive mode tunes ARD/ARC from OBSERVE_TX, starting from the
+    // setRetries() values (count becomes the ceiling). A MAX_RT means the
+    // obstruction outlasted the retry window (interference burst, receiver FIFO
+    // full), so the delay doubles and the count goes back to the ceiling.
+    // Every 16 deliveries the count is trimmed to twice the recent worst
+    // ARC_CNT plus two, and the delay steps back toward the minimum while that
+    // worst case uses under half the ceiling. Changes are written while the
+    // radio is in standby.
+    void setAdaptiveRetries(bool enabled);
+    uint16_t retryDelay() const { return static_cast<uint16_t>(((shadowSetupRetr >> 4) + 1) * 250U); }
+    uint8_t retryCount() const { return static_cast<uint8_t>(shadowSetupRetr & 0x0F); }
+
     void powerUp();
     void powerDown();
 
     void startListening();
     void stopListening();
 
+    // Interrupt-driven receive. The IRQ falling edge drains the radio RX FIFO
+    // into a RX_QUEUE_DEPTH packet queue; available()/read() then serve from
+    // the queue without touching SPI. TX_DS/MAX_RT are masked off the IRQ pin
+    // (write() still polls STATUS). enableIrq() attaches INT0/INT1 when the IRQ
+    // pin is PD2/PD3; for any other pin pass attachInterrupt = false and call
+    // handleIrq() from your own interrupt handler (e.g. a PCINT vector). If
+    // that lands inside one of the driver's own SPI transactions, the drain
+    // waits until the transaction ends. Call after begin().
+    bool enableIrq(bool attachInterrupt = true);
+    void disableIrq();
+    bool irqEnabled() const { return irqMode; }
+    void handleIrq();
+
     bool available();
     bool read(void *buffer, uint8_t length);
+    bool readPacket(Packet &packet);   // also returns pipe and length
     bool write(const void *buffer, uint8_t length, bool requestAck = true);
 
+    // Zero-copy payloads: bytes move between the radio and caller memory in
+    // pieces, so a struct goes out field by field with no staging buffer:
+    //   radio.beginPayloadWrite(sizeof(sample));
+    //   radio.writePayloadBytes(&sample.time, sizeof(sample.time));
+    //   radio.writePayloadBytes(sample.axes, sizeof(sample.axes));
+    //   bool delivered = radio.endPayloadWrite(); // waits like write()
+    // beginPayloadRead() opens the next packet (IRQ queue or radio FIFO) and
+    // reports its length and pipe; readPayloadBytes() takes the next bytes
+    // (nullptr skips them); endPayloadRead() drops the rest and releases the
+    // packet. Unwritten bytes are sent as 0xFF. Between begin and end the SPI
+    // transaction stays open (CSN low, IRQ masked): make no other radio call.
+    // readPayload() passes each byte of the next packet to the handler as it
+    // is shifted in, so decoding overlaps the transfer.
+    bool beginPayloadWrite(uint8_t length, bool requestAck = true);
+    bool writePayloadBytes(const void *data, uint8_t length);
+    bool endPayloadWrite();
+    bool beginPayloadRead(uint8_t &length, uint8_t &pipe);
+    bool readPayloadBytes(void *data, uint8_t length);
+    void endPayloadRead();
+    bool readPayload(SPI::ByteHandler handler, void *context);
+
+    // Streaming transmit. writeFast() queues a payload in the radio's 3-slot
+    // TX FIFO and returns; it only waits while the FIFO is full. CE stays high
+    // so queued packets go out back to back. Completions are reported through
+    // the callback from writeFast()/serviceTx()/txStandby(), in send order;
+    // while the FIFO is partly full a completion may be reported one packet
+    // late (the radio only exposes empty/full). On MAX_RT, packets acknowledged
+    // ahead of the failing one are reported delivered; the FIFO is flushed and
+    // the packets still in it are reported as failed.
+    typedef void (*TxCallback)(bool delivered, void *context);
+    void onTxComplete(TxCallback callback, void *context = nullptr);
+    bool writeFast(const void *buffer, uint8_t length, bool requestAck = true);
+    void serviceTx();
+    // Waits for the FIFO to drain, drops CE and restores listening if the
+    // stream interrupted it. Returns false if any packet since the last
+    // txStandby() failed or the wait timed out.
+    bool txStandby(uint16_t timeoutMs = 100);
+    uint8_t txInFlight() const { return txQueued; }
+
+    // ACK payloads: the receiver preloads a reply per pipe with
+    // writeAckPayload(); it goes back inside the auto-ACK of the next packet
+    // on that pipe. After a successful write() the transmitter finds it in
+    // the RX path (read()/readPacket(), pipe 0). Turns on dynamic payloads and
+    // needs auto-ack on the pipe. The reply shares the 3-slot TX FIFO.
+    void enableAckPayload(bool enabled = true);
+    bool writeAckPayload(uint8_t pipe, const void *data, uint8_t length);
+    // True if the last successful write() came back with an ACK payload
+    bool isAckPayloadAvailable() const { return ackPayloadReceived; }
+
     void openWritingPipe(const uint8_t *address, uint8_t length);
     void openReadingPipe(uint8_t pipe, const uint8_t *address, uint8_t length, bool enableAutoAck = true);
 
     uint8_t getStatus();
+    // STATUS as clocked out by the most recent SPI command (no bus traffic)
+    uint8_t lastStatus() const { return statusCache; }
+    // Re-reads the cached configuration registers, e.g. after a radio brown-out
+    void syncRegisterCache();
     void clearInterrupts(bool tx = true, bool rx = true, bool maxRetry = true);
     void flushTx();
     void flushRx();
 
+    // Received Power Detector: true if the carrier on the current channel was
+    // above -64 dBm (valid after 170 us in RX; latched on packet receipt)
+    bool testRpd();
+
+    // Channel scanner. Makes `samples` passes over all CHANNEL_COUNT channels;
+    // each sample is one short RX period (CE high for the 130 us settle plus
+    // 40 us AGC), and histogram[channel] counts how often RPD saw a carrier.
+    // About 23 ms per pass with the hardware SPI backend, so the default 8
+    // passes take roughly 190 ms. Channel, PRIM_RX, power-down and listening
+    // state are restored and the RX FIFO is kept; fails while a writeFast()
+    // stream is active.
+    bool scanChannels(uint8_t *histogram, uint8_t samples = 8);
+    // Channel in [first, last] with the least activity; 2 Mbps signals spread
+    // over two channels, so each neighbour counts half as much as the channel.
+    static uint8_t quietestChannel(const uint8_t *histogram, uint8_t first = 0, uint8_t last = CHANNEL_COUNT - 1);
+
+    // Snapshot and reset of the link statistics; all zero when
+    // NRF24_ENABLE_STATS is 0
+    void readStats(Stats &out) const;
+    void resetStats();
+
 private:
     uint8_t writeCommand(uint8_t command, const uint8_t *data = nullptr, uint8_t length = 0);
     bool writeRegister(uint8_t reg, uint8_t value);
@@ -64,6 +209,24 @@ private:
     uint8_t readRegister(uint8_t reg);
     void readRegister(uint8_t reg, uint8_t *data, uint8_t length);
 
+    // select()/deselect() that also keep the IRQ handler off the bus
+    void beginTransaction();
+    void endTransaction();
+    void lockIrq();
+    void unlockIrq();
+
+    void drainRxFifo();
+    uint8_t *shadowFor(uint8_t reg);
+    uint8_t pollTx();
+    void observeTx(bool delivered);
+    void adaptRetries(uint8_t arc, bool delivered);
+    void applyRetries();
+    uint8_t minRetryDelayStep() const;
+    void failInFlight();
+    uint8_t configBase() const;
+    static void irqTrampoline(void *context);
+
+    void resumeListening();
     void driveCe(bool high);
     void pulseCeHigh(uint16_t microseconds = 15);
 
@@ -85,12 +248,86 @@ private:
     uint8_t IRQ_MASK;
     bool hasIrqPin;
 
+    bool irqMode = false;
+    bool irqAttached = false;
+    ExtInt::Line irqLine = ExtInt::Line::Int0;
+    volatile uint8_t irqLockDepth = 0;
+
+    Packet rxQueue[RX_QUEUE_DEPTH];
+    volatile uint8_t rxHead = 0;
+    volatile uint8_t rxTail = 0;
+    volatile bool rxBacklog = false;   // queue was full, packets still in the radio
+
+    TxCallback txCallback = nullptr;
+    void *txCallbackContext = nullptr;
+    bool txStreaming = false;
+    bool txResumeListening = false;
+    bool txFailed = false;
+    uint8_t txQueued = 0;              // payloads uploaded and not yet reported
+
+    // Open beginPayloadWrite()/beginPayloadRead()
+    enum class PayloadStream : uint8_t {
+        None,
+        Write,
+        ReadRadio,   // R_RX_PAYLOAD transaction in progress
+        ReadQueue    // serving rxQueue[rxTail]
+    };
+    PayloadStream payloadStream = PayloadStream::None;
+    uint8_t streamRemaining = 0;
+    uint8_t streamOffset = 0;
+    uint8_t streamQueuedBefore = 0;
+    bool streamWasListening = false;
+
+    // Shadows of registers only this driver writes; kept current by
+    // writeRegister() so hot paths never read them back over SPI
+    uint8_t shadowConfig = 0;
+    uint8_t shadowEnAa = 0;
+    uint8_t shadowEnRxaddr = 0;
+    uint8_t shadowSetupAw = 0;
+    uint8_t shadowSetupRetr = 0;
+    uint8_t shadowRfCh = 0;
+    uint8_t shadowRfSetup = 0;
+    uint8_t shadowDynpd = 0;
+    uint8_t shadowFeature = 0;
+    uint8_t statusCache = 0;
+
     bool dynamicPayloads = false;
+    bool ackPayloads = false;
+    bool ackPayloadReceived = false;
     uint8_t payloadSize = MAX_PAYLOAD_SIZE;
     uint8_t enabledRxPipes = 0x03;
     bool autoAckEnabled = true;
     uint8_t autoAckMask = 0x3F;
 
+    // ARD as a 250 us step (0..15), ARC as 0..15
+    uint8_t retryDelayStep = 4;
+    uint8_t retryLimit = 15;
+    bool adaptiveRetries = false;
+    uint8_t adaptDelayStep = 4;
+    uint8_t adaptCount = 15;
+    uint8_t adaptSamples = 0;
+    uint8_t adaptMaxArc = 0;
+
+#if NRF24_ENABLE_STATS
+    Stats stats = {};
+    void statsTxDelivered() { ++stats.txDelivered; }
+    void statsTxRetries(uint8_t arc, bool maxRt) {
+        stats.txRetransmits += arc;
+        stats.txMaxRt += maxRt;
+    }
+    void statsRx(uint8_t pipe) { ++stats.rxPackets[pipe % 6]; }
+    void statsRxFifoFull() { ++stats.rxFifoFull; }
+    void statsRxQueueFull() { ++stats.rxQueueFull; }
+    void statsRpd();
+#else
+    void statsTxDelivered() {}
+    void statsTxRetries(uint8_t, bool) {}
+    void statsRx(uint8_t) {}
+    void statsRxFifoFull() {}
+    void statsRxQueueFull() {}
+    void statsRpd() {}
+#endif
+
     static constexpr uint8_t CMD_R_REGISTER = 0x00;
     static constexpr uint8_t CMD_W_REGISTER = 0x20;
     static constexpr uint8_t CMD_R_RX_PAYLOAD = 0x61;
@@ -142,13 +379,28 @@ private:
     static constexpr uint8_t STATUS_RX_DR = 1 << 6;
     static constexpr uint8_t STATUS_TX_DS = 1 << 5;
     static constexpr uint8_t STATUS_MAX_RT = 1 << 4;
+    static constexpr uint8_t STATUS_TX_FULL = 1 << 0;
+
+    static constexpr uint8_t FEATURE_EN_DPL = 1 << 2;
+    static constexpr uint8_t FEATURE_EN_ACK_PAY = 1 << 1;
+    static constexpr uint8_t FEATURE_EN_DYN_ACK = 1 << 0;
 
     static constexpr uint8_t FIFO_STATUS_RX_EMPTY = 1 << 0;
     static constexpr uint8_t FIFO_STATUS_RX_FULL = 1 << 1;
     static constexpr uint8_t FIFO_STATUS_TX_EMPTY = 1 << 4;
     static constexpr uint8_t FIFO_STATUS_TX_FULL = 1 << 5;
 
+    static constexpr uint8_t OBSERVE_TX_ARC_CNT = 0x0F;
+    static constexpr uint8_t RPD_RPD = 1 << 0;
+
+    static constexpr uint8_t RETRY_WINDOW = 16;
+    static constexpr uint8_t RETRY_MIN_COUNT = 3;
+
     static constexpr uint16_t CE_PULSE_US = 15;
+    static constexpr uint16_t RPD_SETTLE_US = 170; // Tstby2a + Tdelay_AGC
+    static constexpr uint8_t TX_FIFO_DEPTH = 3;
+    static constexpr uint16_t TX_FULL_WAIT_LOOPS = 2000; // x 50 us, as write()
+    static constexpr uint32_t SPI_CLOCK_HZ = 8000000UL; // F_CPU/2 on the peripheral, nRF24 max is 10 MHz
 };
 
 #endif // DEVICE_NRF24_H
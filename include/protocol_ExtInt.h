@@ -0,0 +1,51 @@
+#ifndef PROTOCOL_EXTINT_H
+#define PROTOCOL_EXTINT_H
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+// External interrupt lines INT0 (PD2) and INT1 (PD3).
+// Owns INT0_vect/INT1_vect and dispatches each edge to one registered
+// handler, so several drivers (NRF24 IRQ, MPU6050 data ready) can share the
+// vectors without defining their own ISRs.
+class ExtInt {
+public:
+    enum class Line : uint8_t {
+        Int0 = 0,   // PD2
+        Int1 = 1    // PD3
+    };
+
+    // ISCn1:ISCn0 encoding
+    enum class Trigger : uint8_t {
+        LowLevel = 0,
+        Change = 1,
+        Falling = 2,
+        Rising = 3
+    };
+
+    // Called from ISR context with the pointer passed to attach()
+    typedef void (*Handler)(void *context);
+
+    // Maps a pin to its INTn line. Returns false for pins other than PD2/PD3.
+    static bool lineForPin(volatile uint8_t *pinReg, uint8_t pin, Line &line);
+
+    // Registers the handler, sets the trigger, clears a stale flag and enables
+    // the line. Returns false if another handler already owns it.
+    static bool attach(Line line, Trigger trigger, Handler handler, void *context);
+    static void detach(Line line);
+
+    // Mask/unmask without dropping the handler. Edges seen while masked stay
+    // latched in EIFR and are dispatched on enable().
+    static void enable(Line line);
+    static void disable(Line line);
+    static bool enabled(Line line);
+
+    static void dispatch(Line line);
+
+private:
+    static Handler handlers[2];
+    static void *contexts[2];
+};
+
+#endif // PROTOCOL_EXTINT_H
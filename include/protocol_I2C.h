@@ -3,9 +3,44 @@
 
 #include <stdint.h>
 #include <avr/io.h>
+#include <util/delay.h>
+#include <protocol_Pins.h>
 
 class I2C {
 public:
+    // Bus engine. Hardware uses the TWI peripheral and needs SDA/SCL on PC4/PC5.
+    enum class Backend : uint8_t {
+        Software = 0,
+        Hardware = 1
+    };
+
+    enum class TransactionStatus : uint8_t {
+        Idle = 0,
+        Queued,
+        Busy,
+        Done,
+        AddressNack,
+        DataNack,
+        BusError
+    };
+
+    // Asynchronous write-then-read descriptor (TWI backend only).
+    // tx bytes are written, then rx bytes are read after a repeated START;
+    // either part may be empty. The descriptor and its buffers must stay
+    // valid until status leaves Queued/Busy. callback (optional) runs in ISR
+    // context and may submit further transactions.
+    struct Transaction {
+        uint8_t address;
+        const uint8_t *tx;
+        uint8_t txLength;
+        uint8_t *rx;
+        uint8_t rxLength;
+        void (*callback)(Transaction &transaction);
+        void *context;
+        volatile TransactionStatus status;
+        Transaction *next;   // queue link, managed by the driver
+    };
+
     // Preferred constructor: pass PINx, DDRx, PORTx pointers explicitly
     I2C(volatile uint8_t *sda_pin_reg, volatile uint8_t *sda_ddr, volatile uint8_t *sda_port, uint8_t sda_pin,
         volatile uint8_t *scl_pin_reg, volatile uint8_t *scl_ddr, volatile uint8_t *scl_port, uint8_t scl_pin);
@@ -13,14 +48,44 @@ public:
     // Delay config (microseconds)
     void setDelay(int microseconds);
 
+    // Bus clock: 100000 (standard) or 400000 (fast mode). Sets TWBR for the
+    // hardware backend and the per-phase delay for the software one.
+    void setClock(uint32_t frequencyHz);
+
+    // Returns false (and keeps the current backend) if the pins can't use TWI
+    bool setBackend(Backend backend);
+    Backend getBackend() const { return backend; }
+
     // Arbitration helpers
     bool arbitrationLost() const { return arbitration_lost; }
     void clearArbitrationFlag() { arbitration_lost = false; }
 
-    // High-level I2C operations
+    // High-level I2C operations. On the hardware backend they wait for
+    // submitted transactions to finish first, and return false instead if
+    // that can't happen (interrupts disabled, e.g. in a Transaction callback).
     bool writeMessage(uint8_t address, const uint8_t *data, unsigned int length);
     bool readMessage(uint8_t address, uint8_t *data, unsigned int length);
 
+    // Combined transfer: write tx, repeated START, read rx, single STOP.
+    // rxLength 0 makes it a plain write.
+    bool writeThenRead(uint8_t address, const uint8_t *tx, unsigned int txLength,
+                       uint8_t *rx, unsigned int rxLength);
+
+    // Register helpers for devices with an auto-incrementing register pointer
+    bool readRegisters(uint8_t address, uint8_t reg, uint8_t *data, unsigned int length);
+    bool readRegister(uint8_t address, uint8_t reg, uint8_t &value);
+    bool writeRegister(uint8_t address, uint8_t reg, uint8_t value);
+
+    // Queue a transaction on the interrupt-driven TWI engine. Queued
+    // transactions run back to back (STOP + START between them) without the
+    // caller re-entering the driver. Returns false on the software backend or
+    // if the descriptor is already in flight. Needs global interrupts enabled.
+    bool submit(Transaction &transaction);
+    static bool transactionsPending() { return twiBusy; }
+
+    // Called by the TWI ISR
+    static void onTwiInterrupt();
+
 private:
     // Registers for SDA
     volatile uint8_t *SDA_PIN_REG;
@@ -37,6 +102,9 @@ private:
     // Configurable delay
     int I2C_DELAY_US = 5;
 
+    Backend backend = Backend::Software;
+    uint8_t twiBitRate = 72;     // TWBR for 100 kHz at 16 MHz, prescaler 1
+
     // Low-level helpers
     void pull_scl_low();
     void release_scl();
@@ -48,11 +116,27 @@ private:
 
     inline void delay();
 
+    // TWI peripheral helpers
+    void applyHardwareConfig();
+    bool twiWait();
+    static bool twiClaim();
+    static void twiRelease();
+    uint8_t twiStatus() const { return static_cast<uint8_t>(TWSR & 0xF8); }
+
+    // Interrupt-driven engine state (one TWI peripheral per chip)
+    static Transaction *volatile twiQueueHead;
+    static Transaction *volatile twiQueueTail;
+    static volatile bool twiBusy;
+    static uint8_t twiIndex;
+    static bool twiReading;
+    static void twiFinish(TransactionStatus status);
+
 protected:
     bool writeByte(uint8_t data);
     bool readByte(uint8_t &data, bool ack);
 
     bool startCondition();
+    bool repeatedStartCondition();
     void stopCondition();
 
     bool waitForBusIdle(uint32_t timeoutUs = BUS_IDLE_TIMEOUT_US);
@@ -62,6 +146,229 @@ protected:
 
     static constexpr uint32_t CLOCK_HIGH_TIMEOUT_US = 10000;
     static constexpr uint32_t BUS_IDLE_TIMEOUT_US = 10000;
+    static constexpr uint16_t TWI_TIMEOUT_LOOPS = 0xFFFF;
+};
+
+// Bit-banged I2C master with SDA/SCL bound at compile time.
+// Same message API as I2C; open-drain emulation via single sbi/cbi accesses.
+// Example: I2CPins<PortC, PC4, PortC, PC5> i2c;
+template <class SdaPort, uint8_t SdaBit, class SclPort, uint8_t SclBit>
+class I2CPins {
+public:
+    typedef StaticPin<SdaPort, SdaBit> Sda;
+    typedef StaticPin<SclPort, SclBit> Scl;
+
+    I2CPins() {
+        releaseSda();
+        releaseScl();
+    }
+
+    void setDelay(int microseconds) {
+        delayUs = microseconds > 0 ? static_cast<uint8_t>(microseconds > 255 ? 255 : microseconds) : 1;
+    }
+
+    bool arbitrationLost() const { return arbitration_lost; }
+    void clearArbitrationFlag() { arbitration_lost = false; }
+
+    bool writeMessage(uint8_t address, const uint8_t *data, unsigned int length) {
+        if (!startCondition()) {
+            return false;
+        }
+        if (!writeByte(static_cast<uint8_t>(address << 1))) {
+            stopCondition();
+            return false;
+        }
+        for (unsigned int i = 0; i < length; i++) {
+            if (!writeByte(data[i])) {
+                stopCondition();
+                return false;
+            }
+        }
+        stopCondition();
+        return true;
+    }
+
+    bool readMessage(uint8_t address, uint8_t *data, unsigned int length) {
+        if (!startCondition()) {
+            return false;
+        }
+        if (!writeByte(static_cast<uint8_t>((address << 1) | 0x01))) {
+            stopCondition();
+            return false;
+        }
+        for (unsigned int i = 0; i < length; i++) {
+            if (!readByte(data[i], i < length - 1)) {
+                stopCondition();
+                return false;
+            }
+        }
+        stopCondition();
+        return true;
+    }
+
+protected:
+    bool writeByte(uint8_t data) {
+        for (uint8_t i = 0; i < 8; i++) {
+            pullSclLow();
+            delay();
+
+            const bool bit = (data & 0x80) != 0;
+            if (bit) {
+                releaseSda();
+            } else {
+                pullSdaLow();
+            }
+            delay();
+
+            releaseScl();
+            if (!waitForSclHigh()) {
+                pullSclLow();
+                return false;
+            }
+            delay();
+
+            if (bit && !Sda::read()) {
+                arbitration_lost = true;
+                releaseSda();
+                return false;
+            }
+
+            pullSclLow();
+            delay();
+
+            data <<= 1;
+        }
+
+        // ACK/NACK bit
+        pullSclLow();
+        releaseSda();
+        delay();
+
+        releaseScl();
+        if (!waitForSclHigh()) {
+            pullSclLow();
+            return false;
+        }
+        delay();
+
+        bool ack = !Sda::read();
+
+        pullSclLow();
+        delay();
+        releaseSda();
+
+        return ack && !arbitration_lost;
+    }
+
+    bool readByte(uint8_t &data, bool ack) {
+        data = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            data <<= 1;
+
+            pullSclLow();
+            releaseSda();
+            delay();
+
+            releaseScl();
+            if (!waitForSclHigh()) {
+                pullSclLow();
+                return false;
+            }
+            delay();
+
+            if (Sda::read()) {
+                data |= 0x01;
+            }
+        }
+
+        pullSclLow();
+        if (ack) {
+            pullSdaLow();
+        } else {
+            releaseSda();
+        }
+        delay();
+
+        releaseScl();
+        if (!waitForSclHigh()) {
+            pullSclLow();
+            releaseSda();
+            return false;
+        }
+        delay();
+
+        pullSclLow();
+        releaseSda();
+        return true;
+    }
+
+    bool startCondition() {
+        arbitration_lost = false;
+        if (!waitForBusIdle()) {
+            return false;
+        }
+        pullSdaLow();
+        delay();
+        pullSclLow();
+        delay();
+        return true;
+    }
+
+    void stopCondition() {
+        if (arbitration_lost) {
+            releaseSda();
+            releaseScl();
+            return;
+        }
+        pullSdaLow();
+        delay();
+        releaseScl();
+        waitForSclHigh();
+        delay();
+        releaseSda();
+        delay();
+    }
+
+    bool waitForBusIdle(uint32_t timeoutUs = I2C_PINS_TIMEOUT_US) {
+        releaseSda();
+        releaseScl();
+        while (timeoutUs--) {
+            if (Scl::read() && Sda::read()) {
+                return true;
+            }
+            _delay_us(1);
+        }
+        return false;
+    }
+
+    bool waitForSclHigh(uint32_t timeoutUs = I2C_PINS_TIMEOUT_US) {
+        while (timeoutUs--) {
+            if (Scl::read()) {
+                return true;
+            }
+            _delay_us(1);
+        }
+        return false;
+    }
+
+    bool arbitration_lost = false;
+
+private:
+    static constexpr uint32_t I2C_PINS_TIMEOUT_US = 10000;
+
+    uint8_t delayUs = 5;
+
+    // Open-drain emulation: drive low as output, release as input with pull-up
+    static inline void pullSclLow() { Scl::output(); Scl::low(); }
+    static inline void releaseScl() { Scl::input(); Scl::high(); }
+    static inline void pullSdaLow() { Sda::output(); Sda::low(); }
+    static inline void releaseSda() { Sda::input(); Sda::high(); }
+
+    inline void delay() const {
+        for (uint8_t i = 0; i < delayUs; ++i) {
+            _delay_us(1);
+        }
+    }
 };
 
 #endif // I2C_H
@@ -0,0 +1,83 @@
+#ifndef PROTOCOL_NRF24HOPPER_H
+#define PROTOCOL_NRF24HOPPER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <device_NRF24.h>
+
+// Packet-driven frequency hopping between one transmitter and one receiver.
+// Both ends share a channel set and a seed. The hop sequence is a series of
+// blocks, each a pseudo-random permutation of the set (16-bit LFSR), so every
+// channel comes up once per `count` hops. Each packet starts with its hop
+// position and a message sequence number; the sequence lets the receiver
+// drop a copy resent after a lost ACK.
+//
+// Transmitter: every attempt is one short auto-acked write() on the next
+// position, delivered or not, so a jammed channel costs one attempt rather
+// than the full retry budget. begin() sets 250 us x 2 retries for that.
+//
+// Receiver: waits on its position; a packet moves it to the position after
+// the one in the header. If a loss leaves it behind, the transmitter's
+// attempts visit its channel again within 2 * count - 1 hops and the header
+// resynchronizes it. If the receiver's own channel is jammed (RPD, sampled
+// every millisecond, sees a carrier twice in a row with no packet) it steps
+// ahead to where the transmitter's next attempt goes; after the silent dwell
+// (4 ms per channel by default) it steps ahead regardless, for interference
+// too weak to trip RPD. An idle receiver drifts the same way, so the first
+// send() after a long pause may take up to 2 * count - 1 attempts to find it;
+// setSilentDwell(0) turns the silent hop off.
+class NRF24Hopper {
+public:
+    static constexpr uint8_t MAX_CHANNELS = 16;
+    static constexpr uint8_t HEADER_SIZE = 2;
+    static constexpr uint8_t MAX_PAYLOAD = NRF24::MAX_PAYLOAD_SIZE - HEADER_SIZE;
+
+    explicit NRF24Hopper(NRF24 &radio);
+
+    // Channels must be distinct and <= 125; count 2..MAX_CHANNELS
+    bool begin(const uint8_t *channels, uint8_t count, uint16_t seed);
+
+    // Transmitter, from standby. maxAttempts 0 means 4 * count.
+    bool send(const void *data, uint8_t length, uint8_t maxAttempts = 0);
+    uint8_t attemptsUsed() const { return txAttempts; }
+
+    // Receiver. Call startReceiving() once, then receive() in a loop; only
+    // time spent waiting inside receive() counts toward the dwell.
+    void startReceiving();
+    bool receive(void *buffer, uint8_t length, uint8_t &received, uint16_t timeoutMs);
+    void setSilentDwell(uint16_t ms) { silentDwellSteps = static_cast<uint32_t>(ms) * (1000U / WAIT_STEP_US); }
+
+    uint8_t position() const { return hop; }
+    uint8_t channel() const { return radio.getChannel(); }
+    uint8_t channelAt(uint8_t position);
+
+private:
+    NRF24 &radio;
+    uint8_t channels[MAX_CHANNELS];
+    uint8_t order[MAX_CHANNELS];
+    uint8_t channelCount = 0;
+    uint8_t period = 0;          // count * (255 / count) positions
+    uint8_t orderBlock = 0xFF;   // block `order` was built for
+    uint16_t seed = 0;
+    uint8_t hop = 0;
+    uint8_t txAttempts = 0;
+    uint32_t silentSteps = 0;    // 50 us steps without a packet
+    uint32_t silentDwellSteps = 0; // up to 65535 ms of 50 us steps
+    uint8_t carrierSamples = 0;  // consecutive RPD hits without a packet
+    uint8_t txSequence = 0;
+    uint8_t rxSequence = 0;
+    bool rxSequenceValid = false;
+
+    uint8_t nextPosition(uint8_t position) const;
+    void moveTo(uint8_t position);
+    void buildOrder(uint8_t block);
+
+    static uint16_t lfsrStep(uint16_t state);
+
+    static constexpr uint16_t WAIT_STEP_US = 50;
+    static constexpr uint16_t RPD_SAMPLE_STEPS = 20; // every 1 ms
+    static constexpr uint8_t JAM_SAMPLES = 2;
+    static constexpr uint16_t SILENT_DWELL_MS_PER_CHANNEL = 4;
+};
+
+#endif // PROTOCOL_NRF24HOPPER_H
@@ -0,0 +1,100 @@
+#ifndef PROTOCOL_NRF24NETWORK_H
+#define PROTOCOL_NRF24NETWORK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <device_NRF24.h>
+
+// Star network over NRF24 with one level of relays. Node ids are octal-style:
+//   0            hub
+//   1..5         children of the hub
+//   (s << 3) | r grandchild s (1..4) of relay r (1..5), e.g. 011, 021 .. 045
+// so up to 1 + 5 + 20 nodes. Each node listens with a per-node address: the
+// hub on pipes 1-5 (one per child); a child on pipe 1 for its parent and on
+// pipes 2-5 for its own children. Pipe 0 only carries the auto-ACKs of this
+// node's transmissions. Frames climb towards the hub until they reach an
+// ancestor of the destination and then descend, so any node can reach any
+// other; each hop is an auto-acked write() with the radio's retries.
+//
+// Frame header (4 bytes): [to] [from] [id] [type], then up to MAX_PAYLOAD
+// bytes. A small ring of recently seen (from, id) pairs drops duplicates: the
+// radio only compares a retransmission with the single previous packet, so
+// with several children interleaving a retry after a lost ACK gets through.
+//
+// Everything is static: RX_QUEUE_DEPTH messages and DEDUP_DEPTH ring entries.
+// Call radio.begin() first; begin() switches on dynamic payloads, opens the
+// pipes and starts listening. Call update() often; it forwards relayed
+// frames and queues the ones addressed here for read().
+class NRF24Network {
+public:
+    static constexpr uint8_t HUB = 0;
+    static constexpr uint8_t NO_NODE = 0xFF;
+    static constexpr uint8_t HEADER_SIZE = 4;
+    static constexpr uint8_t MAX_PAYLOAD = NRF24::MAX_PAYLOAD_SIZE - HEADER_SIZE;
+    static constexpr uint8_t RX_QUEUE_DEPTH = 4;
+    static constexpr uint8_t DEDUP_DEPTH = 8;
+
+    struct Message {
+        uint8_t from;
+        uint8_t to;
+        uint8_t type;
+        uint8_t length;
+        uint8_t data[MAX_PAYLOAD];
+    };
+
+    explicit NRF24Network(NRF24 &radio);
+
+    bool begin(uint8_t nodeId, uint16_t networkId = 0x5AC3);
+    uint8_t nodeId() const { return node; }
+
+    // Originate a frame. False if `to` is not a valid node or the first hop
+    // was not acknowledged.
+    bool send(uint8_t to, uint8_t type, const void *data, uint8_t length);
+
+    // Drains the radio; returns the number of messages waiting for read()
+    uint8_t update();
+    bool available() const { return rxHead != rxTail; }
+    bool read(Message &message);
+
+    uint16_t forwarded() const { return forwardCount; }
+    uint16_t duplicates() const { return duplicateCount; }
+    uint16_t dropped() const { return dropCount; }   // relay failures and queue overflows
+
+    static bool validNode(uint8_t id);
+    static uint8_t parentOf(uint8_t id);
+
+private:
+    NRF24 &radio;
+    uint8_t node = NO_NODE;
+    uint8_t addressTail[3];
+    uint8_t txTarget = NO_NODE;
+    uint8_t txId = 0;
+
+    Message rxQueue[RX_QUEUE_DEPTH];
+    uint8_t rxHead = 0;
+    uint8_t rxTail = 0;
+
+    uint8_t seenFrom[DEDUP_DEPTH];
+    uint8_t seenId[DEDUP_DEPTH];
+    uint8_t seenNext = 0;
+
+    uint16_t forwardCount = 0;
+    uint16_t duplicateCount = 0;
+    uint16_t dropCount = 0;
+
+    uint8_t nextHop(uint8_t to) const;
+    bool transmit(uint8_t hop, const uint8_t *frame, uint8_t length);
+    bool seen(uint8_t from, uint8_t id);
+    void makeAddress(uint8_t id, uint8_t pipe, uint8_t *address) const;
+
+    static uint8_t levelOf(uint8_t id);
+    static uint8_t childPipe(uint8_t child);
+
+    static constexpr uint8_t ADDRESS_WIDTH = 5;
+    static constexpr uint8_t PARENT_PIPE = 1;
+    static constexpr uint8_t SLOT_MASK = 0x07;
+    static constexpr uint8_t MAX_CHILDREN_OF_HUB = 5;
+    static constexpr uint8_t MAX_CHILDREN_OF_RELAY = 4;
+};
+
+#endif // PROTOCOL_NRF24NETWORK_H
@@ -0,0 +1,82 @@
+#ifndef PROTOCOL_NRF24TRANSPORT_H
+#define PROTOCOL_NRF24TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <device_NRF24.h>
+
+// Message transport over NRF24: splits a buffer of up to MAX_MESSAGE_SIZE
+// bytes into sequenced fragments, streams them through the TX FIFO
+// (writeFast), and reassembles them into a caller-provided buffer on the
+// receiver. After each round the sender asks for the receiver's fragment
+// bitmap, which comes back as an ACK payload, and resends only the missing
+// fragments.
+//
+// Both radios need auto-ack on the pipe in use; begin() turns on ACK
+// payloads (and with them dynamic payloads). The sender calls send() from
+// standby (stopListening()); the receiver listens and calls poll() often
+// enough to keep the 3-deep RX FIFO drained (or uses NRF24::enableIrq()).
+//
+// Fragment header (3 bytes):
+//   [0] type (bits 7:6) | message id (bits 5:0)
+//   [1] fragment index   (STATUS: fragments received)
+//   [2] fragment count
+class NRF24Transport {
+public:
+    static constexpr uint8_t HEADER_SIZE = 3;
+    static constexpr uint8_t FRAGMENT_SIZE = NRF24::MAX_PAYLOAD_SIZE - HEADER_SIZE;
+    static constexpr uint8_t BITMAP_SIZE = NRF24::MAX_PAYLOAD_SIZE - HEADER_SIZE;
+    static constexpr uint8_t MAX_FRAGMENTS = BITMAP_SIZE * 8; // bitmap fits one ACK payload
+    static constexpr uint16_t MAX_MESSAGE_SIZE = static_cast<uint16_t>(MAX_FRAGMENTS) * FRAGMENT_SIZE;
+
+    explicit NRF24Transport(NRF24 &radio);
+
+    void begin();
+
+    // Sender. Returns true once the receiver has confirmed every fragment;
+    // false if it is still missing some after maxRounds.
+    bool send(const void *data, uint16_t length, uint8_t maxRounds = 4);
+    uint16_t fragmentsSent() const { return txFragmentsSent; } // last send(), including resends
+    uint8_t roundsUsed() const { return txRounds; }
+
+    // Receiver. The buffer must outlive the transport use. poll() drains the
+    // radio and returns true while a complete message is waiting; new
+    // messages are refused until releaseMessage().
+    void setReceiveBuffer(uint8_t *buffer, uint16_t capacity);
+    bool poll();
+    bool messageReady() const { return rxComplete && !rxReleased; }
+    uint16_t messageLength() const { return rxLength; }
+    void releaseMessage() { rxReleased = true; }
+
+private:
+    NRF24 &radio;
+
+    uint8_t txId = 0;
+    uint16_t txFragmentsSent = 0;
+    uint8_t txRounds = 0;
+
+    uint8_t *rxBuffer = nullptr;
+    uint16_t rxCapacity = 0;
+    uint8_t rxId = NO_MESSAGE;
+    uint8_t rxCount = 0;
+    uint8_t rxReceived = 0;
+    uint16_t rxLength = 0;
+    bool rxComplete = false;
+    bool rxReleased = true;
+    uint8_t rxBitmap[BITMAP_SIZE];
+
+    bool queryStatus(uint8_t id, uint8_t count, uint8_t *bitmap);
+    void handleData(const NRF24::Packet &packet);
+    void replyStatus(const NRF24::Packet &packet);
+
+    static constexpr uint8_t TYPE_DATA = 0;
+    static constexpr uint8_t TYPE_QUERY = 1;
+    static constexpr uint8_t TYPE_STATUS = 2;
+    static constexpr uint8_t ID_MASK = 0x3F;
+    static constexpr uint8_t NO_MESSAGE = 0xFF;
+
+    static constexpr uint8_t QUERY_ATTEMPTS = 4;
+    static constexpr uint16_t QUERY_GAP_US = 500; // receiver loads its reply meanwhile
+};
+
+#endif // PROTOCOL_NRF24TRANSPORT_H
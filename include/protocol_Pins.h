@@ -0,0 +1,45 @@
+#ifndef PROTOCOL_PINS_H
+#define PROTOCOL_PINS_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+// Compile-time GPIO port descriptors (ATmega328P).
+// Used as template arguments by the *Pins protocol variants, e.g.
+//   SPIPins<PortB, PB3, PortB, PB4, PortB, PB5, PortB, PB2>
+// With port and bit known at compile time every access below compiles to a
+// single sbi/cbi/sbic/sbis instruction instead of a pointer load plus
+// read-modify-write.
+struct PortB {
+    static inline volatile uint8_t &pin() { return PINB; }
+    static inline volatile uint8_t &ddr() { return DDRB; }
+    static inline volatile uint8_t &port() { return PORTB; }
+};
+
+struct PortC {
+    static inline volatile uint8_t &pin() { return PINC; }
+    static inline volatile uint8_t &ddr() { return DDRC; }
+    static inline volatile uint8_t &port() { return PORTC; }
+};
+
+struct PortD {
+    static inline volatile uint8_t &pin() { return PIND; }
+    static inline volatile uint8_t &ddr() { return DDRD; }
+    static inline volatile uint8_t &port() { return PORTD; }
+};
+
+// Single pin bound at compile time
+template <class Port, uint8_t Bit>
+struct StaticPin {
+    static constexpr uint8_t MASK = static_cast<uint8_t>(1U << Bit);
+
+    static inline void output() { Port::ddr() |= MASK; }
+    static inline void input() { Port::ddr() &= static_cast<uint8_t>(~MASK); }
+    static inline void high() { Port::port() |= MASK; }
+    static inline void low() { Port::port() &= static_cast<uint8_t>(~MASK); }
+    static inline void write(bool level) { if (level) high(); else low(); }
+    static inline void toggle() { Port::pin() = MASK; } // writing 1 to PINx toggles PORTx
+    static inline bool read() { return (Port::pin() & MASK) != 0; }
+};
+
+#endif // PROTOCOL_PINS_H
@@ -4,8 +4,18 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <avr/io.h>
+#include <util/delay_basic.h>
+#include <protocol_Pins.h>
 
 class SPI {
+    // Selects the deleted floating-point setDelaysMicroseconds() overload
+    // (avr-gcc ships no <type_traits>)
+    template <bool Enable, class T = void> struct EnableIf {};
+    template <class T> struct EnableIf<true, T> { typedef T type; };
+    template <class T> static constexpr bool isFractional() {
+        return static_cast<T>(0.5) != static_cast<T>(0);
+    }
+
 public:
     enum class BitOrder : uint8_t {
         MSBFirst = 0,
@@ -22,6 +32,17 @@ public:
         SampleTrailingEdge = 1
     };
 
+    // Transfer engine. Hardware uses the SPI peripheral (SPCR/SPDR) and needs
+    // MOSI/MISO/SCK on PB3/PB4/PB5; CS stays a GPIO and PB2 is forced to output
+    // so the peripheral stays in master mode. Each device keeps its own
+    // SPCR/SPSR and loads them in select(), so devices with different modes,
+    // bit orders or clocks can share the bus; a Software device on the
+    // hardware pins switches the peripheral off in select() instead.
+    enum class Backend : uint8_t {
+        Software = 0,
+        Hardware = 1
+    };
+
     SPI(volatile uint8_t *mosi_pin_reg, volatile uint8_t *mosi_ddr, volatile uint8_t *mosi_port, uint8_t mosi_pin,
         volatile uint8_t *miso_pin_reg, volatile uint8_t *miso_ddr, volatile uint8_t *miso_port, uint8_t miso_pin,
         volatile uint8_t *sck_pin_reg, volatile uint8_t *sck_ddr, volatile uint8_t *sck_port, uint8_t sck_pin,
@@ -34,17 +55,72 @@ public:
     void setBitOrder(BitOrder order);
     void setDataMode(uint8_t mode);
     void setDataMode(ClockPolarity polarity, ClockPhase phase);
-    void setDelaysMicroseconds(double lowPhase, double highPhase);
+    // Phase delays, rounded up to whole 4-cycle delay loops; 0 means no delay
+    void setDelaysMicroseconds(uint16_t lowPhaseUs, uint16_t highPhaseUs);
+    // Floating-point arguments are rejected; use setDelaysNanoseconds() for
+    // sub-microsecond phases.
+    template <class Low, class High>
+    typename EnableIf<isFractional<Low>() || isFractional<High>()>::type
+    setDelaysMicroseconds(Low lowPhaseUs, High highPhaseUs) = delete;
+    void setDelaysNanoseconds(uint32_t lowPhaseNs, uint32_t highPhaseNs);
+    void setDelayLoops(uint16_t lowLoops, uint16_t highLoops);
     void setClockHz(uint32_t frequencyHz);
+
+    // Compile-time clock, e.g. spi.setClock<SPIClock<4000000UL>>();
+    // Same result as setClockHz() with no runtime division.
+    template <class Clock>
+    void setClock() {
+        hwClockBits = Clock::HW_BITS;
+        computeHardwareConfig();
+        setDelayLoops(Clock::LOOPS, Clock::LOOPS);
+    }
+
+    // Integer timing helpers (constexpr, usable at compile time).
+    // Delay loops are 4 cycles; durations are rounded up so the clock never
+    // runs faster than requested.
+    static constexpr uint32_t CPU_MHZ = (F_CPU + 999999UL) / 1000000UL;
+
+    static constexpr uint16_t clampLoops(uint32_t loops) {
+        return loops > 0xFFFFUL ? 0xFFFF : static_cast<uint16_t>(loops);
+    }
+
+    static constexpr uint16_t loopsForNanoseconds(uint32_t ns) {
+        return ns == 0 ? 0
+             : ns > 100000000UL ? 0xFFFF
+             : clampLoops((ns * CPU_MHZ + 3999UL) / 4000UL);
+    }
+
+    static constexpr uint16_t loopsForClockHz(uint32_t hz) {
+        return hz == 0 ? 0xFFFF : loopsForNanoseconds((500000000UL + hz - 1) / hz);
+    }
+
+    // SPR1:SPR0 in bits 1:0, SPI2X in bit 7, for the smallest of
+    // F_CPU/2..F_CPU/128 not above hz
+    static constexpr uint8_t hardwareClockBits(uint32_t hz, uint8_t step = 0) {
+        return (step < 6 && (F_CPU / 2UL >> step) > hz) ? hardwareClockBits(hz, static_cast<uint8_t>(step + 1))
+             : step == 6 ? 0x03
+             : static_cast<uint8_t>((step >> 1) | ((step & 1) ? 0x00 : 0x80));
+    }
     void setChipSelectPolarity(bool activeLow);
     void setAutoChipSelect(bool enable);
 
+    // Returns false (and keeps the current backend) if the pins can't use the peripheral.
+    // Hardware also loads this device's setup into the peripheral right away.
+    bool setBackend(Backend backend);
+    Backend getBackend() const { return backend; }
+
     void select();
     void deselect();
 
     uint8_t transferByte(uint8_t data);
     void transferBytes(const uint8_t *tx, uint8_t *rx, size_t length);
+    // One-direction bursts; on the hardware backend they overlap the next
+    // byte with the current transfer. readBytes() clocks out 0xFF; rx may be
+    // nullptr to discard. The handler form passes each byte on as it arrives.
+    typedef void (*ByteHandler)(size_t index, uint8_t value, void *context);
     void writeBytes(const uint8_t *data, size_t length);
+    void readBytes(uint8_t *rx, size_t length);
+    void readBytes(ByteHandler handler, void *context, size_t length);
 
 private:
     volatile uint8_t *MOSI_PIN_REG;
@@ -75,23 +151,262 @@ private:
     ClockPolarity clockPolarity = ClockPolarity::IdleLow;
     ClockPhase clockPhase = ClockPhase::SampleLeadingEdge;
 
-    double delayLowUs = 1.0;
-    double delayHighUs = 1.0;
-    uint16_t delayLowLoops = 0;
-    uint16_t delayHighLoops = 0;
+    uint16_t delayLowLoops = loopsForNanoseconds(1000);  // 1 us per phase
+    uint16_t delayHighLoops = loopsForNanoseconds(1000);
 
     bool chipSelectActiveLow = true;
     bool autoChipSelect = true;
 
+    Backend backend = Backend::Software;
+    uint8_t hwClockBits = 0x82; // SPR1:SPR0 in bits 1:0, SPI2X in bit 7 (F_CPU/32 ~ default delays)
+    uint8_t hwSpcr = 0;         // this device's SPCR/SPSR, loaded by select()
+    uint8_t hwSpsr = 0;
+
+    // Byte transfer kernel for the current backend/mode/bit order/delays.
+    // Picked once by selectKernel() so the per-byte path has no mode checks.
+    typedef uint8_t (SPI::*TransferKernel)(uint8_t data);
+    TransferKernel transferKernel = nullptr;
+
     void driveMosi(bool high);
-    bool sampleMiso() const;
     void driveClockIdle();
-    void driveClockActive();
     void driveChipSelect(bool active);
-    void recomputeDelayLoops();
-    inline void waitLowPhase() const;
-    inline void waitHighPhase() const;
-    uint8_t transferByteCore(uint8_t data);
+    void selectKernel();
+    bool usesHardwarePins() const;
+    void enableHardware();
+    void computeHardwareConfig();
+
+    template <bool LsbFirst, bool SampleTrailing, bool Paced>
+    uint8_t softwareKernel(uint8_t data);
+    uint8_t hardwareKernel(uint8_t data);
+};
+
+// Compile-time SPI clock: delay loops per half period and hardware divider bits
+template <uint32_t Hz>
+struct SPIClock {
+    static_assert(Hz > 0, "SPI clock must be non-zero");
+    static constexpr uint16_t LOOPS = SPI::loopsForClockHz(Hz);
+    static constexpr uint8_t HW_BITS = SPI::hardwareClockBits(Hz);
+};
+
+// Bit-banged SPI master with pins bound at compile time.
+// Same transfer API as SPI; every pin access is a single sbi/cbi/sbic.
+// Example: SPIPins<PortB, PB3, PortB, PB4, PortB, PB5, PortB, PB2> spi;
+template <class MosiPort, uint8_t MosiBit, class MisoPort, uint8_t MisoBit,
+          class SckPort, uint8_t SckBit, class SsPort, uint8_t SsBit>
+class SPIPins {
+public:
+    typedef StaticPin<MosiPort, MosiBit> Mosi;
+    typedef StaticPin<MisoPort, MisoBit> Miso;
+    typedef StaticPin<SckPort, SckBit> Sck;
+    typedef StaticPin<SsPort, SsBit> Ss;
+
+    void begin(bool autoChipSelectParam = true) {
+        autoChipSelect = autoChipSelectParam;
+        Mosi::output();
+        Sck::output();
+        Ss::output();
+        Miso::input();
+        Mosi::low();
+        driveClockIdle();
+        deselect();
+    }
+
+    void setBitOrder(SPI::BitOrder order) { bitOrder = order; }
+
+    void setDataMode(uint8_t mode) {
+        clockIdleHigh = (mode & 0x02) != 0;
+        sampleTrailing = (mode & 0x01) != 0;
+        driveClockIdle();
+    }
+
+    // Half-period delay loops (4 cycles each); 0 runs as fast as the pins toggle
+    void setDelayLoops(uint16_t lowLoops, uint16_t highLoops) {
+        delayLowLoops = lowLoops;
+        delayHighLoops = highLoops;
+    }
+
+    void setClockHz(uint32_t frequencyHz) {
+        if (frequencyHz == 0) {
+            return;
+        }
+        uint16_t loops = SPI::loopsForClockHz(frequencyHz);
+        setDelayLoops(loops, loops);
+    }
+
+    void setChipSelectPolarity(bool activeLow) {
+        chipSelectActiveLow = activeLow;
+        deselect();
+    }
+
+    void setAutoChipSelect(bool enable) { autoChipSelect = enable; }
+
+    void select() { Ss::write(!chipSelectActiveLow); }
+    void deselect() { Ss::write(chipSelectActiveLow); }
+
+    uint8_t transferByte(uint8_t data) {
+        if (autoChipSelect) {
+            select();
+        }
+        uint8_t value = transferByteCore(data);
+        if (autoChipSelect) {
+            deselect();
+        }
+        return value;
+    }
+
+    void transferBytes(const uint8_t *tx, uint8_t *rx, size_t length) {
+        if (length == 0) {
+            return;
+        }
+        if (autoChipSelect) {
+            select();
+        }
+        for (size_t i = 0; i < length; ++i) {
+            uint8_t inbound = transferByteCore(tx ? tx[i] : 0xFF);
+            if (rx) {
+                rx[i] = inbound;
+            }
+        }
+        if (autoChipSelect) {
+            deselect();
+        }
+    }
+
+    void writeBytes(const uint8_t *data, size_t length) {
+        transferBytes(data, nullptr, length);
+    }
+
+    void readBytes(uint8_t *rx, size_t length) {
+        transferBytes(nullptr, rx, length);
+    }
+
+    void readBytes(SPI::ByteHandler handler, void *context, size_t length) {
+        if (length == 0) {
+            return;
+        }
+        if (autoChipSelect) {
+            select();
+        }
+        for (size_t i = 0; i < length; ++i) {
+            uint8_t inbound = transferByteCore(0xFF);
+            if (handler) {
+                handler(i, inbound, context);
+            }
+        }
+        if (autoChipSelect) {
+            deselect();
+        }
+    }
+
+private:
+    SPI::BitOrder bitOrder = SPI::BitOrder::MSBFirst;
+    bool clockIdleHigh = false;
+    bool sampleTrailing = false;
+    bool chipSelectActiveLow = true;
+    bool autoChipSelect = true;
+    uint16_t delayLowLoops = SPI::loopsForNanoseconds(1000);  // 1 us per phase, like SPI
+    uint16_t delayHighLoops = SPI::loopsForNanoseconds(1000);
+
+    void driveClockIdle() { Sck::write(clockIdleHigh); }
+
+    inline void waitLowPhase() const {
+        if (delayLowLoops) {
+            _delay_loop_2(delayLowLoops);
+        }
+    }
+
+    inline void waitHighPhase() const {
+        if (delayHighLoops) {
+            _delay_loop_2(delayHighLoops);
+        }
+    }
+
+    // Zero-delay path: fully unrolled, every bit is sbrc/sbi/cbi + two PINx stores
+    template <bool SampleTrailing>
+    static inline void fastBit(uint8_t data, uint8_t &received, uint8_t mask) {
+        if (!SampleTrailing) {
+            Mosi::write((data & mask) != 0);
+            Sck::toggle();
+            if (Miso::read()) {
+                received |= mask;
+            }
+            Sck::toggle();
+        } else {
+            Sck::toggle();
+            Mosi::write((data & mask) != 0);
+            Sck::toggle();
+            if (Miso::read()) {
+                received |= mask;
+            }
+        }
+    }
+
+    template <bool LsbFirst, bool SampleTrailing>
+    static uint8_t fastKernel(uint8_t data) {
+        uint8_t received = 0;
+        fastBit<SampleTrailing>(data, received, LsbFirst ? 0x01 : 0x80);
+        fastBit<SampleTrailing>(data, received, LsbFirst ? 0x02 : 0x40);
+        fastBit<SampleTrailing>(data, received, LsbFirst ? 0x04 : 0x20);
+        fastBit<SampleTrailing>(data, received, LsbFirst ? 0x08 : 0x10);
+        fastBit<SampleTrailing>(data, received, LsbFirst ? 0x10 : 0x08);
+        fastBit<SampleTrailing>(data, received, LsbFirst ? 0x20 : 0x04);
+        fastBit<SampleTrailing>(data, received, LsbFirst ? 0x40 : 0x02);
+        fastBit<SampleTrailing>(data, received, LsbFirst ? 0x80 : 0x01);
+        return received;
+    }
+
+    uint8_t transferByteCore(uint8_t data) {
+        bool lsbFirst = bitOrder == SPI::BitOrder::LSBFirst;
+        if (delayLowLoops == 0 && delayHighLoops == 0) {
+            if (!sampleTrailing) {
+                return lsbFirst ? fastKernel<true, false>(data) : fastKernel<false, false>(data);
+            }
+            return lsbFirst ? fastKernel<true, true>(data) : fastKernel<false, true>(data);
+        }
+
+        driveClockIdle();
+        if (!sampleTrailing) {
+            return lsbFirst ? pacedKernel<true, false>(data) : pacedKernel<false, false>(data);
+        }
+        return lsbFirst ? pacedKernel<true, true>(data) : pacedKernel<false, true>(data);
+    }
+
+    // Paced path: the bit order is fixed per instantiation, so the mask moves
+    // by one constant shift per bit instead of a variable shift
+    template <bool LsbFirst, bool SampleTrailing>
+    uint8_t pacedKernel(uint8_t data) const {
+        uint8_t received = 0;
+        uint8_t mask = LsbFirst ? 0x01 : 0x80;
+        for (uint8_t i = 0; i < 8; ++i) {
+            bool outBit = (data & mask) != 0;
+
+            // SCK edges are PINx toggles, independent of clock polarity
+            if (!SampleTrailing) {
+                Mosi::write(outBit);
+                waitLowPhase();
+                Sck::toggle();
+                waitHighPhase();
+                if (Miso::read()) {
+                    received |= mask;
+                }
+                Sck::toggle();
+                waitLowPhase();
+            } else {
+                Sck::toggle();
+                waitHighPhase();
+                Mosi::write(outBit);
+                waitLowPhase();
+                Sck::toggle();
+                if (Miso::read()) {
+                    received |= mask;
+                }
+                waitHighPhase();
+            }
+            mask = LsbFirst ? static_cast<uint8_t>(mask << 1) : static_cast<uint8_t>(mask >> 1);
+        }
+
+        return received;
+    }
 };
 
 #endif // PROTOCOL_SPI_H
\ No newline at end of file
@@ -1,9 +1,42 @@
+#ifndef PROTOCOL_UART_H
+#define PROTOCOL_UART_H
+
 #include <stdint.h>
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay_basic.h>
+#include <protocol_Pins.h>
+
+// The Timer1 engines (TxMode::Timer, RxMode::Timer) are in
+// protocol_UARTTimer.cpp, which defines TIMER1_COMPA_vect and
+// TIMER1_COMPB_vect. Build with -DUART_TIMER_ENGINE=0 to leave Timer1 and
+// both vectors to the application; setTxMode()/setRxMode() then only accept
+// Blocking. The PCINT0..2 vectors always belong to protocol_UART.cpp.
+#ifndef UART_TIMER_ENGINE
+#define UART_TIMER_ENGINE 1
+#endif
 
 class UART {
 
 public:
+    // TX engine selection:
+    //   Blocking: bit-banged with interrupts disabled (default, no timer needed)
+    //   Timer:    bytes are queued and shifted out by the Timer1 COMPA interrupt.
+    //             Timer1 is switched to normal mode, prescaler 1 (D9/D10 PWM unavailable).
+    enum class TxMode : uint8_t {
+        Blocking = 0,
+        Timer = 1
+    };
+
+    // RX engine selection:
+    //   Blocking: the PCINT ISR samples the whole frame (interrupts held ~1 frame)
+    //   Timer:    the PCINT edge only arms Timer1 COMPB; each bit is sampled in its
+    //             own short ISR, so several UARTs can receive at the same time.
+    enum class RxMode : uint8_t {
+        Blocking = 0,
+        Timer = 1
+    };
+
     // Bit-banged UART over arbitrary GPIO pins (AVR). RX uses Pin Change Interrupts.
     UART(volatile uint8_t *tx_pin_reg, volatile uint8_t *tx_ddr, volatile uint8_t *tx_port, uint8_t tx_pin,
          volatile uint8_t *rx_pin_reg, volatile uint8_t *rx_ddr, volatile uint8_t *rx_port, uint8_t rx_pin, unsigned long baud);
@@ -14,11 +47,28 @@ public:
     // Returns true on success. Passing 0 keeps existing baud.
     bool begin(unsigned long baud = 0);
 
-    // Transmit
+    // Transmit (returns immediately in TxMode::Timer unless the TX buffer is full)
     void sendByte(uint8_t data);
     void sendBytes(const uint8_t *data, unsigned int length);
     void sendString(const char *str);
 
+    // TX engine configuration. Returns false if the timer engine has no free
+    // slot or is compiled out (UART_TIMER_ENGINE=0).
+    bool setTxMode(TxMode mode);
+    TxMode txMode() const { return txEngine; }
+
+    // Idle bit times inserted after every stop bit (default 1, for DFPlayer / clones)
+    void setInterByteGap(uint8_t bits) { interByteGapBits = bits; }
+
+    // Timer TX status
+    uint8_t txPending() const;   // bytes queued or still being shifted out
+    void flushTx();              // wait until all queued bytes have left the pin
+
+    // RX engine configuration. Returns false if the timer engine has no free
+    // slot or is compiled out (UART_TIMER_ENGINE=0).
+    bool setRxMode(RxMode mode);
+    RxMode rxMode() const { return rxEngine; }
+
     // RX API (non-blocking)
     int available() const;   // number of bytes in RX buffer
     int read();              // returns -1 if none
@@ -57,6 +107,15 @@ private:
     uint16_t bitLoopCount;       // _delay_loop_2 count for full bit (4 cycles per count)
     uint16_t halfBitLoopCount;   // _delay_loop_2 count for half bit
 
+    // TX buffering (Timer1 COMPA driven)
+    static const uint8_t TX_BUF_SIZE = 32;
+    volatile uint8_t txBuf[TX_BUF_SIZE];
+    volatile uint8_t txHead = 0;
+    volatile uint8_t txTail = 0;
+    TxMode txEngine = TxMode::Blocking;
+    uint8_t interByteGapBits = 1;
+    uint16_t bitTicks;           // Timer1 ticks (CPU cycles) per bit
+
     // RX buffering (ISR-driven)
     static const uint8_t RX_BUF_SIZE = 64;
     volatile uint8_t rxBuf[RX_BUF_SIZE];
@@ -67,6 +126,12 @@ private:
     volatile uint16_t rxOverflowCount = 0;
     volatile uint16_t rxFrameErrorCount = 0;
 
+    // Timer RX state (Timer1 COMPB driven)
+    RxMode rxEngine = RxMode::Blocking;
+    volatile uint8_t rxBitIndex = 0;  // 0: waiting for start edge, 1 start, 2..9 data, 10 stop
+    uint8_t rxShiftReg = 0;
+    uint16_t rxNextSample = 0;        // Timer1 timestamp of the next bit center
+
     // Optional user callback (ISR context!)
     void (*rxCallback)(uint8_t) = nullptr;
 
@@ -88,12 +153,109 @@ public:
     static volatile uint8_t lastPINC;
     static volatile uint8_t lastPIND;
 
+    // Timer TX engine state (one UART shifts at a time, others wait their turn)
+    static const uint8_t MAX_TIMER_TX_UARTS = 4;
+    static UART *instancesTimerTx[MAX_TIMER_TX_UARTS];
+    static uint8_t countTimerTx;
+    static UART *volatile txActive;
+    static volatile uint8_t txShiftReg;
+    static volatile uint8_t txBitIndex;   // 0: idle/load, 1..8 data, 9 stop, 10.. gap
+
+    // Timer RX engine registry (all receivers share Timer1 COMPB)
+    static const uint8_t MAX_TIMER_RX_UARTS = 4;
+    static UART *instancesTimerRx[MAX_TIMER_RX_UARTS];
+    static uint8_t countTimerRx;
+
     // Called by ISR dispatchers
-    void onRxPinChange();
+    void onRxPinChange(uint16_t stamp);
+    static void onTxTimer();
+    static void onRxTimer();
 
     // Internal helpers
     void sampleRx();          // blocking sampling routine (inside ISR)
-    inline void storeRx(uint8_t b);
+    void storeRx(uint8_t b);
+    void sampleRxBit();       // one bit of a timer-sampled frame (inside COMPB ISR)
+    void rearmRxPinChange();
 
     void recomputeTiming();
-};
\ No newline at end of file
+    void sendByteBlocking(uint8_t data);
+    void queueTx(uint8_t data);
+    static void startTxTimer(UART *u);
+    static UART *nextPendingTx(UART *current);
+};
+
+// Blocking bit-banged UART transmitter with the TX pin bound at compile time.
+// Every bit edge is a single sbi/cbi, so less per-bit overhead has to be
+// compensated than in UART::sendByte. RX stays with the PCINT-based UART.
+// Example: UARTPins<PortD, PD1> debugTx(115200UL);
+template <class TxPort, uint8_t TxBit>
+class UARTPins {
+public:
+    typedef StaticPin<TxPort, TxBit> Tx;
+
+    explicit UARTPins(unsigned long baud) : baudrate(baud) {
+        recomputeTiming();
+    }
+
+    bool begin(unsigned long baud = 0) {
+        if (baud) {
+            baudrate = baud;
+            recomputeTiming();
+        }
+        Tx::output();
+        Tx::high();
+        return true;
+    }
+
+    void setInterByteGap(uint8_t bits) { interByteGapBits = bits; }
+
+    void sendByte(uint8_t data) {
+        uint8_t sreg = SREG; cli();
+
+        Tx::low(); // start bit
+        _delay_loop_2(bitLoopCount);
+
+        for (uint8_t i = 0; i < 8; i++) {
+            Tx::write((data & 0x01) != 0);
+            data >>= 1;
+            _delay_loop_2(bitLoopCount);
+        }
+
+        Tx::high(); // stop bit
+        _delay_loop_2(bitLoopCount);
+
+        SREG = sreg;
+
+        for (uint8_t i = 0; i < interByteGapBits; i++) {
+            _delay_loop_2(bitLoopCount);
+        }
+    }
+
+    void sendBytes(const uint8_t *data, unsigned int length) {
+        for (unsigned int i = 0; i < length; i++) {
+            sendByte(data[i]);
+        }
+    }
+
+    void sendString(const char *str) {
+        while (*str) {
+            sendByte(static_cast<uint8_t>(*str++));
+        }
+    }
+
+private:
+    unsigned long baudrate;
+    uint16_t bitLoopCount = 1;
+    uint8_t interByteGapBits = 1;
+
+    void recomputeTiming() {
+        if (baudrate == 0) baudrate = 9600;
+        unsigned long cyclesPerBit = F_CPU / baudrate;
+        if (cyclesPerBit < 40) cyclesPerBit = 40;
+        cyclesPerBit -= 8; // bit write + shift + loop overhead
+        bitLoopCount = static_cast<uint16_t>(cyclesPerBit / 4UL);
+        if (bitLoopCount == 0) bitLoopCount = 1;
+    }
+};
+
+#endif // PROTOCOL_UART_H
\ No newline at end of file
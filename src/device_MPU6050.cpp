@@ -1,4 +1,6 @@
 #include <device_MPU6050.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
 #include <util/delay.h>
 
 // bool MPU6050::readAllSensors(MPU6050_Data &data) {
@@ -33,17 +35,20 @@
 // }
 
 MPU6050::MPU6050(volatile uint8_t *sda_pin_reg, volatile uint8_t *sda_ddr, volatile uint8_t *sda_port, uint8_t sda_pin,
-                 volatile uint8_t *scl_pin_reg, volatile uint8_t *scl_ddr, volatile uint8_t *scl_port, uint8_t scl_pin) : 
+                 volatile uint8_t *scl_pin_reg, volatile uint8_t *scl_ddr, volatile uint8_t *scl_port, uint8_t scl_pin,
+                 volatile uint8_t *int_pin_reg, volatile uint8_t *int_ddr, volatile uint8_t *int_port, uint8_t int_pin) : 
                  I2C(sda_pin_reg, sda_ddr, sda_port, sda_pin,
-                 scl_pin_reg, scl_ddr, scl_port, scl_pin) {
+                 scl_pin_reg, scl_ddr, scl_port, scl_pin),
+                 INT_PIN_REG(int_pin_reg), INT_DDR(int_ddr), INT_PORT(int_port), INT_PIN(int_pin),
+                 INT_MASK(int_pin < 8 ? static_cast<uint8_t>(1U << int_pin) : 0),
+                 hasIntPin(int_pin_reg != nullptr && int_ddr != nullptr) {
                 
 }
 
 
 bool MPU6050::wakeUp() {
     // Write 0 to PWR_MGMT_1 to wake up the device
-    uint8_t data[2] = {PWR_MGMT_1, 0x00};
-    bool success = writeMessage(DEVICE_ADDRESS, data, 2);
+    bool success = writeRegister(DEVICE_ADDRESS, PWR_MGMT_1, 0x00);
 
     isAwake = success;
     return success;
@@ -51,70 +56,107 @@ bool MPU6050::wakeUp() {
 
 bool MPU6050::sleep() {
     // Write 1 to PWR_MGMT_1 to put the device to sleep
-    uint8_t data[2] = {PWR_MGMT_1, 0x40};
-    bool success = writeMessage(DEVICE_ADDRESS, data, 2);
+    bool success = writeRegister(DEVICE_ADDRESS, PWR_MGMT_1, 0x40);
     if (success) { isAwake = false; }
     return success;
 }
 
-bool MPU6050::setRegisterPointer(uint8_t reg) {
-    startCondition();
-    
-    bool success = writeByte((DEVICE_ADDRESS << 1) | 0); // Write mode
-    success = success && writeByte(reg);
-
-    return success;
-}
-
 bool MPU6050::initialize() {
     // Wake up the MPU6050
     bool success = wakeUp();
 
     // read accelerometer sensitivity
-    success = success && setRegisterPointer(ACCEL_CONFIG);
-    uint8_t accel_config;
-    success = success && readMessage(DEVICE_ADDRESS, &accel_config, 1);
+    uint8_t accel_config = 0;
+    success = success && readRegister(DEVICE_ADDRESS, ACCEL_CONFIG, accel_config);
     accel_range = (accel_config >> 3) & 0x03; // extract
 
-
-
-    // convert to sensitivity
-    switch (accel_range) {
-        case 0: accel_sensitivity = 16384.0; break; // ±2g
-        case 1: accel_sensitivity = 8192.0;  break; // ±4g
-        case 2: accel_sensitivity = 4096.0;  break; // ±8g
-        case 3: accel_sensitivity = 2048.0;  break; // ±16g
-        default: accel_sensitivity = 16384.0; break; // default to ±2g
-    }
-
     // read gyroscope range
-    success = success && setRegisterPointer(GYRO_CONFIG);
-    uint8_t gyro_config;
-    success = success && readMessage(DEVICE_ADDRESS, &gyro_config, 1);
+    uint8_t gyro_config = 0;
+    success = success && readRegister(DEVICE_ADDRESS, GYRO_CONFIG, gyro_config);
     gyro_range = (gyro_config >> 3) & 0x03; // extract
 
-    // convert to sensitivity
-    switch (gyro_range) {
-        case 0: gyro_sensitivity = 131.0;   break; // ±250°/s
-        case 1: gyro_sensitivity = 65.5;    break; // ±500°/s
-        case 2: gyro_sensitivity = 32.8;    break; // ±1000°/s
-        case 3: gyro_sensitivity = 16.4;    break; // ±2000°/s
-        default: gyro_sensitivity = 131.0;   break; // default to ±250°/s
-    }
+    // convert to per-count scale factors
+    updateScales();
 
     return success;
 }
 
+// Counts per unit: 16384/8192/4096/2048 per g and 131/65.5/32.8/16.4 per °/s
+static const float ACCEL_SENSITIVITY[4] = {16384.0, 8192.0, 4096.0, 2048.0}; // ±2/4/8/16g
+static const float GYRO_SENSITIVITY[4] = {131.0, 65.5, 32.8, 16.4};         // ±250/500/1000/2000°/s
+// 65536 * 1000 / counts per g (exact) and 4096 * 100 / counts per °/s
+static const int16_t ACCEL_MG_SCALE[4] = {4000, 8000, 16000, 32000};
+static const int16_t GYRO_CDPS_SCALE[4] = {3127, 6253, 12488, 24976};
+
+void MPU6050::updateScales() {
+    accel_scale = 1.0f / ACCEL_SENSITIVITY[accel_range];
+    gyro_scale = 1.0f / GYRO_SENSITIVITY[gyro_range];
+    accel_mg_scale = ACCEL_MG_SCALE[accel_range];
+    gyro_cdps_scale = GYRO_CDPS_SCALE[gyro_range];
+}
+
 bool MPU6050::readAllSensors(MPU6050::MPU6050_Data &data) {
-    setRegisterPointer(ACCEL_XOUT_H);
+    const uint8_t length = 14;
+    uint8_t buffer[length];
+
+    if (!readRegisters(DEVICE_ADDRESS, ACCEL_XOUT_H, buffer, length)) {
+        return false;
+    }
 
+    convertSample(buffer, data);
+    return true;
+}
+
+bool MPU6050::readAllSensors(MPU6050::MPU6050_Fixed &data) {
     const uint8_t length = 14;
     uint8_t buffer[length];
 
-    if (!readMessage(DEVICE_ADDRESS, buffer, length)) {
+    if (!readRegisters(DEVICE_ADDRESS, ACCEL_XOUT_H, buffer, length)) {
         return false;
     }
 
+    convertSample(buffer, data);
+    return true;
+}
+
+bool MPU6050::startReadAllSensors() {
+    if (asyncReadPending()) {
+        return false;
+    }
+    burstRead.address = DEVICE_ADDRESS;
+    burstRead.tx = &burstRegister;
+    burstRead.txLength = 1;
+    burstRead.rx = burstBuffer;
+    burstRead.rxLength = sizeof(burstBuffer);
+    burstRead.callback = nullptr;
+    burstRead.context = this;
+    return submit(burstRead);
+}
+
+bool MPU6050::asyncReadPending() const {
+    return burstRead.status == I2C::TransactionStatus::Queued ||
+           burstRead.status == I2C::TransactionStatus::Busy;
+}
+
+bool MPU6050::collectAllSensors(MPU6050::MPU6050_Data &data) {
+    if (burstRead.status != I2C::TransactionStatus::Done) {
+        return false;
+    }
+    burstRead.status = I2C::TransactionStatus::Idle;
+    convertSample(burstBuffer, data);
+    return true;
+}
+
+bool MPU6050::collectAllSensors(MPU6050::MPU6050_Fixed &data) {
+    if (burstRead.status != I2C::TransactionStatus::Done) {
+        return false;
+    }
+    burstRead.status = I2C::TransactionStatus::Idle;
+    convertSample(burstBuffer, data);
+    return true;
+}
+
+void MPU6050::convertSample(const uint8_t *buffer, MPU6050::MPU6050_Data &data) const {
     int16_t accelerometer[3]; // X, Y, Z
     int16_t gyroscope[3];     // X, Y, Z
     int16_t temperature;
@@ -131,47 +173,470 @@ bool MPU6050::readAllSensors(MPU6050::MPU6050_Data &data) {
     gyroscope[1] = (buffer[10] << 8) | buffer[11];  // Y-axis
     gyroscope[2] = (buffer[12] << 8) | buffer[13];  // Z-axis
 
-    // Convert to physical units
-    data.accel_x = static_cast<float>(accelerometer[0]) / accel_sensitivity;
-    data.accel_y = static_cast<float>(accelerometer[1]) / accel_sensitivity;
-    data.accel_z = static_cast<float>(accelerometer[2]) / accel_sensitivity;
+    // Convert to physical units (multiplies; a float divide costs ~3x more)
+    data.accel_x = static_cast<float>(accelerometer[0]) * accel_scale;
+    data.accel_y = static_cast<float>(accelerometer[1]) * accel_scale;
+    data.accel_z = static_cast<float>(accelerometer[2]) * accel_scale;
+
+    data.gyro_x = static_cast<float>(gyroscope[0]) * gyro_scale;
+    data.gyro_y = static_cast<float>(gyroscope[1]) * gyro_scale;
+    data.gyro_z = static_cast<float>(gyroscope[2]) * gyro_scale;
+
+    data.temperature = static_cast<float>(temperature) * (1.0f / 340.0f) + 36.53f;
+}
+
+void MPU6050::convertSample(const uint8_t *buffer, MPU6050::MPU6050_Fixed &data) const {
+    // Same byte layout as above: accel 0-5, temperature 6-7, gyro 8-13
+    data.accel_x = accelMilliG(static_cast<int16_t>((buffer[0] << 8) | buffer[1]));
+    data.accel_y = accelMilliG(static_cast<int16_t>((buffer[2] << 8) | buffer[3]));
+    data.accel_z = accelMilliG(static_cast<int16_t>((buffer[4] << 8) | buffer[5]));
+
+    data.temperature = temperatureCentiC(static_cast<int16_t>((buffer[6] << 8) | buffer[7]));
 
-    data.gyro_x = static_cast<float>(gyroscope[0]) / gyro_sensitivity;
-    data.gyro_y = static_cast<float>(gyroscope[1]) / gyro_sensitivity;
-    data.gyro_z = static_cast<float>(gyroscope[2]) / gyro_sensitivity;
+    data.gyro_x = gyroCentiDps(static_cast<int16_t>((buffer[8] << 8) | buffer[9]));
+    data.gyro_y = gyroCentiDps(static_cast<int16_t>((buffer[10] << 8) | buffer[11]));
+    data.gyro_z = gyroCentiDps(static_cast<int16_t>((buffer[12] << 8) | buffer[13]));
+}
 
-    data.temperature = (static_cast<float>(temperature) / 340.0) + 36.53;
+bool MPU6050::setDigitalLowPass(uint8_t config) {
+    if (config > 6) {
+        return false;
+    }
 
+    uint8_t value;
+    if (!readRegister(DEVICE_ADDRESS, CONFIG, value)) {
+        return false;
+    }
+    value = (value & 0xF8) | config; // keep EXT_SYNC_SET
+    return writeRegister(DEVICE_ADDRESS, CONFIG, value);
+}
+
+bool MPU6050::setSampleRate(uint16_t hz) {
+    uint8_t config;
+    if (hz == 0 || !readRegister(DEVICE_ADDRESS, CONFIG, config)) {
+        return false;
+    }
+
+    uint8_t dlpf = config & 0x07;
+    uint16_t gyroRate = (dlpf == 0 || dlpf == 7) ? 8000 : 1000;
+    if (hz > gyroRate || gyroRate % hz != 0 || gyroRate / hz > 256) {
+        return false;
+    }
+    return writeRegister(DEVICE_ADDRESS, SMPLRT_DIV, static_cast<uint8_t>(gyroRate / hz - 1));
+}
+
+// The FIFO overflow interrupt source is enabled so INT_STATUS reports it
+bool MPU6050::startFifo() {
+    uint8_t intEnable;
+    if (!readRegister(DEVICE_ADDRESS, INT_ENABLE, intEnable) ||
+        !writeRegister(DEVICE_ADDRESS, INT_ENABLE, intEnable | INT_FIFO_OFLOW) ||
+        !writeRegister(DEVICE_ADDRESS, FIFO_EN, FIFO_EN_ACCEL_GYRO)) {
+        return false;
+    }
+    return resetFifo();
+}
+
+bool MPU6050::stopFifo() {
+    bool success = writeRegister(DEVICE_ADDRESS, USER_CTRL, 0x00);
+    success = writeRegister(DEVICE_ADDRESS, FIFO_EN, 0x00) && success;
+
+    uint8_t intEnable;
+    return success && readRegister(DEVICE_ADDRESS, INT_ENABLE, intEnable) &&
+           writeRegister(DEVICE_ADDRESS, INT_ENABLE, intEnable & ~INT_FIFO_OFLOW);
+}
+
+// FIFO_RESET only acts while FIFO_EN is clear; it clears itself. Reading
+// INT_STATUS drops an overflow flag left from before the reset.
+bool MPU6050::resetFifo() {
+    uint8_t status;
+    if (!writeRegister(DEVICE_ADDRESS, USER_CTRL, 0x00) ||
+        !writeRegister(DEVICE_ADDRESS, USER_CTRL, USER_CTRL_FIFO_RESET) ||
+        !readRegister(DEVICE_ADDRESS, INT_STATUS, status) ||
+        !writeRegister(DEVICE_ADDRESS, USER_CTRL, USER_CTRL_FIFO_EN)) {
+        return false;
+    }
+    fifoOverflowSeen = false;
+    return true;
+}
+
+bool MPU6050::readFifoCount(uint16_t &bytes) {
+    uint8_t count[2];
+    if (!readRegisters(DEVICE_ADDRESS, FIFO_COUNT_H, count, 2)) {
+        return false;
+    }
+    bytes = static_cast<uint16_t>((count[0] << 8) | count[1]);
+    return true;
+}
+
+bool MPU6050::drainFifo(SampleRing &ring) {
+    if (ring.samples == nullptr || ring.capacity < 2) {
+        return false;
+    }
+
+    // Everything the pulses announced is in the FIFO and read below
+    takePendingInterrupts();
+
+    uint16_t bytes;
+    if (!readFifoCount(bytes)) {
+        return false;
+    }
+    // Frames are read whole, so a count off the frame size means an overflow
+    // dropped part of one (1024 is not a multiple of 12)
+    if (fifoOverflowSeen || bytes >= FIFO_SIZE || bytes % FIFO_FRAME_SIZE != 0) {
+        ++fifoOverflowCount;
+        return resetFifo();
+    }
+
+    uint16_t frames = bytes / FIFO_FRAME_SIZE;
+    uint16_t head = ring.head;
+    while (frames) {
+        // Contiguous free slots from head, keeping the one before tail empty
+        uint16_t space = ring.tail > head ? static_cast<uint16_t>(ring.tail - head - 1)
+                                          : static_cast<uint16_t>(ring.capacity - head - (ring.tail == 0 ? 1 : 0));
+        uint16_t batch = frames < space ? frames : space;
+        if (batch == 0) {
+            break;
+        }
+        if (!readFifoFrames(&ring.samples[head], batch)) {
+            resetFifo(); // a partial read leaves the FIFO out of frame alignment
+            return false;
+        }
+        head = static_cast<uint16_t>(head + batch);
+        if (head == ring.capacity) {
+            head = 0;
+        }
+        frames = static_cast<uint16_t>(frames - batch);
+    }
+
+    // Starting from a FIFO more than half full, it may have overflowed during
+    // the read (the bus reading slower than the sensor fills, e.g. 1 kHz on a
+    // 100 kHz bus), splicing a frame. Only then is FIFO_OFLOW checked and the
+    // batch dropped; from below half full it would take a bus at under half
+    // the fill rate.
+    if (bytes >= FIFO_SIZE / 2) {
+        uint8_t status;
+        if (!readRegister(DEVICE_ADDRESS, INT_STATUS, status)) {
+            return false;
+        }
+        if (status & INT_FIFO_OFLOW) {
+            ++fifoOverflowCount;
+            resetFifo();
+            return false;
+        }
+    }
+    ring.head = head;
+    return true;
+}
+
+// FIFO_R_W does not advance the register pointer, so one burst returns
+// consecutive FIFO bytes; they arrive big-endian and are swapped in place
+bool MPU6050::readFifoFrames(RawSample *samples, uint16_t count) {
+    uint8_t *bytes = reinterpret_cast<uint8_t *>(samples);
+    uint16_t length = static_cast<uint16_t>(count * FIFO_FRAME_SIZE);
+    if (!readRegisters(DEVICE_ADDRESS, FIFO_R_W, bytes, length)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < length; i += 2) {
+        uint8_t high = bytes[i];
+        bytes[i] = bytes[i + 1];
+        bytes[i + 1] = high;
+    }
     return true;
 }
 
+// Only the data-ready source is touched in INT_ENABLE; the FIFO overflow bit
+// stays with startFifo()/stopFifo(). A DATA_RDY flag left in INT_STATUS from
+// before is harmless: it is overwritten by the sample the first pulse reports.
+bool MPU6050::enableInterrupt(bool attachInterrupt) {
+    if (!hasIntPin) {
+        return false;
+    }
+    if (attachInterrupt && !ExtInt::lineForPin(INT_PIN_REG, INT_PIN, intLine)) {
+        return false;
+    }
+
+    (*INT_DDR) &= static_cast<uint8_t>(~INT_MASK);
+    if (INT_PORT) {
+        (*INT_PORT) &= static_cast<uint8_t>(~INT_MASK); // driven push-pull, no pull-up
+    }
+
+    uint8_t pinConfig;
+    uint8_t intEnable;
+    if (!readRegister(DEVICE_ADDRESS, INT_PIN_CFG, pinConfig) ||
+        !writeRegister(DEVICE_ADDRESS, INT_PIN_CFG, pinConfig & ~INT_PIN_CFG_MODE_MASK) ||
+        !readRegister(DEVICE_ADDRESS, INT_ENABLE, intEnable)) {
+        return false;
+    }
+
+    takePendingInterrupts();
+    if (attachInterrupt && !intAttached) {
+        if (!ExtInt::attach(intLine, ExtInt::Trigger::Rising, interruptTrampoline, this)) {
+            return false;
+        }
+        intAttached = true;
+    }
+    if (!writeRegister(DEVICE_ADDRESS, INT_ENABLE, intEnable | INT_DATA_RDY)) {
+        disableInterrupt();
+        return false;
+    }
+    return true;
+}
+
+void MPU6050::disableInterrupt() {
+    if (intAttached) {
+        ExtInt::detach(intLine);
+        intAttached = false;
+    }
+    uint8_t intEnable;
+    if (readRegister(DEVICE_ADDRESS, INT_ENABLE, intEnable)) {
+        writeRegister(DEVICE_ADDRESS, INT_ENABLE, intEnable & ~INT_DATA_RDY);
+    }
+    takePendingInterrupts();
+}
+
+void MPU6050::handleInterrupt() {
+    uint8_t pending = pendingInterrupts;
+    if (pending != 0xFF) {
+        pendingInterrupts = static_cast<uint8_t>(pending + 1);
+    }
+}
+
+void MPU6050::interruptTrampoline(void *context) {
+    static_cast<MPU6050 *>(context)->handleInterrupt();
+}
+
+uint8_t MPU6050::takePendingInterrupts() {
+    uint8_t sreg = SREG; cli();
+    uint8_t pending = pendingInterrupts;
+    pendingInterrupts = 0;
+    SREG = sreg;
+    return pending;
+}
+
+bool MPU6050::readReadySample(MPU6050::MPU6050_Data &data) {
+    uint8_t buffer[15];
+    if (!readReadyBurst(buffer)) {
+        return false;
+    }
+    convertSample(&buffer[1], data);
+    return true;
+}
+
+bool MPU6050::readReadySample(MPU6050::MPU6050_Fixed &data) {
+    uint8_t buffer[15];
+    if (!readReadyBurst(buffer)) {
+        return false;
+    }
+    convertSample(&buffer[1], data);
+    return true;
+}
+
+bool MPU6050::readReadySample(RawSample &sample) {
+    uint8_t buffer[15];
+    if (!readReadyBurst(buffer)) {
+        return false;
+    }
+    sample.accel_x = static_cast<int16_t>((buffer[1] << 8) | buffer[2]);
+    sample.accel_y = static_cast<int16_t>((buffer[3] << 8) | buffer[4]);
+    sample.accel_z = static_cast<int16_t>((buffer[5] << 8) | buffer[6]);
+    sample.gyro_x = static_cast<int16_t>((buffer[9] << 8) | buffer[10]);
+    sample.gyro_y = static_cast<int16_t>((buffer[11] << 8) | buffer[12]);
+    sample.gyro_z = static_cast<int16_t>((buffer[13] << 8) | buffer[14]);
+    return true;
+}
+
+// INT_STATUS (0x3A) sits right before ACCEL_XOUT_H, so one burst returns the
+// status and the 14 sample bytes; the sensor holds the sample registers
+// still while it is read. buffer[0] is INT_STATUS, buffer[1..14] the sample.
+// Each DATA_RDY means one sample not read yet, so pulses beyond it were
+// samples overwritten before the loop got to them.
+bool MPU6050::readReadyBurst(uint8_t *buffer) {
+    uint8_t pulses = takePendingInterrupts();
+    if (pulses == 0) {
+        return false;
+    }
+    if (!readRegisters(DEVICE_ADDRESS, INT_STATUS, buffer, 15)) {
+        skippedSampleCount += pulses;
+        return false;
+    }
+
+    uint8_t status = buffer[0];
+    if (status & INT_FIFO_OFLOW) {
+        fifoOverflowSeen = true; // reading INT_STATUS cleared it for drainFifo()
+        if (pulses) {
+            --pulses;
+        }
+    }
+    uint8_t fresh = (status & INT_DATA_RDY) ? 1 : 0;
+    if (pulses > fresh) {
+        skippedSampleCount += static_cast<uint16_t>(pulses - fresh);
+    }
+    return fresh != 0;
+}
+
+// Counts at the current range: accel 16384 >> range per g, gyro 131 >> range
+// (roughly) per °/s. The offset registers count in ±16g and ±1000°/s units,
+// so an accel bias is shifted down by 3 - range and a gyro bias scaled by
+// 2^range / 4 before it is subtracted.
+bool MPU6050::calibrate(uint16_t samples) {
+    if (samples == 0) {
+        return false;
+    }
+
+    Offsets offsets;
+    if (!readOffsets(offsets)) {
+        return false;
+    }
+
+    int16_t *accel = &offsets.accel_x;
+    int16_t *gyro = &offsets.gyro_x;
+    // The second pass takes out what the first left behind: rounding, and
+    // most of any error in the nominal offset register scale
+    for (uint8_t pass = 0; pass < 2; ++pass) {
+        int16_t accelBias[3];
+        int16_t gyroBias[3];
+        if (!measureBias(accelBias, gyroBias, samples)) {
+            return false;
+        }
+        accelBias[2] = static_cast<int16_t>(accelBias[2] - (16384 >> accel_range)); // gravity
+
+        for (uint8_t axis = 0; axis < 3; ++axis) {
+            uint8_t accelShift = static_cast<uint8_t>(3 - accel_range);
+            int32_t accelStep = accelShift ? (static_cast<int32_t>(accelBias[axis]) + (1 << (accelShift - 1))) >> accelShift
+                                           : accelBias[axis];
+            accel[axis] = static_cast<int16_t>(((accel[axis] - accelStep) & ~1) | (accel[axis] & 1)); // keep bit 0
+
+            int32_t gyroStep = (static_cast<int32_t>(gyroBias[axis]) << gyro_range) + 2;
+            gyro[axis] = static_cast<int16_t>(gyro[axis] - (gyroStep >> 2));
+        }
+        if (!writeOffsets(offsets)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Mean accelerometer and gyroscope counts over the given number of bursts
+bool MPU6050::measureBias(int16_t *accelBias, int16_t *gyroBias, uint16_t samples) {
+    int32_t sums[6] = {0, 0, 0, 0, 0, 0};
+    uint8_t buffer[14];
+
+    _delay_ms(20); // let new offsets reach the output registers
+    for (uint16_t i = 0; i < samples; ++i) {
+        if (!readRegisters(DEVICE_ADDRESS, ACCEL_XOUT_H, buffer, sizeof(buffer))) {
+            return false;
+        }
+        for (uint8_t axis = 0; axis < 3; ++axis) {
+            sums[axis] += static_cast<int16_t>((buffer[2 * axis] << 8) | buffer[2 * axis + 1]);
+            sums[3 + axis] += static_cast<int16_t>((buffer[8 + 2 * axis] << 8) | buffer[9 + 2 * axis]);
+        }
+        _delay_ms(2);
+    }
+
+    for (uint8_t axis = 0; axis < 3; ++axis) {
+        accelBias[axis] = static_cast<int16_t>(sums[axis] / samples);
+        gyroBias[axis] = static_cast<int16_t>(sums[3 + axis] / samples);
+    }
+    return true;
+}
+
+bool MPU6050::readOffsets(Offsets &offsets) {
+    uint8_t accel[6];
+    uint8_t gyro[6];
+    if (!readRegisters(DEVICE_ADDRESS, XA_OFFS_H, accel, sizeof(accel)) ||
+        !readRegisters(DEVICE_ADDRESS, XG_OFFS_USRH, gyro, sizeof(gyro))) {
+        return false;
+    }
+
+    int16_t *accelOut = &offsets.accel_x;
+    int16_t *gyroOut = &offsets.gyro_x;
+    for (uint8_t axis = 0; axis < 3; ++axis) {
+        accelOut[axis] = static_cast<int16_t>((accel[2 * axis] << 8) | accel[2 * axis + 1]);
+        gyroOut[axis] = static_cast<int16_t>((gyro[2 * axis] << 8) | gyro[2 * axis + 1]);
+    }
+    return true;
+}
+
+// Bit 0 of each accel offset is reserved; the sensor's own value is kept
+bool MPU6050::writeOffsets(const Offsets &offsets) {
+    uint8_t accel[7] = {XA_OFFS_H};
+    uint8_t gyro[7] = {XG_OFFS_USRH};
+    if (!readRegisters(DEVICE_ADDRESS, XA_OFFS_H, &accel[1], 6)) {
+        return false;
+    }
+
+    const int16_t *accelIn = &offsets.accel_x;
+    const int16_t *gyroIn = &offsets.gyro_x;
+    for (uint8_t axis = 0; axis < 3; ++axis) {
+        uint8_t reserved = accel[2 + 2 * axis] & 0x01;
+        accel[1 + 2 * axis] = static_cast<uint8_t>(accelIn[axis] >> 8);
+        accel[2 + 2 * axis] = static_cast<uint8_t>((accelIn[axis] & 0xFE) | reserved);
+        gyro[1 + 2 * axis] = static_cast<uint8_t>(gyroIn[axis] >> 8);
+        gyro[2 + 2 * axis] = static_cast<uint8_t>(gyroIn[axis]);
+    }
+    return writeMessage(DEVICE_ADDRESS, accel, sizeof(accel)) &&
+           writeMessage(DEVICE_ADDRESS, gyro, sizeof(gyro));
+}
+
+// EEPROM record: marker byte, the Offsets, checksum byte
+static const uint8_t OFFSETS_MARKER = 0xC6;
+
+static uint8_t offsetsChecksum(const MPU6050::Offsets &offsets) {
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&offsets);
+    uint8_t sum = OFFSETS_MARKER;
+    for (uint8_t i = 0; i < sizeof(offsets); ++i) {
+        sum = static_cast<uint8_t>(((sum << 1) | (sum >> 7)) ^ bytes[i]);
+    }
+    return sum;
+}
+
+bool MPU6050::saveOffsets(uint16_t eepromAddress) {
+    Offsets offsets;
+    if (!readOffsets(offsets)) {
+        return false;
+    }
+
+    uint8_t *record = reinterpret_cast<uint8_t *>(eepromAddress);
+    eeprom_update_byte(record, OFFSETS_MARKER);
+    eeprom_update_block(&offsets, record + 1, sizeof(offsets));
+    eeprom_update_byte(record + 1 + sizeof(offsets), offsetsChecksum(offsets));
+    return true;
+}
+
+bool MPU6050::restoreOffsets(uint16_t eepromAddress) {
+    const uint8_t *record = reinterpret_cast<const uint8_t *>(eepromAddress);
+    if (eeprom_read_byte(record) != OFFSETS_MARKER) {
+        return false;
+    }
+
+    Offsets offsets;
+    eeprom_read_block(&offsets, record + 1, sizeof(offsets));
+    if (eeprom_read_byte(record + 1 + sizeof(offsets)) != offsetsChecksum(offsets)) {
+        return false;
+    }
+    return writeOffsets(offsets);
+}
+
 bool MPU6050::setAccelRange(int range) { // 0=±2g,1=±4g,2=±8g,3=±16g
     if (range < 0 || range > 3) {
         return false; // Invalid range
     }
 
     // Read the current ACCEL_CONFIG value
-    setRegisterPointer(ACCEL_CONFIG);
     uint8_t accel_config;
-    if (!readMessage(DEVICE_ADDRESS, &accel_config, 1)) {
+    if (!readRegister(DEVICE_ADDRESS, ACCEL_CONFIG, accel_config)) {
         return false;
     }
 
     // Set the new range
     accel_config = (accel_config & 0xE7) | (range << 3);
-    uint8_t data[2] = {ACCEL_CONFIG, accel_config};
-    if (!writeMessage(DEVICE_ADDRESS, data, 2)) {
+    if (!writeRegister(DEVICE_ADDRESS, ACCEL_CONFIG, accel_config)) {
         return false;
     }
 
     // Update local variables
     accel_range = range;
-    switch (accel_range) {
-        case 0: accel_sensitivity = 16384.0; break; // ±2g
-        case 1: accel_sensitivity = 8192.0;  break; // ±4g
-        case 2: accel_sensitivity = 4096.0;  break; // ±8g
-        case 3: accel_sensitivity = 2048.0;  break; // ±16g
-    }
+    updateScales();
 
     return true;
 }
@@ -182,27 +647,20 @@ bool MPU6050::setGyroRange(int range) { // 0=±250°/s,1=±500°/s,2=±1000°/s,
     }
 
     // Read the current GYRO_CONFIG value
-    setRegisterPointer(GYRO_CONFIG);
     uint8_t gyro_config;
-    if (!readMessage(DEVICE_ADDRESS, &gyro_config, 1)) {
+    if (!readRegister(DEVICE_ADDRESS, GYRO_CONFIG, gyro_config)) {
         return false;
     }
 
     // Set the new range
     gyro_config = (gyro_config & 0xE7) | (range << 3);
-    uint8_t data[2] = {GYRO_CONFIG, gyro_config};
-    if (!writeMessage(DEVICE_ADDRESS, data, 2)) {
+    if (!writeRegister(DEVICE_ADDRESS, GYRO_CONFIG, gyro_config)) {
         return false;
     }
 
     // Update local variables
     gyro_range = range;
-    switch (gyro_range) {
-        case 0: gyro_sensitivity = 131.0; break;  // ±250°/s
-        case 1: gyro_sensitivity = 65.5; break;   // ±500°/s
-        case 2: gyro_sensitivity = 32.8; break;   // ±1000°/s
-        case 3: gyro_sensitivity = 16.4; break;   // ±2000°/s
-    }
+    updateScales();
 
     return true;
 }
@@ -0,0 +1,301 @@
+#include <device_MPU6050Fusion.h>
+
+// Lookup tables sit in flash on AVR; other targets (the host tests) read
+// them as ordinary constants
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#define FUSION_TABLE PROGMEM
+static inline uint16_t tableWord(const uint16_t *entry) {
+    return pgm_read_word(entry);
+}
+#else
+#define FUSION_TABLE
+static inline uint16_t tableWord(const uint16_t *entry) {
+    return *entry;
+}
+#endif
+
+static inline int16_t tableWord(const int16_t *entry) {
+    return static_cast<int16_t>(tableWord(reinterpret_cast<const uint16_t *>(entry)));
+}
+
+// atan(i / 64) in centi-degrees, i = 0..64
+static const int16_t ATAN_TABLE[65] FUSION_TABLE = {
+    0, 90, 179, 268, 358, 447, 536, 624, 713, 800, 888, 975, 1062, 1148, 1234, 1319,
+    1404, 1488, 1571, 1653, 1735, 1817, 1897, 1977, 2056, 2134, 2211, 2287, 2363, 2438, 2511, 2584,
+    2657, 2728, 2798, 2867, 2936, 3003, 3070, 3136, 3201, 3264, 3327, 3390, 3451, 3511, 3571, 3629,
+    3687, 3744, 3800, 3855, 3909, 3963, 4016, 4067, 4119, 4169, 4218, 4267, 4315, 4363, 4409, 4455,
+    4500
+};
+
+// 1 / sqrt(x) in Q14 at the middle of each sixteenth of x in [0.25, 1)
+static const uint16_t INV_SQRT_SEED[12] FUSION_TABLE = {
+    30894, 27945, 25705, 23930, 22479, 21263, 20225, 19326, 18536, 17837, 17211, 16646
+};
+
+// Gyro half-angle per count per second, Q30: pi / 360 / (counts per °/s) * 2^30
+static const uint32_t GYRO_HALF_ANGLE[4] = {71528, 143056, 285676, 571352}; // ±250/500/1000/2000°/s
+
+// Extra fraction bits on the integral term, whose per-update step is tiny
+// (Ki = 0.1 at 200 Hz adds 1342 * error in Q30)
+static const uint8_t INTEGRAL_SHIFT = 8;
+
+// (a * b) >> 15 from two 16x16 products instead of a 32x32 one
+static inline int32_t mulQ15(int32_t a, int16_t b) {
+    int32_t high = static_cast<int32_t>(static_cast<int16_t>(a >> 16)) * b;
+    int32_t low = static_cast<int32_t>(static_cast<uint16_t>(a)) * b;
+    return (high << 1) + (low >> 15);
+}
+
+static inline int16_t saturate16(int32_t value) {
+    if (value > 32767) {
+        return 32767;
+    }
+    if (value < -32767) {
+        return -32767;
+    }
+    return static_cast<int16_t>(value);
+}
+
+// Shifts value left by 2 * k into [2^30, 2^32) and returns k (value != 0)
+static uint8_t normalizeEven(uint32_t &value) {
+    uint8_t k = 0;
+    while (value < 0x40000000UL) {
+        value <<= 2;
+        ++k;
+    }
+    return k;
+}
+
+// 1 / sqrt(x) in Q14 for x = x16 / 2^16 in [0.25, 1): table seed, then two
+// Newton steps y = y * (3 - x * y^2) / 2 (about 5% -> 0.5% -> 0.003%)
+static uint16_t invSqrtNormalized(uint16_t x16) {
+    uint16_t y = tableWord(&INV_SQRT_SEED[(x16 >> 12) - 4]);
+    for (uint8_t step = 0; step < 2; ++step) {
+        uint32_t y2 = (static_cast<uint32_t>(y) * y) >> 14;                        // Q14
+        uint16_t xy2 = static_cast<uint16_t>((static_cast<uint32_t>(x16) * y2) >> 16); // Q14, about 1.0
+        y = static_cast<uint16_t>((static_cast<uint32_t>(y) * (3U * 16384U - xy2)) >> 15);
+    }
+    return y;
+}
+
+uint16_t MPU6050Fusion::sqrt32(uint32_t value) {
+    if (value == 0) {
+        return 0;
+    }
+    uint8_t k = normalizeEven(value);
+    uint16_t x16 = static_cast<uint16_t>(value >> 16);
+    // sqrt(m) = m / sqrt(m) = x16 * 2^16 * y / 2^30, rounded
+    uint8_t shift = static_cast<uint8_t>(14 + k);
+    uint32_t root = static_cast<uint32_t>(x16) * invSqrtNormalized(x16);
+    root = (root + (1UL << (shift - 1))) >> shift;
+    return root > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(root);
+}
+
+int16_t MPU6050Fusion::atan2Centi(int16_t y, int16_t x) {
+    uint16_t ux = static_cast<uint16_t>(x < 0 ? -static_cast<int32_t>(x) : x);
+    uint16_t uy = static_cast<uint16_t>(y < 0 ? -static_cast<int32_t>(y) : y);
+    if (ux == 0 && uy == 0) {
+        return 0;
+    }
+
+    // Fold into the first octant: ratio = min / max in [0, 1]
+    bool steep = uy > ux;
+    uint16_t num = steep ? ux : uy;
+    uint16_t den = steep ? uy : ux;
+    if (den & 0x8000) {
+        den >>= 1;
+        num >>= 1;
+    }
+    while (den < 0x4000) { // keeps num << 1 below within 16 bits
+        den <<= 1;
+        num <<= 1;
+    }
+
+    // Q14 quotient by shift and subtract (no library divide)
+    uint16_t ratio = 0;
+    if (num >= den) {
+        ratio = 0x4000;
+    } else {
+        for (uint8_t bit = 0; bit < 14; ++bit) {
+            num <<= 1;
+            ratio <<= 1;
+            if (num >= den) {
+                num -= den;
+                ratio |= 1;
+            }
+        }
+    }
+
+    // Table entry plus linear interpolation on the low 8 bits
+    uint8_t index = static_cast<uint8_t>(ratio >> 8);
+    int16_t angle = tableWord(&ATAN_TABLE[index]);
+    if (index < 64) {
+        int16_t next = tableWord(&ATAN_TABLE[index + 1]);
+        angle = static_cast<int16_t>(angle + (((next - angle) * (ratio & 0xFF) + 128) >> 8));
+    }
+
+    if (steep) {
+        angle = static_cast<int16_t>(9000 - angle);
+    }
+    if (x < 0) {
+        angle = static_cast<int16_t>(18000 - angle);
+    }
+    return y < 0 ? static_cast<int16_t>(-angle) : angle;
+}
+
+bool MPU6050Fusion::begin(uint16_t sampleRateHz, uint8_t gyroRange) {
+    if (sampleRateHz == 0 || gyroRange > 3) {
+        return false;
+    }
+
+    // Largest shift that keeps the multiplier within 16 bits, so raw * it
+    // fits an int32
+    uint32_t perSecond = GYRO_HALF_ANGLE[gyroRange];
+    uint8_t shift = 0;
+    while (shift < 11 && ((perSecond << (shift + 1)) + sampleRateHz / 2) / sampleRateHz < 0x10000UL) {
+        ++shift;
+    }
+    uint32_t multiplier = ((perSecond << shift) + sampleRateHz / 2) / sampleRateHz;
+    if (multiplier > 0xFFFF) {
+        return false;
+    }
+
+    gyroMultiplier = static_cast<uint16_t>(multiplier);
+    gyroShift = shift;
+    sampleRate = sampleRateHz;
+    reset();
+    return setGains(kpMilli, kiMilli);
+}
+
+bool MPU6050Fusion::setGains(uint16_t kp, uint16_t ki) {
+    if (sampleRate == 0) {
+        return false;
+    }
+
+    // dt / 2 per thousandth of gain, Q30
+    uint32_t perMilli = ((1UL << 29) + 500UL * sampleRate) / (1000UL * sampleRate);
+    if ((kp != 0 && perMilli > 0x7FFFFFFFUL / kp) || (ki != 0 && perMilli > 0x7FFFFFFFUL / ki)) {
+        return false;
+    }
+
+    // Ki * dt * dt / 2 = (Ki * dt / 2) / rate, with INTEGRAL_SHIFT bits kept
+    uint32_t kiHalfDt = ki * perMilli;
+    uint32_t whole = kiHalfDt / sampleRate;
+    if (whole >= (1UL << (31 - INTEGRAL_SHIFT))) {
+        return false;
+    }
+    uint32_t fraction = ((kiHalfDt % sampleRate << INTEGRAL_SHIFT) + sampleRate / 2) / sampleRate;
+
+    kpStep = static_cast<int32_t>(kp * perMilli);
+    kiStep = static_cast<int32_t>((whole << INTEGRAL_SHIFT) + fraction);
+    kpMilli = kp;
+    kiMilli = ki;
+    return true;
+}
+
+void MPU6050Fusion::reset() {
+    q[0] = 1L << 30;
+    q[1] = 0;
+    q[2] = 0;
+    q[3] = 0;
+    integral[0] = 0;
+    integral[1] = 0;
+    integral[2] = 0;
+}
+
+void MPU6050Fusion::update(const MPU6050::RawSample &sample) {
+    const int16_t *gyro = &sample.gyro_x;
+    const int16_t *accel = &sample.accel_x;
+
+    // Rotation over this sample as a half-angle, Q30
+    int32_t h[3];
+    for (uint8_t axis = 0; axis < 3; ++axis) {
+        h[axis] = (static_cast<int32_t>(gyro[axis]) * gyroMultiplier) >> gyroShift;
+    }
+
+    int16_t qs[4];
+    quaternionQ15(qs);
+
+    uint32_t norm = 0;
+    for (uint8_t axis = 0; axis < 3; ++axis) {
+        norm += static_cast<uint32_t>(static_cast<int32_t>(accel[axis]) * accel[axis]);
+    }
+    if (norm != 0) {
+        // Measured gravity direction, Q15
+        uint8_t shift = static_cast<uint8_t>(15 - normalizeEven(norm));
+        uint16_t inverse = invSqrtNormalized(static_cast<uint16_t>(norm >> 16));
+        int16_t a[3];
+        for (uint8_t axis = 0; axis < 3; ++axis) {
+            a[axis] = saturate16((static_cast<int32_t>(accel[axis]) * inverse) >> shift);
+        }
+
+        // Gravity direction the estimate predicts (third row of its rotation matrix), Q15
+        int16_t vx = saturate16((static_cast<int32_t>(qs[1]) * qs[3] - static_cast<int32_t>(qs[0]) * qs[2]) >> 14);
+        int16_t vy = saturate16((static_cast<int32_t>(qs[0]) * qs[1] + static_cast<int32_t>(qs[2]) * qs[3]) >> 14);
+        int16_t vz = saturate16((static_cast<int32_t>(qs[0]) * qs[0] - static_cast<int32_t>(qs[1]) * qs[1] -
+                                 static_cast<int32_t>(qs[2]) * qs[2] + static_cast<int32_t>(qs[3]) * qs[3]) >> 15);
+
+        // Error = measured x predicted; rotating by it lines them up
+        int16_t e[3];
+        e[0] = static_cast<int16_t>((static_cast<int32_t>(a[1]) * vz - static_cast<int32_t>(a[2]) * vy) >> 15);
+        e[1] = static_cast<int16_t>((static_cast<int32_t>(a[2]) * vx - static_cast<int32_t>(a[0]) * vz) >> 15);
+        e[2] = static_cast<int16_t>((static_cast<int32_t>(a[0]) * vy - static_cast<int32_t>(a[1]) * vx) >> 15);
+
+        for (uint8_t axis = 0; axis < 3; ++axis) {
+            if (kiStep != 0) {
+                integral[axis] += mulQ15(kiStep, e[axis]);
+            }
+            h[axis] += mulQ15(kpStep, e[axis]) + (integral[axis] >> INTEGRAL_SHIFT);
+        }
+    }
+
+    // q += q * (0, h)
+    q[0] -= mulQ15(h[0], qs[1]) + mulQ15(h[1], qs[2]) + mulQ15(h[2], qs[3]);
+    q[1] += mulQ15(h[0], qs[0]) + mulQ15(h[2], qs[2]) - mulQ15(h[1], qs[3]);
+    q[2] += mulQ15(h[1], qs[0]) - mulQ15(h[2], qs[1]) + mulQ15(h[0], qs[3]);
+    q[3] += mulQ15(h[2], qs[0]) + mulQ15(h[1], qs[1]) - mulQ15(h[0], qs[2]);
+
+    // Back onto |q| = 1: 1 / sqrt(n) ~ (3 - n) / 2 while n stays near 1
+    quaternionQ15(qs);
+    int32_t length = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        length += static_cast<int32_t>(qs[i]) * qs[i];
+    }
+    int16_t correction = static_cast<int16_t>(((1L << 30) - length) >> 16); // (1 - n) / 2, Q15
+    for (uint8_t i = 0; i < 4; ++i) {
+        q[i] += mulQ15(q[i], correction);
+    }
+}
+
+void MPU6050Fusion::quaternionQ15(int16_t *out) const {
+    for (uint8_t i = 0; i < 4; ++i) {
+        out[i] = saturate16((q[i] + (1L << 14)) >> 15);
+    }
+}
+
+void MPU6050Fusion::getQuaternion(int16_t *quaternion) const {
+    quaternionQ15(quaternion);
+}
+
+void MPU6050Fusion::getEulerAngles(int16_t &roll, int16_t &pitch, int16_t &yaw) const {
+    int16_t qs[4];
+    quaternionQ15(qs);
+    int32_t w = qs[0];
+    int32_t x = qs[1];
+    int32_t y = qs[2];
+    int32_t z = qs[3];
+
+    // Rotation matrix entries, Q15
+    int16_t r11 = saturate16((w * w + x * x - y * y - z * z) >> 15);
+    int16_t r21 = saturate16((x * y + w * z) >> 14);
+    int16_t r31 = saturate16((x * z - w * y) >> 14);
+    int16_t r32 = saturate16((y * z + w * x) >> 14);
+    int16_t r33 = saturate16((w * w - x * x - y * y + z * z) >> 15);
+
+    roll = atan2Centi(r32, r33);
+    // cos(pitch) = |(r32, r33)|; unlike asin(-r31) this stays accurate near ±90°
+    uint16_t cosPitch = sqrt32(static_cast<uint32_t>(static_cast<int32_t>(r32) * r32 + static_cast<int32_t>(r33) * r33));
+    pitch = atan2Centi(static_cast<int16_t>(-r31), saturate16(cosPitch));
+    yaw = atan2Centi(r21, r11);
+}
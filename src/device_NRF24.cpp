@@ -1,5 +1,7 @@
 #include <device_NRF24.h>
+#include <avr/interrupt.h>
 #include <util/delay.h>
+#include <string.h>
 
 NRF24::NRF24(volatile uint8_t *mosi_pin_reg, volatile uint8_t *mosi_ddr, volatile uint8_t *mosi_port, uint8_t mosi_pin,
              volatile uint8_t *miso_pin_reg, volatile uint8_t *miso_ddr, volatile uint8_t *miso_port, uint8_t miso_pin,
@@ -23,7 +25,7 @@ bool NRF24::begin(bool enableAutoAck, uint8_t channel, uint8_t payloadSizeParam)
     setAutoChipSelect(false);
     setBitOrder(BitOrder::MSBFirst);
     setDataMode(0);
-    setClockHz(4000000);
+    setClock<SPIClock<SPI_CLOCK_HZ>>();
 
     if (CE_DDR) {
         (*CE_DDR) |= CE_MASK;
@@ -43,13 +45,12 @@ bool NRF24::begin(bool enableAutoAck, uint8_t channel, uint8_t payloadSizeParam)
     autoAckEnabled = enableAutoAck;
     autoAckMask = enableAutoAck ? 0x3F : 0x00;
 
-    uint8_t config = CONFIG_EN_CRC | CONFIG_CRCO;
-    writeRegister(REG_CONFIG, config);
+    syncRegisterCache();
+    writeRegister(REG_CONFIG, configBase());
 
     updateAutoAckMask();
     writeRegister(REG_EN_RXADDR, enabledRxPipes);
     writeRegister(REG_SETUP_AW, 0x03); // 5-byte address width
-    writeRegister(REG_SETUP_RETR, static_cast<uint8_t>((0x04 << 4) | 0x0F)); // 1250us, 15 retries
 
     setChannel(channel);
     setDataRate(DataRate::Rate1Mbps);
@@ -57,7 +58,10 @@ bool NRF24::begin(bool enableAutoAck, uint8_t channel, uint8_t payloadSizeParam)
     setPayloadSize(payloadSizeParam);
 
     dynamicPayloads = false;
+    ackPayloads = false;
     configureFeatureRegister();
+    adaptiveRetries = false;
+    setRetries(1250, 15);
 
     flushRx();
     flushTx();
@@ -69,6 +73,67 @@ bool NRF24::begin(bool enableAutoAck, uint8_t channel, uint8_t payloadSizeParam)
     return true;
 }
 
+bool NRF24::setSpiBackend(SPI::Backend backend) {
+    return setBackend(backend);
+}
+
+bool NRF24::enableIrq(bool attachInterrupt) {
+    if (!hasIrqPin) {
+        return false;
+    }
+    if (attachInterrupt && !ExtInt::lineForPin(IRQ_PIN_REG, IRQ_PIN, irqLine)) {
+        return false;
+    }
+
+    irqMode = true;
+    uint8_t config = shadowConfig;
+    config &= static_cast<uint8_t>(~(CONFIG_MASK_RX_DR | CONFIG_MASK_TX_DS | CONFIG_MASK_MAX_RT));
+    writeRegister(REG_CONFIG, static_cast<uint8_t>(config | (configBase() & 0x70)));
+
+    if (attachInterrupt) {
+        if (!ExtInt::attach(irqLine, ExtInt::Trigger::Falling, irqTrampoline, this)) {
+            disableIrq();
+            return false;
+        }
+        irqAttached = true;
+    }
+
+    // Packets already waiting in the radio never produce a new edge
+    handleIrq();
+    return true;
+}
+
+void NRF24::disableIrq() {
+    if (irqAttached) {
+        ExtInt::detach(irqLine);
+        irqAttached = false;
+    }
+    irqMode = false;
+    uint8_t config = shadowConfig;
+    writeRegister(REG_CONFIG, static_cast<uint8_t>(config & ~(CONFIG_MASK_TX_DS | CONFIG_MASK_MAX_RT)));
+}
+
+// statusCache is put back afterwards: main context may be between a
+// transaction and its read of the STATUS byte that transaction returned.
+void NRF24::handleIrq() {
+    // Without attach() nothing masks the line during main-context SPI. If
+    // the handler lands inside a transaction, unlockIrq() drains instead.
+    if (irqLockDepth != 0) {
+        rxBacklog = true;
+        return;
+    }
+
+    uint8_t status = statusCache;
+    lockIrq();
+    drainRxFifo();
+    unlockIrq();
+    statusCache = status;
+}
+
+void NRF24::irqTrampoline(void *context) {
+    static_cast<NRF24 *>(context)->handleIrq();
+}
+
 void NRF24::setAutoAck(bool enabled) {
     autoAckEnabled = enabled;
     autoAckMask = enabled ? 0x3F : 0x00;
@@ -76,11 +141,61 @@ void NRF24::setAutoAck(bool enabled) {
     configureFeatureRegister();
 }
 
+void NRF24::setDynamicPayloads(bool enabled) {
+    dynamicPayloads = enabled;
+    if (!enabled) {
+        ackPayloads = false;
+        setPayloadSize(payloadSize); // fixed widths back on every pipe
+    }
+    configureFeatureRegister();
+    applyRetries();
+}
+
+void NRF24::enableAckPayload(bool enabled) {
+    ackPayloads = enabled;
+    if (enabled) {
+        dynamicPayloads = true;
+    }
+    configureFeatureRegister();
+    applyRetries();
+}
+
+bool NRF24::writeAckPayload(uint8_t pipe, const void *data, uint8_t length) {
+    if (!ackPayloads || pipe > 5 || data == nullptr || length == 0 || length > MAX_PAYLOAD_SIZE) {
+        return false;
+    }
+
+    beginTransaction();
+    uint8_t status = SPI::transferByte(static_cast<uint8_t>(CMD_W_ACK_PAYLOAD | pipe));
+    statusCache = status;
+    if (status & STATUS_TX_FULL) {
+        endTransaction(); // nothing clocked in, the command is dropped
+        return false;
+    }
+    writeBytes(static_cast<const uint8_t *>(data), length);
+    endTransaction();
+    return true;
+}
+
+// No bus traffic if already on the channel. In RX the PLL has to relock, so
+// CE drops around the write; the radio settles again by itself (130 us).
 bool NRF24::setChannel(uint8_t channel) {
     if (channel > 125) {
         return false;
     }
-    return writeRegister(REG_RF_CH, channel);
+    if (channel == shadowRfCh) {
+        return true;
+    }
+
+    bool ceHigh = CE_PORT && ((*CE_PORT) & CE_MASK);
+    if (ceHigh) {
+        driveCe(false);
+    }
+    writeRegister(REG_RF_CH, channel);
+    if (ceHigh) {
+        driveCe(true);
+    }
+    return true;
 }
 
 bool NRF24::setPayloadSize(uint8_t size) {
@@ -99,7 +214,7 @@ bool NRF24::setPayloadSize(uint8_t size) {
 }
 
 bool NRF24::setDataRate(DataRate rate) {
-    uint8_t setup = readRegister(REG_RF_SETUP);
+    uint8_t setup = shadowRfSetup;
     setup &= static_cast<uint8_t>(~((1 << 5) | (1 << 3))); // clear RF_DR_LOW and RF_DR_HIGH
 
     switch (rate) {
@@ -116,11 +231,13 @@ bool NRF24::setDataRate(DataRate rate) {
             break;
     }
 
-    return writeRegister(REG_RF_SETUP, setup);
+    writeRegister(REG_RF_SETUP, setup);
+    applyRetries();
+    return true;
 }
 
 void NRF24::setPowerLevel(PowerLevel level) {
-    uint8_t setup = readRegister(REG_RF_SETUP);
+    uint8_t setup = shadowRfSetup;
     setup &= static_cast<uint8_t>(~(0x03 << 1));
 
     uint8_t value = 0;
@@ -144,8 +261,32 @@ void NRF24::setPowerLevel(PowerLevel level) {
     writeRegister(REG_RF_SETUP, setup);
 }
 
+bool NRF24::setRetries(uint16_t delayUs, uint8_t count) {
+    if (delayUs > 4000 || count > 15) {
+        return false;
+    }
+
+    retryDelayStep = delayUs > 250 ? static_cast<uint8_t>((delayUs - 1) / 250) : 0;
+    retryLimit = count;
+    adaptDelayStep = retryDelayStep;
+    adaptCount = retryLimit;
+    adaptSamples = 0;
+    adaptMaxArc = 0;
+    applyRetries();
+    return true;
+}
+
+void NRF24::setAdaptiveRetries(bool enabled) {
+    adaptiveRetries = enabled;
+    adaptDelayStep = retryDelayStep;
+    adaptCount = retryLimit;
+    adaptSamples = 0;
+    adaptMaxArc = 0;
+    applyRetries();
+}
+
 void NRF24::powerUp() {
-    uint8_t config = readRegister(REG_CONFIG);
+    uint8_t config = shadowConfig;
     if ((config & CONFIG_PWR_UP) == 0) {
         writeRegister(REG_CONFIG, static_cast<uint8_t>(config | CONFIG_PWR_UP));
         _delay_ms(2);
@@ -154,7 +295,7 @@ void NRF24::powerUp() {
 
 void NRF24::powerDown() {
     driveCe(false);
-    uint8_t config = readRegister(REG_CONFIG);
+    uint8_t config = shadowConfig;
     if (config & CONFIG_PWR_UP) {
         writeRegister(REG_CONFIG, static_cast<uint8_t>(config & ~CONFIG_PWR_UP));
         _delay_ms(2);
@@ -163,30 +304,41 @@ void NRF24::powerDown() {
 
 void NRF24::startListening() {
     powerUp();
-    uint8_t config = readRegister(REG_CONFIG);
-    config |= CONFIG_PRIM_RX;
-    writeRegister(REG_CONFIG, config);
+    writeRegister(REG_CONFIG, static_cast<uint8_t>(shadowConfig | CONFIG_PRIM_RX));
     clearInterrupts(true, true, true);
     flushRx();
     _delay_us(130);
     driveCe(true);
 }
 
+// Back to RX after a transmit made while listening. Unlike startListening()
+// the RX FIFO is kept: packets acknowledged before the switch (and an ACK
+// payload, on pipe 0) are still read normally.
+void NRF24::resumeListening() {
+    writeRegister(REG_CONFIG, static_cast<uint8_t>(shadowConfig | CONFIG_PRIM_RX));
+    _delay_us(130);
+    driveCe(true);
+}
+
 void NRF24::stopListening() {
     driveCe(false);
-    uint8_t config = readRegister(REG_CONFIG);
-    config &= static_cast<uint8_t>(~CONFIG_PRIM_RX);
-    writeRegister(REG_CONFIG, config);
+    writeRegister(REG_CONFIG, static_cast<uint8_t>(shadowConfig & ~CONFIG_PRIM_RX));
     _delay_us(130);
 }
 
 bool NRF24::available() {
-    uint8_t status = getStatus();
-    if (status & STATUS_RX_DR) {
+    if (rxBacklog) {
+        handleIrq();
+    }
+    if (rxHead != rxTail) {
         return true;
     }
-    uint8_t fifo = readRegister(REG_FIFO_STATUS);
-    return (fifo & FIFO_STATUS_RX_EMPTY) == 0;
+    if (irqMode) {
+        return false;
+    }
+
+    // RX_P_NO reads 7 while the RX FIFO is empty
+    return ((getStatus() >> 1) & 0x07) != 0x07;
 }
 
 bool NRF24::read(void *buffer, uint8_t length) {
@@ -194,13 +346,77 @@ bool NRF24::read(void *buffer, uint8_t length) {
         return false;
     }
 
-    if (!available()) {
+    uint8_t size;
+    uint8_t pipe;
+    if (!beginPayloadRead(size, pipe)) {
+        return false;
+    }
+    readPayloadBytes(buffer, size < length ? size : length);
+    endPayloadRead();
+    return !dynamicPayloads || size <= length;
+}
+
+bool NRF24::readPacket(Packet &packet) {
+    if (!beginPayloadRead(packet.length, packet.pipe)) {
+        return false;
+    }
+    readPayloadBytes(packet.data, packet.length);
+    endPayloadRead();
+    return true;
+}
+
+bool NRF24::readPayload(SPI::ByteHandler handler, void *context) {
+    uint8_t length;
+    uint8_t pipe;
+    if (handler == nullptr || !beginPayloadRead(length, pipe)) {
+        return false;
+    }
+
+    if (payloadStream == PayloadStream::ReadQueue) {
+        const Packet &packet = rxQueue[rxTail % RX_QUEUE_DEPTH];
+        for (uint8_t i = 0; i < length; ++i) {
+            handler(i, packet.data[i], context);
+        }
+    } else {
+        readBytes(handler, context, length);
+    }
+    streamRemaining = 0;
+    endPayloadRead();
+    return true;
+}
+
+// Serves the IRQ queue first. Polled, the STATUS byte clocked out with the
+// command tells whether the FIFO holds anything, so no separate available()
+// round trip is needed; the transaction then stays open for the payload.
+bool NRF24::beginPayloadRead(uint8_t &length, uint8_t &pipe) {
+    if (payloadStream != PayloadStream::None) {
+        return false;
+    }
+
+    if (rxBacklog) {
+        handleIrq();
+    }
+
+    if (rxHead != rxTail) {
+        const Packet &packet = rxQueue[rxTail % RX_QUEUE_DEPTH];
+        length = packet.length;
+        pipe = packet.pipe;
+        streamRemaining = packet.length;
+        streamOffset = 0;
+        payloadStream = PayloadStream::ReadQueue;
+        return true;
+    }
+
+    if (irqMode) {
         return false;
     }
 
     uint8_t expectedLength = payloadSize;
     if (dynamicPayloads) {
         expectedLength = readPayloadWidth();
+        if (((statusCache >> 1) & 0x07) == 0x07) {
+            return false;
+        }
         if (expectedLength > MAX_PAYLOAD_SIZE) {
             flushRx();
             clearInterrupts(false, true, false);
@@ -212,29 +428,72 @@ bool NRF24::read(void *buffer, uint8_t length) {
         expectedLength = payloadSize;
     }
 
-    select();
-    SPI::transferByte(CMD_R_RX_PAYLOAD);
-    uint8_t *byteBuffer = static_cast<uint8_t *>(buffer);
-    for (uint8_t i = 0; i < expectedLength; ++i) {
-        uint8_t value = SPI::transferByte(0xFF);
-        if (i < length) {
-            byteBuffer[i] = value;
-        }
+    beginTransaction();
+    uint8_t status = SPI::transferByte(CMD_R_RX_PAYLOAD);
+    statusCache = status;
+    if (((status >> 1) & 0x07) == 0x07) {
+        endTransaction();
+        return false;
     }
-    deselect();
 
-    clearInterrupts(false, true, false);
+    length = expectedLength;
+    pipe = static_cast<uint8_t>((status >> 1) & 0x07);
+    streamRemaining = expectedLength;
+    payloadStream = PayloadStream::ReadRadio;
+    return true;
+}
 
-    if (dynamicPayloads && expectedLength > length) {
-        flushRx();
+bool NRF24::readPayloadBytes(void *data, uint8_t length) {
+    if (length > streamRemaining) {
         return false;
     }
 
+    if (payloadStream == PayloadStream::ReadQueue) {
+        if (data != nullptr) {
+            memcpy(data, &rxQueue[rxTail % RX_QUEUE_DEPTH].data[streamOffset], length);
+        }
+        streamOffset = static_cast<uint8_t>(streamOffset + length);
+    } else if (payloadStream == PayloadStream::ReadRadio) {
+        readBytes(static_cast<uint8_t *>(data), length);
+    } else {
+        return false;
+    }
+    streamRemaining = static_cast<uint8_t>(streamRemaining - length);
     return true;
 }
 
+// Unread bytes are clocked out and dropped; the radio only frees the FIFO
+// slot once the whole payload has been read
+void NRF24::endPayloadRead() {
+    if (payloadStream == PayloadStream::ReadQueue) {
+        rxTail = static_cast<uint8_t>(rxTail + 1);
+    } else if (payloadStream == PayloadStream::ReadRadio) {
+        if (streamRemaining) {
+            readBytes(static_cast<uint8_t *>(nullptr), streamRemaining);
+        }
+        endTransaction();
+
+        uint8_t status = statusCache;
+        if (status & STATUS_RX_DR) {
+            clearInterrupts(false, true, false);
+        }
+        statsRx(static_cast<uint8_t>((status >> 1) & 0x07));
+        statsRpd();
+    }
+    streamRemaining = 0;
+    payloadStream = PayloadStream::None;
+}
+
 bool NRF24::write(const void *buffer, uint8_t length, bool requestAck) {
-    if (buffer == nullptr || length == 0 || length > MAX_PAYLOAD_SIZE) {
+    if (buffer == nullptr || !beginPayloadWrite(length, requestAck)) {
+        return false;
+    }
+    writePayloadBytes(buffer, length);
+    return endPayloadWrite();
+}
+
+bool NRF24::beginPayloadWrite(uint8_t length, bool requestAck) {
+    if (payloadStream != PayloadStream::None || length == 0 || length > MAX_PAYLOAD_SIZE) {
         return false;
     }
 
@@ -242,29 +501,52 @@ bool NRF24::write(const void *buffer, uint8_t length, bool requestAck) {
         return false;
     }
 
-    uint8_t configBefore = readRegister(REG_CONFIG);
-    bool wasListening = (configBefore & CONFIG_PRIM_RX) != 0;
-    if (wasListening) {
+    ackPayloadReceived = false;
+    streamQueuedBefore = rxHead;
+
+    streamWasListening = (shadowConfig & CONFIG_PRIM_RX) != 0;
+    if (streamWasListening) {
         stopListening();
     } else {
         driveCe(false);
     }
 
     clearInterrupts(true, true, true);
-
-    uint8_t fifo = readRegister(REG_FIFO_STATUS);
-    if (fifo & FIFO_STATUS_TX_FULL) {
+    if (statusCache & STATUS_TX_FULL) {
         flushTx();
     }
+    applyRetries();
 
-    select();
-    SPI::transferByte(requestAck ? CMD_W_TX_PAYLOAD : CMD_W_TX_PAYLOAD_NOACK);
-    const uint8_t *dataBytes = static_cast<const uint8_t *>(buffer);
-    for (uint8_t i = 0; i < length; ++i) {
-        SPI::transferByte(dataBytes[i]);
+    beginTransaction();
+    statusCache = SPI::transferByte(requestAck ? CMD_W_TX_PAYLOAD : CMD_W_TX_PAYLOAD_NOACK);
+    streamRemaining = length;
+    payloadStream = PayloadStream::Write;
+    return true;
+}
+
+bool NRF24::writePayloadBytes(const void *data, uint8_t length) {
+    if (payloadStream != PayloadStream::Write || data == nullptr || length > streamRemaining) {
+        return false;
     }
-    deselect();
+    writeBytes(static_cast<const uint8_t *>(data), length);
+    streamRemaining = static_cast<uint8_t>(streamRemaining - length);
+    return true;
+}
 
+// Bytes not written by now go out as 0xFF so the packet has the length given
+// to beginPayloadWrite()
+bool NRF24::endPayloadWrite() {
+    if (payloadStream != PayloadStream::Write) {
+        return false;
+    }
+    if (streamRemaining) {
+        readBytes(static_cast<uint8_t *>(nullptr), streamRemaining);
+        streamRemaining = 0;
+    }
+    endTransaction();
+    payloadStream = PayloadStream::None;
+
+    bool wasListening = streamWasListening;
     pulseCeHigh(CE_PULSE_US);
 
     uint16_t waitLoops = 2000;
@@ -272,8 +554,13 @@ bool NRF24::write(const void *buffer, uint8_t length, bool requestAck) {
         uint8_t status = getStatus();
         if (status & STATUS_TX_DS) {
             clearInterrupts(true, false, false);
+            statsTxDelivered();
+            observeTx(true);
+            // RX_DR alongside TX_DS: the ACK carried a payload (in IRQ mode
+            // the handler may already have moved it to the queue)
+            ackPayloadReceived = ackPayloads && ((status & STATUS_RX_DR) || rxHead != streamQueuedBefore);
             if (wasListening) {
-                startListening();
+                resumeListening();
             } else {
                 driveCe(false);
             }
@@ -282,8 +569,9 @@ bool NRF24::write(const void *buffer, uint8_t length, bool requestAck) {
         if (status & STATUS_MAX_RT) {
             clearInterrupts(false, false, true);
             flushTx();
+            observeTx(false);
             if (wasListening) {
-                startListening();
+                resumeListening();
             } else {
                 driveCe(false);
             }
@@ -294,13 +582,230 @@ bool NRF24::write(const void *buffer, uint8_t length, bool requestAck) {
 
     flushTx();
     if (wasListening) {
-        startListening();
+        resumeListening();
     } else {
         driveCe(false);
     }
     return false;
 }
 
+void NRF24::onTxComplete(TxCallback callback, void *context) {
+    txCallback = callback;
+    txCallbackContext = context;
+}
+
+bool NRF24::writeFast(const void *buffer, uint8_t length, bool requestAck) {
+    if (buffer == nullptr || length == 0 || length > MAX_PAYLOAD_SIZE) {
+        return false;
+    }
+
+    if (!dynamicPayloads && length != payloadSize) {
+        return false;
+    }
+
+    if (!txStreaming) {
+        txResumeListening = (shadowConfig & CONFIG_PRIM_RX) != 0;
+        if (txResumeListening) {
+            stopListening();
+        }
+        clearInterrupts(true, false, true);
+        txQueued = 0;
+        txStreaming = true;
+    }
+
+    if (txQueued == 0) {
+        applyRetries(); // FIFO empty: standby-II
+    }
+
+    uint16_t waitLoops = TX_FULL_WAIT_LOOPS;
+    while (pollTx() & STATUS_TX_FULL) {
+        if (--waitLoops == 0) {
+            return false;
+        }
+        _delay_us(50);
+    }
+
+    beginTransaction();
+    statusCache = SPI::transferByte(requestAck ? CMD_W_TX_PAYLOAD : CMD_W_TX_PAYLOAD_NOACK);
+    writeBytes(static_cast<const uint8_t *>(buffer), length);
+    endTransaction();
+    ++txQueued;
+
+    driveCe(true);
+    return true;
+}
+
+void NRF24::serviceTx() {
+    if (txStreaming) {
+        pollTx();
+    }
+}
+
+bool NRF24::txStandby(uint16_t timeoutMs) {
+    if (!txStreaming) {
+        return true;
+    }
+
+    uint32_t waitLoops = static_cast<uint32_t>(timeoutMs) * 20U; // 50 us steps
+    pollTx();
+    while (txQueued != 0) {
+        if (waitLoops-- == 0) {
+            flushTx();
+            failInFlight();
+            break;
+        }
+        _delay_us(50);
+        pollTx();
+    }
+
+    driveCe(false);
+    txStreaming = false;
+    applyRetries();
+    if (txResumeListening) {
+        resumeListening();
+    }
+
+    bool ok = !txFailed;
+    txFailed = false;
+    return ok;
+}
+
+// One STATUS read per call; FIFO_STATUS only when TX_DS or MAX_RT says
+// something left. Returns the STATUS byte (TX_FULL reflects the state after
+// any flush).
+uint8_t NRF24::pollTx() {
+    uint8_t status = getStatus();
+    bool failed = (status & STATUS_MAX_RT) != 0;
+
+    // Payloads acknowledged ahead of a MAX_RT are delivered: count them off
+    // the FIFO state before failing the rest
+    uint8_t remaining = (status & STATUS_TX_FULL) ? TX_FIFO_DEPTH : static_cast<uint8_t>(TX_FIFO_DEPTH - 1);
+    if (status & (STATUS_TX_DS | STATUS_MAX_RT)) {
+        if (status & STATUS_TX_DS) {
+            clearInterrupts(true, false, false);
+        }
+        uint8_t fifo = readRegister(REG_FIFO_STATUS);
+        if (fifo & FIFO_STATUS_TX_EMPTY) {
+            remaining = 0;
+        } else if (failed && !(fifo & FIFO_STATUS_TX_FULL) && txQueued > 1) {
+            // One or two left. The radio sends nothing while MAX_RT is set,
+            // so a filler payload tells which; the flush below drops it.
+            beginTransaction();
+            SPI::transferByte(CMD_W_TX_PAYLOAD);
+            SPI::transferByte(0);
+            endTransaction();
+            remaining = (getStatus() & STATUS_TX_FULL) ? static_cast<uint8_t>(TX_FIFO_DEPTH - 1) : 1;
+        }
+        if (!failed) {
+            // ARC_CNT of the latest payload only: retry stats and the
+            // adaptive window see one sample per completion batch
+            observeTx(true);
+        }
+    }
+
+    while (txQueued > remaining) {
+        --txQueued;
+        statsTxDelivered();
+        if (txCallback) {
+            txCallback(true, txCallbackContext);
+        }
+    }
+
+    if (failed) {
+        // The radio halts on the failing payload; there is no way to drop just
+        // that one, so whatever is still queued goes
+        flushTx();
+        clearInterrupts(true, false, true);
+        observeTx(false);
+        failInFlight();
+        return static_cast<uint8_t>(status & ~STATUS_TX_FULL);
+    }
+    return status;
+}
+
+// OBSERVE_TX is only read when the statistics or the adaptive mode use it;
+// a MAX_RT always means the full ARC was spent
+void NRF24::observeTx(bool delivered) {
+    uint8_t arc = static_cast<uint8_t>(shadowSetupRetr & 0x0F);
+    if (delivered) {
+        if (!STATS_ENABLED && !adaptiveRetries) {
+            return;
+        }
+        arc = static_cast<uint8_t>(readRegister(REG_OBSERVE_TX) & OBSERVE_TX_ARC_CNT);
+    }
+    statsTxRetries(arc, !delivered);
+    if (adaptiveRetries) {
+        adaptRetries(arc, delivered);
+    }
+}
+
+// Only updates the targets; applyRetries() writes them once the radio is in
+// standby
+void NRF24::adaptRetries(uint8_t arc, bool delivered) {
+    if (!delivered) {
+        adaptDelayStep = adaptDelayStep < 7 ? static_cast<uint8_t>(adaptDelayStep * 2 + 1) : 15;
+        adaptCount = retryLimit;
+        adaptSamples = 0;
+        adaptMaxArc = 0;
+        return;
+    }
+
+    if (arc > adaptMaxArc) {
+        adaptMaxArc = arc;
+    }
+    if (++adaptSamples < RETRY_WINDOW) {
+        return;
+    }
+
+    // A shorter delay needs roughly twice the retries for the same span
+    if (adaptDelayStep > minRetryDelayStep() && adaptMaxArc * 2 < retryLimit) {
+        --adaptDelayStep;
+    }
+    uint8_t count = static_cast<uint8_t>(adaptMaxArc * 2 + 2);
+    if (count < RETRY_MIN_COUNT) {
+        count = RETRY_MIN_COUNT;
+    }
+    adaptCount = count < retryLimit ? count : retryLimit;
+    adaptSamples = 0;
+    if (adaptMaxArc > 0) {
+        --adaptMaxArc; // peak hold: periodic bursts keep the count up
+    }
+}
+
+void NRF24::applyRetries() {
+    uint8_t step = adaptiveRetries ? adaptDelayStep : retryDelayStep;
+    uint8_t count = adaptiveRetries ? adaptCount : retryLimit;
+    uint8_t minStep = minRetryDelayStep();
+    if (step < minStep) {
+        step = minStep;
+    }
+
+    uint8_t value = static_cast<uint8_t>((step << 4) | count);
+    if (shadowSetupRetr != value) {
+        writeRegister(REG_SETUP_RETR, value);
+    }
+}
+
+// Datasheet ARD minimums: 500 us at 250 kbps, 500 us for ACK payloads at
+// 1/2 Mbps; a 32-byte ACK payload at 250 kbps needs about 1500 us
+uint8_t NRF24::minRetryDelayStep() const {
+    bool slow = (shadowRfSetup & (1 << 5)) != 0;
+    if (ackPayloads) {
+        return slow ? 5 : 1;
+    }
+    return slow ? 1 : 0;
+}
+
+void NRF24::failInFlight() {
+    txFailed = txFailed || txQueued != 0;
+    while (txQueued != 0) {
+        --txQueued;
+        if (txCallback) {
+            txCallback(false, txCallbackContext);
+        }
+    }
+}
+
 void NRF24::openWritingPipe(const uint8_t *address, uint8_t length) {
     if (address == nullptr) {
         return;
@@ -325,7 +830,7 @@ void NRF24::openReadingPipe(uint8_t pipe, const uint8_t *address, uint8_t length
         return;
     }
 
-    uint8_t addressWidth = static_cast<uint8_t>((readRegister(REG_SETUP_AW) & 0x03) + 2);
+    uint8_t addressWidth = static_cast<uint8_t>((shadowSetupAw & 0x03) + 2);
     if (addressWidth < 3) {
         addressWidth = 3;
     }
@@ -371,6 +876,43 @@ uint8_t NRF24::getStatus() {
     return writeCommand(CMD_NOP);
 }
 
+void NRF24::syncRegisterCache() {
+    shadowConfig = readRegister(REG_CONFIG);
+    shadowEnAa = readRegister(REG_EN_AA);
+    shadowEnRxaddr = readRegister(REG_EN_RXADDR);
+    shadowSetupAw = readRegister(REG_SETUP_AW);
+    shadowSetupRetr = readRegister(REG_SETUP_RETR);
+    shadowRfCh = readRegister(REG_RF_CH);
+    shadowRfSetup = readRegister(REG_RF_SETUP);
+    shadowDynpd = readRegister(REG_DYNPD);
+    shadowFeature = readRegister(REG_FEATURE);
+}
+
+uint8_t *NRF24::shadowFor(uint8_t reg) {
+    switch (reg) {
+        case REG_CONFIG:
+            return &shadowConfig;
+        case REG_EN_AA:
+            return &shadowEnAa;
+        case REG_EN_RXADDR:
+            return &shadowEnRxaddr;
+        case REG_SETUP_AW:
+            return &shadowSetupAw;
+        case REG_SETUP_RETR:
+            return &shadowSetupRetr;
+        case REG_RF_CH:
+            return &shadowRfCh;
+        case REG_RF_SETUP:
+            return &shadowRfSetup;
+        case REG_DYNPD:
+            return &shadowDynpd;
+        case REG_FEATURE:
+            return &shadowFeature;
+        default:
+            return nullptr;
+    }
+}
+
 void NRF24::clearInterrupts(bool tx, bool rx, bool maxRetry) {
     uint8_t mask = 0;
     if (rx) {
@@ -395,21 +937,134 @@ void NRF24::flushRx() {
     writeCommand(CMD_FLUSH_RX);
 }
 
+bool NRF24::testRpd() {
+    return (readRegister(REG_RPD) & RPD_RPD) != 0;
+}
+
+// RPD is latched when CE drops, so it is read after the RX period ends
+bool NRF24::scanChannels(uint8_t *histogram, uint8_t samples) {
+    if (histogram == nullptr || samples == 0 || txStreaming) {
+        return false;
+    }
+
+    uint8_t config = shadowConfig;
+    bool wasListening = (config & (CONFIG_PRIM_RX | CONFIG_PWR_UP)) == (CONFIG_PRIM_RX | CONFIG_PWR_UP);
+    uint8_t channel = shadowRfCh;
+
+    driveCe(false);
+    powerUp();
+    if (!(config & CONFIG_PRIM_RX)) {
+        writeRegister(REG_CONFIG, static_cast<uint8_t>(shadowConfig | CONFIG_PRIM_RX));
+    }
+
+    for (uint8_t ch = 0; ch < CHANNEL_COUNT; ++ch) {
+        histogram[ch] = 0;
+    }
+
+    // Passes outermost: spreading each channel's samples over the whole scan
+    // catches bursty Wi-Fi better than back-to-back samples
+    for (uint8_t pass = 0; pass < samples; ++pass) {
+        for (uint8_t ch = 0; ch < CHANNEL_COUNT; ++ch) {
+            writeRegister(REG_RF_CH, ch);
+            driveCe(true);
+            _delay_us(RPD_SETTLE_US);
+            driveCe(false);
+            if (testRpd()) {
+                ++histogram[ch];
+            }
+        }
+    }
+
+    // CONFIG as found puts back PRIM_RX and power-down alike. The RX FIFO is
+    // not flushed: packets that landed before or during the scan stay readable.
+    writeRegister(REG_RF_CH, channel);
+    if (shadowConfig != config) {
+        writeRegister(REG_CONFIG, config);
+    }
+    if (wasListening) {
+        _delay_us(130);
+        driveCe(true);
+    }
+    return true;
+}
+
+uint8_t NRF24::quietestChannel(const uint8_t *histogram, uint8_t first, uint8_t last) {
+    if (histogram == nullptr) {
+        return first;
+    }
+    if (last >= CHANNEL_COUNT) {
+        last = CHANNEL_COUNT - 1;
+    }
+
+    uint8_t best = first;
+    uint16_t bestScore = 0xFFFF;
+    for (uint8_t ch = first; ch <= last; ++ch) {
+        uint16_t score = static_cast<uint16_t>(histogram[ch]) * 2;
+        if (ch > 0) {
+            score = static_cast<uint16_t>(score + histogram[ch - 1]);
+        }
+        if (ch + 1 < CHANNEL_COUNT) {
+            score = static_cast<uint16_t>(score + histogram[ch + 1]);
+        }
+        if (score < bestScore) {
+            bestScore = score;
+            best = ch;
+        }
+    }
+    return best;
+}
+
+#if NRF24_ENABLE_STATS
+void NRF24::readStats(Stats &out) const {
+    uint8_t sreg = SREG; // the IRQ drain updates the RX counters
+    cli();
+    out = stats;
+    SREG = sreg;
+}
+
+void NRF24::resetStats() {
+    uint8_t sreg = SREG;
+    cli();
+    stats = Stats();
+    SREG = sreg;
+}
+
+void NRF24::statsRpd() {
+    ++stats.rpdSamples;
+    if (testRpd()) {
+        ++stats.rpdHits;
+    }
+}
+#else
+void NRF24::readStats(Stats &out) const {
+    out = Stats();
+}
+
+void NRF24::resetStats() {
+}
+#endif
+
 uint8_t NRF24::writeCommand(uint8_t command, const uint8_t *data, uint8_t length) {
-    select();
+    beginTransaction();
     uint8_t status = SPI::transferByte(command);
     for (uint8_t i = 0; i < length; ++i) {
         SPI::transferByte(data ? data[i] : 0xFF);
     }
-    deselect();
+    endTransaction();
+    statusCache = status;
     return status;
 }
 
 bool NRF24::writeRegister(uint8_t reg, uint8_t value) {
-    select();
-    SPI::transferByte(static_cast<uint8_t>(CMD_W_REGISTER | (reg & 0x1F)));
+    beginTransaction();
+    statusCache = SPI::transferByte(static_cast<uint8_t>(CMD_W_REGISTER | (reg & 0x1F)));
     SPI::transferByte(value);
-    deselect();
+    endTransaction();
+
+    uint8_t *shadow = shadowFor(reg);
+    if (shadow) {
+        *shadow = value;
+    }
     return true;
 }
 
@@ -417,20 +1072,18 @@ bool NRF24::writeRegister(uint8_t reg, const uint8_t *data, uint8_t length) {
     if (data == nullptr || length == 0) {
         return false;
     }
-    select();
-    SPI::transferByte(static_cast<uint8_t>(CMD_W_REGISTER | (reg & 0x1F)));
-    for (uint8_t i = 0; i < length; ++i) {
-        SPI::transferByte(data[i]);
-    }
-    deselect();
+    beginTransaction();
+    statusCache = SPI::transferByte(static_cast<uint8_t>(CMD_W_REGISTER | (reg & 0x1F)));
+    writeBytes(data, length);
+    endTransaction();
     return true;
 }
 
 uint8_t NRF24::readRegister(uint8_t reg) {
-    select();
-    SPI::transferByte(static_cast<uint8_t>(CMD_R_REGISTER | (reg & 0x1F)));
+    beginTransaction();
+    statusCache = SPI::transferByte(static_cast<uint8_t>(CMD_R_REGISTER | (reg & 0x1F)));
     uint8_t value = SPI::transferByte(0xFF);
-    deselect();
+    endTransaction();
     return value;
 }
 
@@ -438,12 +1091,106 @@ void NRF24::readRegister(uint8_t reg, uint8_t *data, uint8_t length) {
     if (data == nullptr || length == 0) {
         return;
     }
+    beginTransaction();
+    statusCache = SPI::transferByte(static_cast<uint8_t>(CMD_R_REGISTER | (reg & 0x1F)));
+    readBytes(data, length);
+    endTransaction();
+}
+
+void NRF24::beginTransaction() {
+    lockIrq();
     select();
-    SPI::transferByte(static_cast<uint8_t>(CMD_R_REGISTER | (reg & 0x1F)));
-    for (uint8_t i = 0; i < length; ++i) {
-        data[i] = SPI::transferByte(0xFF);
-    }
+}
+
+void NRF24::endTransaction() {
     deselect();
+    unlockIrq();
+}
+
+// Main-context SPI masks the IRQ line so the handler never interleaves with a
+// transaction; an edge seen meanwhile stays latched and runs on unlock.
+// With an external handler there is no mask: handleIrq() sees the depth,
+// flags rxBacklog and the drain runs here once the depth is back at 0 (if
+// the queue has room; otherwise read() drains when it frees a slot).
+void NRF24::lockIrq() {
+    if (irqAttached) {
+        ExtInt::disable(irqLine);
+    }
+    ++irqLockDepth;
+}
+
+void NRF24::unlockIrq() {
+    if (--irqLockDepth != 0) {
+        return;
+    }
+    if (irqAttached) {
+        ExtInt::enable(irqLine);
+    } else if (rxBacklog && static_cast<uint8_t>(rxHead - rxTail) < RX_QUEUE_DEPTH) {
+        handleIrq();
+    }
+}
+
+// Clear RX_DR first, then read until RX_P_NO reports empty. A packet landing
+// after the clear sets RX_DR again, so loop until it stays clear; otherwise the
+// IRQ line would stay low with no further falling edge.
+void NRF24::drainRxFifo() {
+    rxBacklog = false;
+    uint8_t status;
+    uint8_t drained = 0;
+    do {
+        const uint8_t clearRx = STATUS_RX_DR;
+        status = writeCommand(static_cast<uint8_t>(CMD_W_REGISTER | REG_STATUS), &clearRx, 1);
+        // Three payloads drained in one pass may have arrived one at a time;
+        // only RX_FULL says the radio had to turn packets away
+        if (STATS_ENABLED && (readRegister(REG_FIFO_STATUS) & FIFO_STATUS_RX_FULL)) {
+            statsRxFifoFull();
+        }
+
+        uint8_t pass = 0;
+        while (((status >> 1) & 0x07) < 6) {
+            if (static_cast<uint8_t>(rxHead - rxTail) >= RX_QUEUE_DEPTH) {
+                rxBacklog = true; // left in the radio until read() frees a slot
+                statsRxQueueFull();
+                break;
+            }
+
+            uint8_t length = payloadSize;
+            if (dynamicPayloads) {
+                length = readPayloadWidth();
+                if (length == 0 || length > MAX_PAYLOAD_SIZE) {
+                    flushRx();
+                    status = getStatus();
+                    break;
+                }
+            }
+
+            Packet &packet = rxQueue[rxHead % RX_QUEUE_DEPTH];
+            packet.pipe = static_cast<uint8_t>((status >> 1) & 0x07);
+            packet.length = length;
+            beginTransaction();
+            SPI::transferByte(CMD_R_RX_PAYLOAD);
+            readBytes(packet.data, length);
+            endTransaction();
+            rxHead = static_cast<uint8_t>(rxHead + 1);
+            statsRx(packet.pipe);
+            ++pass;
+
+            status = getStatus();
+        }
+        drained = static_cast<uint8_t>(drained + pass);
+    } while (!rxBacklog && (status & STATUS_RX_DR));
+
+    if (drained) {
+        statsRpd(); // latched for the latest packet
+    }
+}
+
+uint8_t NRF24::configBase() const {
+    uint8_t config = CONFIG_EN_CRC | CONFIG_CRCO;
+    if (irqMode) {
+        config |= CONFIG_MASK_TX_DS | CONFIG_MASK_MAX_RT;
+    }
+    return config;
 }
 
 void NRF24::driveCe(bool high) {
@@ -467,35 +1214,40 @@ void NRF24::pulseCeHigh(uint16_t microseconds) {
 }
 
 uint8_t NRF24::readPayloadWidth() {
-    select();
-    SPI::transferByte(CMD_R_RX_PL_WID);
+    beginTransaction();
+    statusCache = SPI::transferByte(CMD_R_RX_PL_WID);
     uint8_t width = SPI::transferByte(0xFF);
-    deselect();
+    endTransaction();
     return width;
 }
 
 void NRF24::configureFeatureRegister() {
     uint8_t desired = 0;
     if (dynamicPayloads) {
-        desired |= static_cast<uint8_t>((1 << 2) | (1 << 1));
-        if (!autoAckEnabled) {
-            desired |= 1 << 0;
-        }
-    } else {
-        if (!autoAckEnabled) {
-            desired |= 1 << 0;
-        }
+        desired |= FEATURE_EN_DPL;
+    }
+    if (ackPayloads) {
+        desired |= FEATURE_EN_ACK_PAY;
+    }
+    if (!autoAckEnabled) {
+        desired |= FEATURE_EN_DYN_ACK;
     }
 
-    writeRegister(REG_FEATURE, desired);
-    if (readRegister(REG_FEATURE) != desired) {
-        uint8_t activateData = 0x73;
-        writeCommand(CMD_ACTIVATE, &activateData, 1);
+    // Read back only on change: FEATURE ignores writes until ACTIVATE on
+    // nRF24L01 (non-plus) parts
+    if (shadowFeature != desired) {
         writeRegister(REG_FEATURE, desired);
+        if (readRegister(REG_FEATURE) != desired) {
+            uint8_t activateData = 0x73;
+            writeCommand(CMD_ACTIVATE, &activateData, 1);
+            writeRegister(REG_FEATURE, desired);
+        }
     }
 
     uint8_t dynpd = dynamicPayloads ? static_cast<uint8_t>(enabledRxPipes & 0x3F) : 0x00;
-    writeRegister(REG_DYNPD, dynpd);
+    if (shadowDynpd != dynpd) {
+        writeRegister(REG_DYNPD, dynpd);
+    }
 }
 
 void NRF24::updateAutoAckMask() {
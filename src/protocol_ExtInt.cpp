@@ -0,0 +1,85 @@
+#include <protocol_ExtInt.h>
+
+ExtInt::Handler ExtInt::handlers[2] = {nullptr, nullptr};
+void *ExtInt::contexts[2] = {nullptr, nullptr};
+
+static inline uint8_t lineBit(ExtInt::Line line) {
+    return static_cast<uint8_t>(1U << static_cast<uint8_t>(line));
+}
+
+bool ExtInt::lineForPin(volatile uint8_t *pinReg, uint8_t pin, Line &line) {
+    if (pinReg != &PIND) {
+        return false;
+    }
+    if (pin == PD2) {
+        line = Line::Int0;
+        return true;
+    }
+    if (pin == PD3) {
+        line = Line::Int1;
+        return true;
+    }
+    return false;
+}
+
+bool ExtInt::attach(Line line, Trigger trigger, Handler handler, void *context) {
+    uint8_t index = static_cast<uint8_t>(line);
+    if (handler == nullptr || (handlers[index] != nullptr && handlers[index] != handler)) {
+        return false;
+    }
+
+    uint8_t sreg = SREG; cli();
+    handlers[index] = handler;
+    contexts[index] = context;
+
+    uint8_t shift = static_cast<uint8_t>(index * 2); // ISC01:ISC00 or ISC11:ISC10
+    EICRA = static_cast<uint8_t>((EICRA & ~(0x03 << shift)) | (static_cast<uint8_t>(trigger) << shift));
+    EIFR = lineBit(line);   // drop an edge latched before the handler existed
+    EIMSK |= lineBit(line);
+    SREG = sreg;
+    return true;
+}
+
+void ExtInt::detach(Line line) {
+    uint8_t index = static_cast<uint8_t>(line);
+    uint8_t sreg = SREG; cli();
+    EIMSK &= static_cast<uint8_t>(~lineBit(line));
+    handlers[index] = nullptr;
+    contexts[index] = nullptr;
+    SREG = sreg;
+}
+
+void ExtInt::enable(Line line) {
+    if (handlers[static_cast<uint8_t>(line)] == nullptr) {
+        return;
+    }
+    uint8_t sreg = SREG; cli();
+    EIMSK |= lineBit(line);
+    SREG = sreg;
+}
+
+void ExtInt::disable(Line line) {
+    uint8_t sreg = SREG; cli();
+    EIMSK &= static_cast<uint8_t>(~lineBit(line));
+    SREG = sreg;
+}
+
+bool ExtInt::enabled(Line line) {
+    return (EIMSK & lineBit(line)) != 0;
+}
+
+void ExtInt::dispatch(Line line) {
+    uint8_t index = static_cast<uint8_t>(line);
+    Handler handler = handlers[index];
+    if (handler) {
+        handler(contexts[index]);
+    }
+}
+
+ISR(INT0_vect) {
+    ExtInt::dispatch(ExtInt::Line::Int0);
+}
+
+ISR(INT1_vect) {
+    ExtInt::dispatch(ExtInt::Line::Int1);
+}
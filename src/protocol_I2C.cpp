@@ -1,5 +1,16 @@
 #include "protocol_I2C.h"
 #include <util/delay.h>
+#include <avr/interrupt.h>
+
+I2C::Transaction *volatile I2C::twiQueueHead = nullptr;
+I2C::Transaction *volatile I2C::twiQueueTail = nullptr;
+volatile bool I2C::twiBusy = false;
+uint8_t I2C::twiIndex = 0;
+bool I2C::twiReading = false;
+
+// TWCR values used by the interrupt-driven engine
+static const uint8_t TWCR_ISR_NEXT = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+static const uint8_t TWCR_ISR_START = (1 << TWINT) | (1 << TWEN) | (1 << TWIE) | (1 << TWSTA);
 
 // ---------- Constructors ----------
 // Preferred explicit constructor (PIN register provided)
@@ -21,6 +32,43 @@ void I2C::setDelay(int microseconds) {
     I2C_DELAY_US = microseconds > 0 ? microseconds : 1;
 }
 
+void I2C::setClock(uint32_t frequencyHz) {
+    if (frequencyHz == 0) {
+        return;
+    }
+
+    // SCL = F_CPU / (16 + 2 * TWBR) with prescaler 1
+    uint32_t divider = F_CPU / frequencyHz;
+    uint32_t twbr = divider > 16 ? (divider - 16) / 2 : 0;
+    twiBitRate = static_cast<uint8_t>(twbr > 255 ? 255 : twbr);
+
+    // Software: ~5 us per phase at 100 kHz, 1 us (minimum) at 400 kHz
+    setDelay(static_cast<int>(500000UL / frequencyHz));
+
+    if (backend == Backend::Hardware) {
+        applyHardwareConfig();
+    }
+}
+
+bool I2C::setBackend(Backend newBackend) {
+    if (newBackend == Backend::Hardware) {
+        if (SDA_PORT != &PORTC || SDA_PIN != PC4 || SCL_PORT != &PORTC || SCL_PIN != PC5) {
+            return false;
+        }
+        backend = Backend::Hardware;
+        applyHardwareConfig();
+        return true;
+    }
+
+    if (backend == Backend::Hardware) {
+        TWCR = 0; // hand the pins back to PORTC
+        release_sda();
+        release_scl();
+    }
+    backend = Backend::Software;
+    return true;
+}
+
 bool I2C::writeMessage(uint8_t address, const uint8_t *data, unsigned int length) {
     if (!startCondition()) {
         return false;
@@ -60,6 +108,167 @@ bool I2C::readMessage(uint8_t address, uint8_t *data, unsigned int length) {
     return true;
 }
 
+bool I2C::writeThenRead(uint8_t address, const uint8_t *tx, unsigned int txLength,
+                        uint8_t *rx, unsigned int rxLength) {
+    if (!startCondition()) {
+        return false;
+    }
+
+    bool ok = writeByte(address << 1); // Write mode
+    for (unsigned int i = 0; ok && i < txLength; i++) {
+        ok = writeByte(tx[i]);
+    }
+
+    if (ok && rxLength) {
+        // Keep the bus: repeated START instead of STOP + START
+        ok = repeatedStartCondition() && writeByte((address << 1) | 0x01); // Read mode
+        for (unsigned int i = 0; ok && i < rxLength; i++) {
+            bool ack = (i < rxLength - 1); // ACK all but last byte
+            ok = readByte(rx[i], ack);
+        }
+    }
+
+    stopCondition();
+    return ok;
+}
+
+bool I2C::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, unsigned int length) {
+    return writeThenRead(address, &reg, 1, data, length);
+}
+
+bool I2C::readRegister(uint8_t address, uint8_t reg, uint8_t &value) {
+    return writeThenRead(address, &reg, 1, &value, 1);
+}
+
+bool I2C::writeRegister(uint8_t address, uint8_t reg, uint8_t value) {
+    uint8_t data[2] = {reg, value};
+    return writeMessage(address, data, 2);
+}
+
+// ---------- Interrupt-driven TWI engine ----------
+bool I2C::submit(Transaction &transaction) {
+    if (backend != Backend::Hardware) {
+        return false;
+    }
+    if (transaction.status == TransactionStatus::Queued || transaction.status == TransactionStatus::Busy) {
+        return false;
+    }
+
+    transaction.next = nullptr;
+    transaction.status = TransactionStatus::Queued;
+
+    uint8_t sreg = SREG; cli();
+    if (twiQueueTail) {
+        twiQueueTail->next = &transaction;
+    } else {
+        twiQueueHead = &transaction;
+    }
+    twiQueueTail = &transaction;
+
+    // Kick the engine unless it is running (or finishing inside a callback)
+    if (!twiBusy) {
+        twiBusy = true;
+        twiReading = false;
+        TWCR = TWCR_ISR_START;
+    }
+    SREG = sreg;
+    return true;
+}
+
+// Complete the head transaction and chain to the next one (ISR context)
+void I2C::twiFinish(TransactionStatus status) {
+    Transaction *done = twiQueueHead;
+    twiQueueHead = done->next;
+    if (!twiQueueHead) {
+        twiQueueTail = nullptr;
+    }
+    done->status = status;
+    twiReading = false;
+
+    if (done->callback) {
+        done->callback(*done);
+    }
+
+    bool released = (status == TransactionStatus::BusError);
+    if (twiQueueHead) {
+        twiQueueHead->status = TransactionStatus::Busy;
+        // STOP followed by START in one go, or just START if we lost the bus
+        TWCR = released ? TWCR_ISR_START : static_cast<uint8_t>(TWCR_ISR_START | (1 << TWSTO));
+    } else {
+        twiBusy = false;
+        TWCR = released ? static_cast<uint8_t>((1 << TWINT) | (1 << TWEN))
+                        : static_cast<uint8_t>((1 << TWINT) | (1 << TWEN) | (1 << TWSTO));
+    }
+}
+
+void I2C::onTwiInterrupt() {
+    Transaction *t = twiQueueHead;
+    if (!t) {
+        TWCR = (1 << TWINT) | (1 << TWEN);
+        twiBusy = false;
+        return;
+    }
+
+    switch (TWSR & 0xF8) {
+        case 0x08: // START
+        case 0x10: // repeated START
+            t->status = TransactionStatus::Busy;
+            twiIndex = 0;
+            if (twiReading || (t->txLength == 0 && t->rxLength != 0)) {
+                twiReading = true;
+                TWDR = static_cast<uint8_t>((t->address << 1) | 0x01);
+            } else {
+                TWDR = static_cast<uint8_t>(t->address << 1);
+            }
+            TWCR = TWCR_ISR_NEXT;
+            break;
+
+        case 0x18: // SLA+W ACK
+        case 0x28: // data ACK
+            if (twiIndex < t->txLength) {
+                TWDR = t->tx[twiIndex++];
+                TWCR = TWCR_ISR_NEXT;
+            } else if (t->rxLength) {
+                twiReading = true;
+                TWCR = TWCR_ISR_START; // repeated START for the read phase
+            } else {
+                twiFinish(TransactionStatus::Done);
+            }
+            break;
+
+        case 0x40: // SLA+R ACK: ACK every byte but the last
+            TWCR = static_cast<uint8_t>(TWCR_ISR_NEXT | (t->rxLength > 1 ? (1 << TWEA) : 0));
+            break;
+
+        case 0x50: // data received, ACK returned
+            t->rx[twiIndex++] = TWDR;
+            TWCR = static_cast<uint8_t>(TWCR_ISR_NEXT | (twiIndex + 1 < t->rxLength ? (1 << TWEA) : 0));
+            break;
+
+        case 0x58: // data received, NACK returned (last byte)
+            t->rx[twiIndex++] = TWDR;
+            twiFinish(TransactionStatus::Done);
+            break;
+
+        case 0x20: // SLA+W NACK
+        case 0x48: // SLA+R NACK
+            twiFinish(TransactionStatus::AddressNack);
+            break;
+
+        case 0x30: // data NACK
+            twiFinish(TransactionStatus::DataNack);
+            break;
+
+        default: // arbitration lost (0x38), bus error (0x00)
+            twiFinish(TransactionStatus::BusError);
+            break;
+    }
+}
+
+ISR(TWI_vect) {
+    I2C::onTwiInterrupt();
+}
+
 // ---------- Low-level pin control ----------
 void I2C::pull_scl_low() {
     (*SCL_DDR) |= (1 << SCL_PIN); // Set SCL as output
@@ -90,6 +299,56 @@ bool I2C::read_sda() {
     return ( (*SDA_PIN_REG) & (1 << SDA_PIN) ) != 0;
 }
 
+// ---------- TWI peripheral ----------
+void I2C::applyHardwareConfig() {
+    PRR &= static_cast<uint8_t>(~(1 << PRTWI));
+    TWSR = 0; // prescaler 1
+    TWBR = twiBitRate;
+    TWCR = (1 << TWEN);
+}
+
+// Takes the TWI for a blocking transfer. Waits for queued transactions to
+// finish; with interrupts off (e.g. inside a completion callback) they
+// can't, so it fails instead of spinning forever. twiBusy is set under cli()
+// so a submit() from an ISR only queues behind the blocking transfer.
+bool I2C::twiClaim() {
+    uint8_t sreg = SREG;
+    for (;;) {
+        cli();
+        if (!twiBusy) {
+            twiBusy = true;
+            SREG = sreg;
+            return true;
+        }
+        SREG = sreg;
+        if (!(sreg & (1 << SREG_I))) {
+            return false;
+        }
+    }
+}
+
+// End of a blocking transfer: start whatever was queued meanwhile
+void I2C::twiRelease() {
+    uint8_t sreg = SREG; cli();
+    if (twiQueueHead) {
+        twiReading = false;
+        TWCR = TWCR_ISR_START;
+    } else {
+        twiBusy = false;
+    }
+    SREG = sreg;
+}
+
+bool I2C::twiWait() {
+    uint16_t loops = TWI_TIMEOUT_LOOPS;
+    while (!(TWCR & (1 << TWINT))) {
+        if (--loops == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 inline void I2C::delay() {
     for (int i = 0; i < I2C_DELAY_US; ++i) {
         _delay_us(1);
@@ -98,6 +357,20 @@ inline void I2C::delay() {
 
 // ---------- Byte-level protocols ----------
 bool I2C::writeByte(uint8_t data) {
+    if (backend == Backend::Hardware) {
+        TWDR = data;
+        TWCR = (1 << TWINT) | (1 << TWEN);
+        if (!twiWait()) {
+            return false;
+        }
+        uint8_t status = twiStatus();
+        if (status == 0x38) { // arbitration lost
+            arbitration_lost = true;
+            return false;
+        }
+        return status == 0x18 || status == 0x28 || status == 0x40; // SLA+W, data, SLA+R ACKed
+    }
+
     for (int i = 0; i < 8; i++) {
         pull_scl_low(); // Clock low phase
         delay();
@@ -151,6 +424,16 @@ bool I2C::writeByte(uint8_t data) {
 }
 
 bool I2C::readByte(uint8_t &data, bool ack) {
+    if (backend == Backend::Hardware) {
+        TWCR = static_cast<uint8_t>((1 << TWINT) | (1 << TWEN) | (ack ? (1 << TWEA) : 0));
+        if (!twiWait()) {
+            return false;
+        }
+        data = TWDR;
+        uint8_t status = twiStatus();
+        return status == 0x50 || status == 0x58; // data received, ACK / NACK returned
+    }
+
     data = 0;
     for (int i = 0; i < 8; i++) {
         data <<= 1;
@@ -221,6 +504,18 @@ bool I2C::waitForSclHigh(uint32_t timeoutUs) {
 bool I2C::startCondition() {
     arbitration_lost = false;
 
+    if (backend == Backend::Hardware) {
+        if (!twiClaim()) {
+            return false;
+        }
+        TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
+        if (!twiWait() || twiStatus() != 0x08) { // START sent
+            stopCondition();
+            return false;
+        }
+        return true;
+    }
+
     if (!waitForBusIdle()) {
         return false;
     }
@@ -232,7 +527,42 @@ bool I2C::startCondition() {
     return true;
 }
 
+// START while we still own the bus (SCL low after the last ACK bit)
+bool I2C::repeatedStartCondition() {
+    if (backend == Backend::Hardware) {
+        TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
+        if (!twiWait()) {
+            return false;
+        }
+        return twiStatus() == 0x10; // repeated START sent
+    }
+
+    release_sda();
+    delay();
+
+    release_scl();
+    if (!waitForSclHigh()) {
+        return false;
+    }
+    delay();
+
+    pull_sda_low(); // SDA falls while SCL is high
+    delay();
+    pull_scl_low();
+    delay();
+    return true;
+}
+
 void I2C::stopCondition() {
+    if (backend == Backend::Hardware) {
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+        uint16_t loops = TWI_TIMEOUT_LOOPS;
+        while ((TWCR & (1 << TWSTO)) && --loops) {
+        }
+        twiRelease();
+        return;
+    }
+
     if (arbitration_lost) {
         release_sda();
         release_scl();
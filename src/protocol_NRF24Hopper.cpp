@@ -0,0 +1,175 @@
+#include <protocol_NRF24Hopper.h>
+#include <string.h>
+#include <util/delay.h>
+
+NRF24Hopper::NRF24Hopper(NRF24 &radioParam)
+    : radio(radioParam) {
+    memset(channels, 0, sizeof(channels));
+    memset(order, 0, sizeof(order));
+}
+
+bool NRF24Hopper::begin(const uint8_t *channelList, uint8_t count, uint16_t seedParam) {
+    if (channelList == nullptr || count < 2 || count > MAX_CHANNELS) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+        if (channelList[i] > 125) {
+            return false;
+        }
+        for (uint8_t j = 0; j < i; ++j) {
+            if (channelList[j] == channelList[i]) {
+                return false;
+            }
+        }
+        channels[i] = channelList[i];
+    }
+
+    channelCount = count;
+    period = static_cast<uint8_t>(count * (255U / count));
+    seed = seedParam;
+    orderBlock = 0xFF;
+    hop = 0;
+    silentSteps = 0;
+    rxSequenceValid = false;
+    carrierSamples = 0;
+    // Well inside the span of one send() (4 * count attempts), so a receiver
+    // on a quietly jammed channel leaves while the transmitter still tries
+    silentDwellSteps = static_cast<uint32_t>(count) * SILENT_DWELL_MS_PER_CHANNEL * (1000U / WAIT_STEP_US);
+
+    radio.setRetries(250, 2);
+    radio.setChannel(channelAt(hop));
+    return true;
+}
+
+bool NRF24Hopper::send(const void *data, uint8_t length, uint8_t maxAttempts) {
+    txAttempts = 0;
+    if (channelCount == 0 || length > MAX_PAYLOAD || (length != 0 && data == nullptr)) {
+        return false;
+    }
+    if (maxAttempts == 0) {
+        maxAttempts = static_cast<uint8_t>(channelCount * 4U);
+    }
+
+    uint8_t frame[NRF24::MAX_PAYLOAD_SIZE];
+    if (length) {
+        memcpy(&frame[HEADER_SIZE], data, length);
+    }
+
+    frame[1] = ++txSequence;
+    while (txAttempts < maxAttempts) {
+        ++txAttempts;
+        frame[0] = hop;
+        moveTo(hop);
+        bool delivered = radio.write(frame, static_cast<uint8_t>(HEADER_SIZE + length), true);
+        hop = nextPosition(hop); // the receiver advances too, or gets resynced
+        if (delivered) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void NRF24Hopper::startReceiving() {
+    silentSteps = 0;
+    carrierSamples = 0;
+    moveTo(hop);
+    radio.startListening();
+}
+
+bool NRF24Hopper::receive(void *buffer, uint8_t length, uint8_t &received, uint16_t timeoutMs) {
+    received = 0;
+    uint32_t waitSteps = static_cast<uint32_t>(timeoutMs) * (1000U / WAIT_STEP_US);
+    NRF24::Packet packet;
+
+    while (1) {
+        while (radio.readPacket(packet)) {
+            if (packet.length < HEADER_SIZE || packet.data[0] >= period) {
+                continue;
+            }
+            silentSteps = 0;
+            carrierSamples = 0;
+            hop = nextPosition(packet.data[0]);
+            moveTo(hop);
+
+            if (rxSequenceValid && packet.data[1] == rxSequence) {
+                continue; // resent after a lost ACK; position still taken
+            }
+            rxSequence = packet.data[1];
+            rxSequenceValid = true;
+
+            uint8_t size = static_cast<uint8_t>(packet.length - HEADER_SIZE);
+            received = size < length ? size : length;
+            if (buffer != nullptr) {
+                memcpy(buffer, &packet.data[HEADER_SIZE], received);
+            }
+            return true;
+        }
+
+        if (waitSteps-- == 0) {
+            return false;
+        }
+        _delay_us(WAIT_STEP_US);
+
+        if (++silentSteps % RPD_SAMPLE_STEPS != 0) {
+            continue;
+        }
+        // A carrier that keeps up without a packet is a jammer, not the link
+        carrierSamples = radio.testRpd() ? static_cast<uint8_t>(carrierSamples + 1) : 0;
+        if (carrierSamples >= JAM_SAMPLES || (silentDwellSteps != 0 && silentSteps >= silentDwellSteps)) {
+            silentSteps = 0;
+            carrierSamples = 0;
+            hop = nextPosition(hop);
+            moveTo(hop);
+        }
+    }
+}
+
+uint8_t NRF24Hopper::nextPosition(uint8_t position) const {
+    ++position;
+    return position >= period ? 0 : position;
+}
+
+void NRF24Hopper::moveTo(uint8_t position) {
+    radio.setChannel(channelAt(position));
+}
+
+uint8_t NRF24Hopper::channelAt(uint8_t position) {
+    if (channelCount == 0) {
+        return radio.getChannel();
+    }
+    uint8_t block = static_cast<uint8_t>(position / channelCount);
+    if (block != orderBlock) {
+        buildOrder(block);
+    }
+    return channels[order[position % channelCount]];
+}
+
+// Fisher-Yates over the channel indices, driven by an LFSR seeded per block
+// so any position can be computed directly after a resync
+void NRF24Hopper::buildOrder(uint8_t block) {
+    uint16_t state = static_cast<uint16_t>(seed ^ (static_cast<uint16_t>(block) * 0x9E37U));
+    if (state == 0) {
+        state = 0xACE1;
+    }
+    for (uint8_t i = 0; i < channelCount; ++i) {
+        order[i] = i;
+    }
+    for (uint8_t i = static_cast<uint8_t>(channelCount - 1); i > 0; --i) {
+        state = lfsrStep(state);
+        uint8_t j = static_cast<uint8_t>(state % (i + 1U));
+        uint8_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    orderBlock = block;
+}
+
+// 16-bit Galois LFSR, taps 16 14 13 11 (maximal length)
+uint16_t NRF24Hopper::lfsrStep(uint16_t state) {
+    uint16_t lsb = static_cast<uint16_t>(state & 1U);
+    state >>= 1;
+    if (lsb) {
+        state ^= 0xB400U;
+    }
+    return state;
+}
@@ -0,0 +1,184 @@
+#include <protocol_NRF24Network.h>
+#include <string.h>
+
+// Address byte 0 (the one pipes 2-5 override) per pipe; bytes 1-4 are the node
+// id and the network id. Alternating-only patterns are avoided as they look
+// like the preamble.
+static const uint8_t PIPE_BYTES[6] = {0xC3, 0x3C, 0x33, 0xCE, 0x3E, 0xE3};
+
+NRF24Network::NRF24Network(NRF24 &radioParam)
+    : radio(radioParam) {
+    memset(addressTail, 0, sizeof(addressTail));
+    memset(seenFrom, NO_NODE, sizeof(seenFrom));
+    memset(seenId, 0, sizeof(seenId));
+}
+
+bool NRF24Network::begin(uint8_t nodeId, uint16_t networkId) {
+    if (!validNode(nodeId)) {
+        return false;
+    }
+
+    node = nodeId;
+    addressTail[0] = static_cast<uint8_t>(networkId & 0xFF);
+    addressTail[1] = static_cast<uint8_t>(networkId >> 8);
+    addressTail[2] = 0xE7;
+    txTarget = NO_NODE;
+    rxHead = 0;
+    rxTail = 0;
+
+    radio.setDynamicPayloads(true);
+
+    // The first write fixes the 5-byte address width used by the pipes below
+    uint8_t address[ADDRESS_WIDTH];
+    makeAddress(node, 0, address);
+    radio.openWritingPipe(address, ADDRESS_WIDTH);
+
+    uint8_t firstPipe = node == HUB ? 1 : PARENT_PIPE;
+    uint8_t lastPipe = PARENT_PIPE;
+    if (node == HUB) {
+        lastPipe = MAX_CHILDREN_OF_HUB;
+    } else if (levelOf(node) == 1) {
+        lastPipe = PARENT_PIPE + MAX_CHILDREN_OF_RELAY;
+    }
+    for (uint8_t pipe = firstPipe; pipe <= lastPipe; ++pipe) {
+        makeAddress(node, pipe, address);
+        radio.openReadingPipe(pipe, address, ADDRESS_WIDTH, true);
+    }
+
+    radio.startListening();
+    return true;
+}
+
+bool NRF24Network::send(uint8_t to, uint8_t type, const void *data, uint8_t length) {
+    if (!validNode(to) || to == node || node == NO_NODE || length > MAX_PAYLOAD) {
+        return false;
+    }
+    if (length != 0 && data == nullptr) {
+        return false;
+    }
+
+    uint8_t frame[NRF24::MAX_PAYLOAD_SIZE];
+    frame[0] = to;
+    frame[1] = node;
+    frame[2] = txId++;
+    frame[3] = type;
+    if (length) {
+        memcpy(&frame[HEADER_SIZE], data, length);
+    }
+    return transmit(nextHop(to), frame, static_cast<uint8_t>(HEADER_SIZE + length));
+}
+
+uint8_t NRF24Network::update() {
+    NRF24::Packet packet;
+    while (radio.readPacket(packet)) {
+        if (packet.length < HEADER_SIZE) {
+            continue;
+        }
+        uint8_t to = packet.data[0];
+        uint8_t from = packet.data[1];
+        if (seen(from, packet.data[2])) {
+            ++duplicateCount;
+            continue;
+        }
+
+        if (to == node) {
+            if (static_cast<uint8_t>(rxHead - rxTail) >= RX_QUEUE_DEPTH) {
+                ++dropCount;
+                continue;
+            }
+            Message &message = rxQueue[rxHead % RX_QUEUE_DEPTH];
+            message.from = from;
+            message.to = to;
+            message.type = packet.data[3];
+            message.length = static_cast<uint8_t>(packet.length - HEADER_SIZE);
+            memcpy(message.data, &packet.data[HEADER_SIZE], message.length);
+            ++rxHead;
+        } else if (validNode(to) && transmit(nextHop(to), packet.data, packet.length)) {
+            ++forwardCount;
+        } else {
+            ++dropCount;
+        }
+    }
+    return static_cast<uint8_t>(rxHead - rxTail);
+}
+
+bool NRF24Network::read(Message &message) {
+    if (rxHead == rxTail) {
+        return false;
+    }
+    message = rxQueue[rxTail % RX_QUEUE_DEPTH];
+    ++rxTail;
+    return true;
+}
+
+bool NRF24Network::validNode(uint8_t id) {
+    if (id <= MAX_CHILDREN_OF_HUB) {
+        return true;
+    }
+    uint8_t relay = static_cast<uint8_t>(id & SLOT_MASK);
+    uint8_t slot = static_cast<uint8_t>(id >> 3);
+    return relay >= 1 && relay <= MAX_CHILDREN_OF_HUB && slot >= 1 && slot <= MAX_CHILDREN_OF_RELAY;
+}
+
+uint8_t NRF24Network::parentOf(uint8_t id) {
+    if (id == HUB || !validNode(id)) {
+        return NO_NODE;
+    }
+    return levelOf(id) == 1 ? HUB : static_cast<uint8_t>(id & SLOT_MASK);
+}
+
+uint8_t NRF24Network::levelOf(uint8_t id) {
+    if (id == HUB) {
+        return 0;
+    }
+    return id <= MAX_CHILDREN_OF_HUB ? 1 : 2;
+}
+
+// Pipe on which the parent of `child` listens for it
+uint8_t NRF24Network::childPipe(uint8_t child) {
+    return levelOf(child) == 1 ? child : static_cast<uint8_t>(PARENT_PIPE + (child >> 3));
+}
+
+// Down if `to` lives below this node, otherwise up
+uint8_t NRF24Network::nextHop(uint8_t to) const {
+    if (node == HUB) {
+        return static_cast<uint8_t>(to & SLOT_MASK);
+    }
+    if (levelOf(node) == 1 && levelOf(to) == 2 && (to & SLOT_MASK) == node) {
+        return to;
+    }
+    return parentOf(node);
+}
+
+// TX_ADDR (and RX_ADDR_P0 for the ACK) are only rewritten when the next hop
+// changes, so a child streaming to its parent pays for it once
+bool NRF24Network::transmit(uint8_t hop, const uint8_t *frame, uint8_t length) {
+    if (hop != txTarget) {
+        uint8_t address[ADDRESS_WIDTH];
+        uint8_t pipe = hop == parentOf(node) ? childPipe(node) : PARENT_PIPE;
+        makeAddress(hop, pipe, address);
+        radio.openWritingPipe(address, ADDRESS_WIDTH);
+        txTarget = hop;
+    }
+    return radio.write(frame, length, true);
+}
+
+bool NRF24Network::seen(uint8_t from, uint8_t id) {
+    for (uint8_t i = 0; i < DEDUP_DEPTH; ++i) {
+        if (seenFrom[i] == from && seenId[i] == id) {
+            return true;
+        }
+    }
+    seenFrom[seenNext] = from;
+    seenId[seenNext] = id;
+    seenNext = static_cast<uint8_t>((seenNext + 1) % DEDUP_DEPTH);
+    return false;
+}
+
+void NRF24Network::makeAddress(uint8_t id, uint8_t pipe, uint8_t *address) const {
+    address[0] = PIPE_BYTES[pipe];
+    address[1] = id;
+    address[2] = addressTail[0];
+    address[3] = addressTail[1];
+    address[4] = addressTail[2];
+}
@@ -0,0 +1,180 @@
+#include <protocol_NRF24Transport.h>
+#include <string.h>
+#include <util/delay.h>
+
+NRF24Transport::NRF24Transport(NRF24 &radioParam)
+    : radio(radioParam) {
+    memset(rxBitmap, 0, sizeof(rxBitmap));
+}
+
+void NRF24Transport::begin() {
+    radio.enableAckPayload(true);
+}
+
+bool NRF24Transport::send(const void *data, uint16_t length, uint8_t maxRounds) {
+    txFragmentsSent = 0;
+    txRounds = 0;
+    if (data == nullptr || length == 0 || length > MAX_MESSAGE_SIZE) {
+        return false;
+    }
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint8_t count = static_cast<uint8_t>((length + FRAGMENT_SIZE - 1) / FRAGMENT_SIZE);
+    txId = static_cast<uint8_t>((txId + 1) & ID_MASK);
+
+    // Bit set = fragment not yet confirmed by the receiver
+    uint8_t pending[BITMAP_SIZE];
+    memset(pending, 0, sizeof(pending));
+    for (uint8_t i = 0; i < count; ++i) {
+        pending[i >> 3] |= static_cast<uint8_t>(1U << (i & 0x07));
+    }
+
+    uint8_t frame[NRF24::MAX_PAYLOAD_SIZE];
+    frame[0] = static_cast<uint8_t>((TYPE_DATA << 6) | txId);
+    frame[2] = count;
+
+    while (txRounds < maxRounds) {
+        ++txRounds;
+        radio.flushRx(); // stale ACK payloads would block the status reply
+
+        for (uint8_t i = 0; i < count; ++i) {
+            if (!(pending[i >> 3] & (1U << (i & 0x07)))) {
+                continue;
+            }
+            uint16_t offset = static_cast<uint16_t>(i) * FRAGMENT_SIZE;
+            uint8_t size = (length - offset) < FRAGMENT_SIZE ? static_cast<uint8_t>(length - offset) : FRAGMENT_SIZE;
+            frame[1] = i;
+            memcpy(&frame[HEADER_SIZE], &bytes[offset], size);
+            radio.writeFast(frame, static_cast<uint8_t>(HEADER_SIZE + size), true);
+            ++txFragmentsSent;
+        }
+        radio.txStandby(); // MAX_RT losses simply stay pending
+
+        uint8_t received[BITMAP_SIZE];
+        if (!queryStatus(txId, count, received)) {
+            continue; // no answer: resend whatever is still pending
+        }
+
+        bool done = true;
+        for (uint8_t b = 0; b < BITMAP_SIZE; ++b) {
+            pending[b] &= static_cast<uint8_t>(~received[b]);
+            if (pending[b]) {
+                done = false;
+            }
+        }
+        if (done) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The first QUERY makes the receiver load its bitmap as an ACK payload; the
+// next one carries it back. Replies for another message id are ignored.
+bool NRF24Transport::queryStatus(uint8_t id, uint8_t count, uint8_t *bitmap) {
+    const uint8_t query[HEADER_SIZE] = {static_cast<uint8_t>((TYPE_QUERY << 6) | id), 0, count};
+    const uint8_t expected = static_cast<uint8_t>((TYPE_STATUS << 6) | id);
+
+    for (uint8_t attempt = 0; attempt < QUERY_ATTEMPTS; ++attempt) {
+        if (radio.write(query, HEADER_SIZE, true) && radio.isAckPayloadAvailable()) {
+            NRF24::Packet reply;
+            while (radio.readPacket(reply)) {
+                if (reply.length == NRF24::MAX_PAYLOAD_SIZE && reply.data[0] == expected && reply.data[2] == count) {
+                    memcpy(bitmap, &reply.data[HEADER_SIZE], BITMAP_SIZE);
+                    return true;
+                }
+            }
+        }
+        _delay_us(QUERY_GAP_US);
+    }
+    return false;
+}
+
+void NRF24Transport::setReceiveBuffer(uint8_t *buffer, uint16_t capacity) {
+    rxBuffer = buffer;
+    rxCapacity = capacity;
+    rxId = NO_MESSAGE;
+    rxComplete = false;
+    rxReleased = true;
+}
+
+bool NRF24Transport::poll() {
+    NRF24::Packet packet;
+    while (radio.readPacket(packet)) {
+        if (packet.length < HEADER_SIZE) {
+            continue;
+        }
+        uint8_t type = static_cast<uint8_t>(packet.data[0] >> 6);
+        if (type == TYPE_DATA) {
+            handleData(packet);
+        } else if (type == TYPE_QUERY) {
+            replyStatus(packet);
+        }
+    }
+    return messageReady();
+}
+
+void NRF24Transport::handleData(const NRF24::Packet &packet) {
+    uint8_t id = static_cast<uint8_t>(packet.data[0] & ID_MASK);
+    uint8_t index = packet.data[1];
+    uint8_t count = packet.data[2];
+    uint8_t size = static_cast<uint8_t>(packet.length - HEADER_SIZE);
+
+    if (rxBuffer == nullptr || count == 0 || count > MAX_FRAGMENTS || index >= count) {
+        return;
+    }
+    if (index + 1 < count && size != FRAGMENT_SIZE) {
+        return; // only the last fragment may be short
+    }
+
+    if (id != rxId || count != rxCount) {
+        if (rxComplete && !rxReleased) {
+            return; // previous message not consumed yet; the sender will retry
+        }
+        rxId = id;
+        rxCount = count;
+        rxReceived = 0;
+        rxLength = 0;
+        rxComplete = false;
+        rxReleased = false;
+        memset(rxBitmap, 0, sizeof(rxBitmap));
+    }
+
+    uint8_t mask = static_cast<uint8_t>(1U << (index & 0x07));
+    if (rxComplete || (rxBitmap[index >> 3] & mask)) {
+        return; // duplicate from a resend round
+    }
+
+    uint16_t offset = static_cast<uint16_t>(index) * FRAGMENT_SIZE;
+    if (offset + size > rxCapacity) {
+        return;
+    }
+
+    memcpy(&rxBuffer[offset], &packet.data[HEADER_SIZE], size);
+    rxBitmap[index >> 3] |= mask;
+    ++rxReceived;
+    if (index + 1 == count) {
+        rxLength = static_cast<uint16_t>(offset + size);
+    }
+    if (rxReceived == rxCount) {
+        rxComplete = true;
+    }
+}
+
+void NRF24Transport::replyStatus(const NRF24::Packet &packet) {
+    uint8_t id = static_cast<uint8_t>(packet.data[0] & ID_MASK);
+    uint8_t count = packet.data[2];
+
+    uint8_t reply[NRF24::MAX_PAYLOAD_SIZE];
+    memset(reply, 0, sizeof(reply));
+    reply[0] = static_cast<uint8_t>((TYPE_STATUS << 6) | id);
+    reply[2] = count;
+    if (id == rxId && count == rxCount) {
+        reply[1] = rxReceived;
+        memcpy(&reply[HEADER_SIZE], rxBitmap, BITMAP_SIZE);
+    }
+
+    radio.flushTx(); // an unclaimed older reply would go out first
+    radio.writeAckPayload(packet.pipe, reply, sizeof(reply));
+}
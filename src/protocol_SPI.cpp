@@ -16,7 +16,8 @@ SPI::SPI(volatile uint8_t *mosi_pin_reg, volatile uint8_t *mosi_ddr, volatile ui
 	  SS_PIN_REG(ss_pin_reg), SS_DDR(ss_ddr), SS_PORT(ss_port), SS_PIN(ss_pin),
 			SS_MASK(static_cast<uint8_t>(1U << ss_pin))
 {
-		recomputeDelayLoops();
+		computeHardwareConfig();
+		selectKernel();
 }
 
 void SPI::begin(bool autoChipSelectParam) {
@@ -32,10 +33,16 @@ void SPI::begin(bool autoChipSelectParam) {
 	driveMosi(false);
 	driveClockIdle();
 	deselect();
+
+	if (backend == Backend::Hardware) {
+		enableHardware();
+	}
 }
 
 void SPI::setBitOrder(BitOrder order) {
 	bitOrder = order;
+	computeHardwareConfig();
+	selectKernel();
 }
 
 void SPI::setDataMode(uint8_t mode) {
@@ -49,18 +56,22 @@ void SPI::setDataMode(ClockPolarity polarity, ClockPhase phase) {
 	clockPolarity = polarity;
 	clockPhase = phase;
 	driveClockIdle();
+	computeHardwareConfig();
+	selectKernel();
 }
 
-void SPI::setDelaysMicroseconds(double lowPhase, double highPhase) {
-	if (lowPhase < 0.0) {
-		lowPhase = 0.0;
-	}
-	if (highPhase < 0.0) {
-		highPhase = 0.0;
-	}
-	delayLowUs = lowPhase;
-	delayHighUs = highPhase;
-	recomputeDelayLoops();
+void SPI::setDelaysMicroseconds(uint16_t lowPhaseUs, uint16_t highPhaseUs) {
+	setDelaysNanoseconds(lowPhaseUs * 1000UL, highPhaseUs * 1000UL);
+}
+
+void SPI::setDelaysNanoseconds(uint32_t lowPhaseNs, uint32_t highPhaseNs) {
+	setDelayLoops(loopsForNanoseconds(lowPhaseNs), loopsForNanoseconds(highPhaseNs));
+}
+
+void SPI::setDelayLoops(uint16_t lowLoops, uint16_t highLoops) {
+	delayLowLoops = lowLoops;
+	delayHighLoops = highLoops;
+	selectKernel();
 }
 
 void SPI::setClockHz(uint32_t frequencyHz) {
@@ -68,16 +79,11 @@ void SPI::setClockHz(uint32_t frequencyHz) {
 		return;
 	}
 
-	double periodUs = 1000000.0 / static_cast<double>(frequencyHz);
-	double halfPeriod = periodUs * 0.5;
-
-	if (halfPeriod < 0.25) {
-		halfPeriod = 0.25;
-	}
+	hwClockBits = hardwareClockBits(frequencyHz);
+	computeHardwareConfig();
 
-	delayLowUs = halfPeriod;
-	delayHighUs = halfPeriod;
-	recomputeDelayLoops();
+	uint16_t loops = loopsForClockHz(frequencyHz);
+	setDelayLoops(loops, loops);
 }
 
 void SPI::setChipSelectPolarity(bool activeLow) {
@@ -89,7 +95,63 @@ void SPI::setAutoChipSelect(bool enable) {
 	autoChipSelect = enable;
 }
 
+bool SPI::setBackend(Backend newBackend) {
+	if (newBackend == Backend::Hardware) {
+		if (!usesHardwarePins()) {
+			return false;
+		}
+		backend = Backend::Hardware;
+		enableHardware();
+		selectKernel();
+		return true;
+	}
+
+	// The peripheral may be in use by other devices; select() turns it off
+	// only if this one bit-bangs the same pins
+	backend = Backend::Software;
+	selectKernel();
+	return true;
+}
+
+bool SPI::usesHardwarePins() const {
+	return MOSI_PORT == &PORTB && MOSI_PIN == PB3 &&
+		   MISO_PORT == &PORTB && MISO_PIN == PB4 &&
+		   SCK_PORT == &PORTB && SCK_PIN == PB5;
+}
+
+void SPI::enableHardware() {
+	PRR &= static_cast<uint8_t>(~(1 << PRSPI));
+	DDRB |= static_cast<uint8_t>((1 << PB2) | (1 << PB3) | (1 << PB5));
+	DDRB &= static_cast<uint8_t>(~(1 << PB4));
+	SPCR = hwSpcr;
+	SPSR = hwSpsr;
+}
+
+// Kept per device and loaded by select(), so another device's settings
+// never leak into this one's transfers
+void SPI::computeHardwareConfig() {
+	uint8_t spcr = static_cast<uint8_t>((1 << SPE) | (1 << MSTR) | (hwClockBits & 0x03));
+	if (bitOrder == BitOrder::LSBFirst) {
+		spcr |= static_cast<uint8_t>(1 << DORD);
+	}
+	if (clockPolarity == ClockPolarity::IdleHigh) {
+		spcr |= static_cast<uint8_t>(1 << CPOL);
+	}
+	if (clockPhase == ClockPhase::SampleTrailingEdge) {
+		spcr |= static_cast<uint8_t>(1 << CPHA);
+	}
+	hwSpcr = spcr;
+	hwSpsr = (hwClockBits & 0x80) ? static_cast<uint8_t>(1 << SPI2X) : 0;
+}
+
 void SPI::select() {
+	if (backend == Backend::Hardware) {
+		SPCR = hwSpcr;
+		SPSR = hwSpsr;
+	} else if ((SPCR & (1 << SPE)) && usesHardwarePins()) {
+		SPCR = 0; // hand the pins back to PORTB
+		driveClockIdle();
+	}
 	driveChipSelect(true);
 }
 
@@ -103,7 +165,7 @@ uint8_t SPI::transferByte(uint8_t data) {
 		select();
 	}
 
-	uint8_t value = transferByteCore(data);
+	uint8_t value = (this->*transferKernel)(data);
 
 	if (manageCs) {
 		deselect();
@@ -122,9 +184,10 @@ void SPI::transferBytes(const uint8_t *tx, uint8_t *rx, size_t length) {
 		select();
 	}
 
+	TransferKernel kernel = transferKernel;
 	for (size_t i = 0; i < length; ++i) {
 		uint8_t outbound = tx ? tx[i] : 0xFF;
-		uint8_t inbound = transferByteCore(outbound);
+		uint8_t inbound = (this->*kernel)(outbound);
 		if (rx) {
 			rx[i] = inbound;
 		}
@@ -135,8 +198,111 @@ void SPI::transferBytes(const uint8_t *tx, uint8_t *rx, size_t length) {
 	}
 }
 
+// On the peripheral the next byte is fetched while the current one shifts, so
+// at F_CPU/2 the loop keeps up with the 16-cycle byte time
 void SPI::writeBytes(const uint8_t *data, size_t length) {
-	transferBytes(data, nullptr, length);
+	if (backend != Backend::Hardware || data == nullptr) {
+		transferBytes(data, nullptr, length);
+		return;
+	}
+	if (length == 0) {
+		return;
+	}
+
+	bool manageCs = autoChipSelect;
+	if (manageCs) {
+		select();
+	}
+
+	SPDR = *data++;
+	while (--length) {
+		uint8_t next = *data++;
+		while (!(SPSR & (1 << SPIF))) {
+		}
+		SPDR = next;
+	}
+	while (!(SPSR & (1 << SPIF))) {
+	}
+	(void)SPDR;
+
+	if (manageCs) {
+		deselect();
+	}
+}
+
+void SPI::readBytes(uint8_t *rx, size_t length) {
+	if (backend != Backend::Hardware) {
+		transferBytes(nullptr, rx, length);
+		return;
+	}
+	if (length == 0) {
+		return;
+	}
+
+	bool manageCs = autoChipSelect;
+	if (manageCs) {
+		select();
+	}
+
+	SPDR = 0xFF;
+	while (--length) {
+		while (!(SPSR & (1 << SPIF))) {
+		}
+		uint8_t value = SPDR;
+		SPDR = 0xFF;
+		if (rx) {
+			*rx++ = value;
+		}
+	}
+	while (!(SPSR & (1 << SPIF))) {
+	}
+	uint8_t last = SPDR;
+	if (rx) {
+		*rx = last;
+	}
+
+	if (manageCs) {
+		deselect();
+	}
+}
+
+// The handler for byte i runs while byte i + 1 shifts in
+void SPI::readBytes(ByteHandler handler, void *context, size_t length) {
+	if (handler == nullptr) {
+		readBytes(static_cast<uint8_t *>(nullptr), length);
+		return;
+	}
+	if (length == 0) {
+		return;
+	}
+
+	bool manageCs = autoChipSelect;
+	if (manageCs) {
+		select();
+	}
+
+	if (backend == Backend::Hardware) {
+		SPDR = 0xFF;
+		for (size_t i = 0; i + 1 < length; ++i) {
+			while (!(SPSR & (1 << SPIF))) {
+			}
+			uint8_t value = SPDR;
+			SPDR = 0xFF;
+			handler(i, value, context);
+		}
+		while (!(SPSR & (1 << SPIF))) {
+		}
+		handler(length - 1, SPDR, context);
+	} else {
+		TransferKernel kernel = transferKernel;
+		for (size_t i = 0; i < length; ++i) {
+			handler(i, (this->*kernel)(0xFF), context);
+		}
+	}
+
+	if (manageCs) {
+		deselect();
+	}
 }
 
 void SPI::driveMosi(bool high) {
@@ -147,10 +313,6 @@ void SPI::driveMosi(bool high) {
 	}
 }
 
-bool SPI::sampleMiso() const {
-	return ((*MISO_PIN_REG) & MISO_MASK) != 0;
-}
-
 void SPI::driveClockIdle() {
 	if (clockPolarity == ClockPolarity::IdleLow) {
 		(*SCK_PORT) &= static_cast<uint8_t>(~SCK_MASK);
@@ -159,14 +321,6 @@ void SPI::driveClockIdle() {
 	}
 }
 
-void SPI::driveClockActive() {
-	if (clockPolarity == ClockPolarity::IdleLow) {
-		(*SCK_PORT) |= SCK_MASK;
-	} else {
-		(*SCK_PORT) &= static_cast<uint8_t>(~SCK_MASK);
-	}
-}
-
 void SPI::driveChipSelect(bool active) {
 	if (active) {
 		if (chipSelectActiveLow) {
@@ -183,93 +337,136 @@ void SPI::driveChipSelect(bool active) {
 	}
 }
 
-uint8_t SPI::transferByteCore(uint8_t data) {
-	uint8_t received = 0;
-
-	if (clockPhase == ClockPhase::SampleLeadingEdge) {
-		driveClockIdle();
-
-		for (uint8_t i = 0; i < 8; ++i) {
-			uint8_t shift = (bitOrder == BitOrder::MSBFirst) ? static_cast<uint8_t>(7 - i) : i;
-			bool outBit = ((data >> shift) & 0x01) != 0;
-
-			driveMosi(outBit);
-			waitLowPhase();
-
-			driveClockActive();
-			waitHighPhase();
-
-			if (sampleMiso()) {
-				received |= static_cast<uint8_t>(1U << shift);
-			}
+// Pin state for one kernel call, copied into locals so the pointers and
+// masks stay in registers across the unrolled bits.
+struct KernelIo {
+	volatile uint8_t *mosiPort;
+	uint8_t mosiMask;
+	volatile uint8_t *misoPin;
+	uint8_t misoMask;
+	volatile uint8_t *sckPin;
+	uint8_t sckMask;
+	uint16_t lowLoops;
+	uint16_t highLoops;
+};
+
+static inline __attribute__((always_inline)) void kernelDelay(uint16_t loops) {
+	if (loops) {
+		_delay_loop_2(loops);
+	}
+}
 
-			driveClockIdle();
-			waitLowPhase();
+// One bit. SCK edges are PINx toggles (single store, polarity independent);
+// the clock is left idle by setDataMode()/setBackend() and every byte ends on
+// an even number of toggles.
+template <bool SampleTrailing, bool Paced>
+static inline __attribute__((always_inline)) void kernelBit(const KernelIo &io, uint8_t data,
+															uint8_t &received, uint8_t mask) {
+	if (!SampleTrailing) {
+		if (data & mask) {
+			(*io.mosiPort) |= io.mosiMask;
+		} else {
+			(*io.mosiPort) &= static_cast<uint8_t>(~io.mosiMask);
+		}
+		if (Paced) {
+			kernelDelay(io.lowLoops);
+		}
+		(*io.sckPin) = io.sckMask;
+		if (Paced) {
+			kernelDelay(io.highLoops);
+		}
+		if ((*io.misoPin) & io.misoMask) {
+			received |= mask;
+		}
+		(*io.sckPin) = io.sckMask;
+		if (Paced) {
+			kernelDelay(io.lowLoops);
 		}
 	} else {
-		driveClockIdle();
-
-		for (uint8_t i = 0; i < 8; ++i) {
-			uint8_t shift = (bitOrder == BitOrder::MSBFirst) ? static_cast<uint8_t>(7 - i) : i;
-			bool outBit = ((data >> shift) & 0x01) != 0;
-
-			driveClockActive();
-			waitHighPhase();
-
-			driveMosi(outBit);
-			waitLowPhase();
-
-			driveClockIdle();
-
-			if (sampleMiso()) {
-				received |= static_cast<uint8_t>(1U << shift);
-			}
-
-			waitHighPhase();
+		(*io.sckPin) = io.sckMask;
+		if (Paced) {
+			kernelDelay(io.highLoops);
+		}
+		if (data & mask) {
+			(*io.mosiPort) |= io.mosiMask;
+		} else {
+			(*io.mosiPort) &= static_cast<uint8_t>(~io.mosiMask);
+		}
+		if (Paced) {
+			kernelDelay(io.lowLoops);
+		}
+		(*io.sckPin) = io.sckMask;
+		if ((*io.misoPin) & io.misoMask) {
+			received |= mask;
+		}
+		if (Paced) {
+			kernelDelay(io.highLoops);
 		}
 	}
-
-	return received;
 }
 
-void SPI::recomputeDelayLoops() {
-	const double factor = static_cast<double>(F_CPU) / 4000000.0; // 4 cycles per loop
+// Zero-delay kernels are fully unrolled with constant masks. Paced kernels
+// keep the loop: the phase delays dominate and unrolling would only cost flash.
+template <bool LsbFirst, bool SampleTrailing, bool Paced>
+uint8_t SPI::softwareKernel(uint8_t data) {
+	const KernelIo io = {MOSI_PORT, MOSI_MASK, MISO_PIN_REG, MISO_MASK,
+						 SCK_PIN_REG, SCK_MASK, delayLowLoops, delayHighLoops};
+	uint8_t received = 0;
 
-	if (delayLowUs <= 0.0) {
-		delayLowLoops = 0;
-	} else {
-		double loops = delayLowUs * factor;
-		if (loops < 1.0) {
-			loops = 1.0;
-		}
-		if (loops > 65535.0) {
-			loops = 65535.0;
+	if (Paced) {
+		uint8_t mask = LsbFirst ? 0x01 : 0x80;
+		for (uint8_t i = 0; i < 8; ++i) {
+			kernelBit<SampleTrailing, true>(io, data, received, mask);
+			mask = LsbFirst ? static_cast<uint8_t>(mask << 1) : static_cast<uint8_t>(mask >> 1);
 		}
-		delayLowLoops = static_cast<uint16_t>(loops);
-	}
-
-	if (delayHighUs <= 0.0) {
-		delayHighLoops = 0;
 	} else {
-		double loops = delayHighUs * factor;
-		if (loops < 1.0) {
-			loops = 1.0;
-		}
-		if (loops > 65535.0) {
-			loops = 65535.0;
-		}
-		delayHighLoops = static_cast<uint16_t>(loops);
+		kernelBit<SampleTrailing, false>(io, data, received, LsbFirst ? 0x01 : 0x80);
+		kernelBit<SampleTrailing, false>(io, data, received, LsbFirst ? 0x02 : 0x40);
+		kernelBit<SampleTrailing, false>(io, data, received, LsbFirst ? 0x04 : 0x20);
+		kernelBit<SampleTrailing, false>(io, data, received, LsbFirst ? 0x08 : 0x10);
+		kernelBit<SampleTrailing, false>(io, data, received, LsbFirst ? 0x10 : 0x08);
+		kernelBit<SampleTrailing, false>(io, data, received, LsbFirst ? 0x20 : 0x04);
+		kernelBit<SampleTrailing, false>(io, data, received, LsbFirst ? 0x40 : 0x02);
+		kernelBit<SampleTrailing, false>(io, data, received, LsbFirst ? 0x80 : 0x01);
 	}
+
+	return received;
 }
 
-inline void SPI::waitLowPhase() const {
-	if (delayLowLoops) {
-		_delay_loop_2(delayLowLoops);
+uint8_t SPI::hardwareKernel(uint8_t data) {
+	SPDR = data;
+	while (!(SPSR & (1 << SPIF))) {
 	}
+	return SPDR;
 }
 
-inline void SPI::waitHighPhase() const {
-	if (delayHighLoops) {
-		_delay_loop_2(delayHighLoops);
+void SPI::selectKernel() {
+	// Index: bit 2 = LSB first, bit 1 = sample on trailing edge, bit 0 = paced
+	static const TransferKernel kernels[8] = {
+		&SPI::softwareKernel<false, false, false>,
+		&SPI::softwareKernel<false, false, true>,
+		&SPI::softwareKernel<false, true, false>,
+		&SPI::softwareKernel<false, true, true>,
+		&SPI::softwareKernel<true, false, false>,
+		&SPI::softwareKernel<true, false, true>,
+		&SPI::softwareKernel<true, true, false>,
+		&SPI::softwareKernel<true, true, true>,
+	};
+
+	if (backend == Backend::Hardware) {
+		transferKernel = &SPI::hardwareKernel;
+		return;
 	}
-}
\ No newline at end of file
+
+	uint8_t index = 0;
+	if (bitOrder == BitOrder::LSBFirst) {
+		index |= 0x04;
+	}
+	if (clockPhase == ClockPhase::SampleTrailingEdge) {
+		index |= 0x02;
+	}
+	if (delayLowLoops || delayHighLoops) {
+		index |= 0x01;
+	}
+	transferKernel = kernels[index];
+}
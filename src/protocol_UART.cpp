@@ -29,7 +29,7 @@ UART::UART(volatile uint8_t *tx_pin_reg, volatile uint8_t *tx_ddr, volatile uint
     : TX_PIN_REG(tx_pin_reg), TX_DDR(tx_ddr), TX_PORT(tx_port), TX_PIN(tx_pin),
       RX_PIN_REG(rx_pin_reg), RX_DDR(rx_ddr), RX_PORT(rx_port), RX_PIN(rx_pin),
     rxPCMSK(nullptr), rxPCIEBit(0), rxMask(0), rxGroupIdx(0xFF),
-    baudrate(baud), bitDelayUs(0), halfBitUs(0), bitLoopCount(0), halfBitLoopCount(0) {
+    baudrate(baud), bitDelayUs(0), halfBitUs(0), bitLoopCount(0), halfBitLoopCount(0), bitTicks(0) {
 
     // Configure TX pin as output, idle high
     *TX_DDR |= (1 << TX_PIN);
@@ -93,10 +93,17 @@ void UART::recomputeTiming() {
     bitLoopCount = (uint16_t)(cyclesPerBit / 4UL);
     halfBitLoopCount = (uint16_t)(bitLoopCount / 2U);
     if (halfBitLoopCount == 0) halfBitLoopCount = 1;
+
+    // Timer1 runs at clk/1, so one tick is one CPU cycle (baud >= ~245 fits 16 bits)
+    unsigned long ticks = F_CPU / baudrate;
+    if (ticks > 0xFFFFUL) ticks = 0xFFFFUL;
+    bitTicks = (uint16_t)ticks;
 }
 
 bool UART::begin(unsigned long baud) {
     if (baud) {
+        flushTx(); // don't change timing under a frame that is still shifting out
+
         baudrate = baud;
         recomputeTiming();
     }
@@ -115,8 +122,19 @@ bool UART::begin(unsigned long baud) {
     return true;
 }
 
-// Transmit one byte, bit-banged
+// Transmit one byte using the selected TX engine
 void UART::sendByte(uint8_t data) {
+#if UART_TIMER_ENGINE
+    if (txEngine == TxMode::Timer) {
+        queueTx(data);
+        return;
+    }
+#endif
+    sendByteBlocking(data);
+}
+
+// Transmit one byte, bit-banged
+void UART::sendByteBlocking(uint8_t data) {
     uint8_t sreg = SREG; cli(); // Disable interrupts for accurate timing
 
     // Start bit (low)
@@ -141,7 +159,9 @@ void UART::sendByte(uint8_t data) {
     
     // CRITICAL: Add inter-byte delay for receiver to process
     // DFPlayer and other devices need ~1 bit time between bytes
-    _bit_delay(bitLoopCount);
+    for (uint8_t i = 0; i < interByteGapBits; i++) {
+        _bit_delay(bitLoopCount);
+    }
 }
 
 void UART::sendBytes(const uint8_t *data, unsigned int length) {
@@ -156,6 +176,17 @@ void UART::sendString(const char *str) {
     }
 }
 
+// Re-enable this pin's PCINT and resync the group snapshot so the next
+// falling edge is seen as a change
+void UART::rearmRxPinChange() {
+    if (!rxPCMSK) return;
+    uint8_t level = *RX_PIN_REG & rxMask;
+    if (rxGroupIdx == 0) lastPINB = (uint8_t)((lastPINB & ~rxMask) | level);
+    else if (rxGroupIdx == 1) lastPINC = (uint8_t)((lastPINC & ~rxMask) | level);
+    else if (rxGroupIdx == 2) lastPIND = (uint8_t)((lastPIND & ~rxMask) | level);
+    *rxPCMSK |= rxMask;
+}
+
 // -------- RX API --------
 int UART::available() const {
     return (uint8_t)(RX_BUF_SIZE + rxHead - rxTail) % RX_BUF_SIZE;
@@ -183,7 +214,7 @@ void UART::handleReceiveInterrupt(void (*callback)(uint8_t)) {
     rxCallback = callback;
 }
 
-inline void UART::storeRx(uint8_t b) {
+void UART::storeRx(uint8_t b) {
     uint8_t next = (uint8_t)((rxHead + 1) % RX_BUF_SIZE);
     if (next != rxTail) {
         rxBuf[rxHead] = b;
@@ -194,15 +225,38 @@ inline void UART::storeRx(uint8_t b) {
     }
 }
 
-// Called from ISR context when RX pin changes state
-void UART::onRxPinChange() {
+// Called from ISR context when RX pin changes state.
+// stamp is TCNT1 captured on ISR entry (used by the timer RX engine).
+void UART::onRxPinChange(uint16_t stamp) {
     if (!rxPCMSK) return;
+
+#if UART_TIMER_ENGINE
+    if (rxEngine == RxMode::Timer) {
+        // Edges of a frame that is already being sampled are not start bits
+        if (rxBitIndex != 0) return;
+        if ((*RX_PIN_REG & rxMask) != 0) return;
+        *rxPCMSK &= (uint8_t)~rxMask;
+
+        // First sample at the center of the start bit
+        rxShiftReg = 0;
+        rxNextSample = (uint16_t)(stamp + (bitTicks >> 1));
+        rxBitIndex = 1;
+
+        if (!(TIMSK1 & (1 << OCIE1B)) || (int16_t)(rxNextSample - OCR1B) < 0) {
+            OCR1B = rxNextSample;
+            TIFR1 = (1 << OCF1B);
+            TIMSK1 |= (1 << OCIE1B);
+        }
+        return;
+    }
+#endif
+
     // Falling edge start bit detection: ensure line is low now
     if ((*RX_PIN_REG & rxMask) != 0) return;
     // Disable this pin's PCINT during sampling to avoid reentry
     *rxPCMSK &= (uint8_t)~rxMask;
     sampleRx();
-    *rxPCMSK |= rxMask;
+    rearmRxPinChange();
 }
 
 // Blocking sampling routine (executed within ISR)
@@ -235,6 +289,7 @@ void UART::sampleRx() {
 
 // -------- Pin Change Interrupt Vectors --------
 ISR(PCINT0_vect) {
+    uint16_t stamp = TCNT1;
     uint8_t current = PINB;
     uint8_t changed = current ^ UART::lastPINB;
     UART::lastPINB = current;
@@ -245,7 +300,7 @@ ISR(PCINT0_vect) {
             if (changed & u->rxMask) { // pin changed
                 // Check falling edge: previously high, now low
                 if (!(current & u->rxMask)) {
-                    u->onRxPinChange();
+                    u->onRxPinChange(stamp);
                 }
             }
         }
@@ -253,6 +308,7 @@ ISR(PCINT0_vect) {
 }
 
 ISR(PCINT1_vect) {
+    uint16_t stamp = TCNT1;
     uint8_t current = PINC;
     uint8_t changed = current ^ UART::lastPINC;
     UART::lastPINC = current;
@@ -262,7 +318,7 @@ ISR(PCINT1_vect) {
             if (!u) continue;
             if (changed & u->rxMask) {
                 if (!(current & u->rxMask)) {
-                    u->onRxPinChange();
+                    u->onRxPinChange(stamp);
                 }
             }
         }
@@ -270,6 +326,7 @@ ISR(PCINT1_vect) {
 }
 
 ISR(PCINT2_vect) {
+    uint16_t stamp = TCNT1;
     uint8_t current = PIND;
     uint8_t changed = current ^ UART::lastPIND;
     UART::lastPIND = current;
@@ -279,7 +336,7 @@ ISR(PCINT2_vect) {
             if (!u) continue;
             if (changed & u->rxMask) {
                 if (!(current & u->rxMask)) {
-                    u->onRxPinChange();
+                    u->onRxPinChange(stamp);
                 }
             }
         }
@@ -0,0 +1,285 @@
+// Timer1 engines of the software UART: TX shifted out by COMPA, RX sampled
+// by COMPB. This file owns TIMER1_COMPA_vect and TIMER1_COMPB_vect; with
+// UART_TIMER_ENGINE set to 0 it defines neither and only TxMode/RxMode
+// Blocking are available.
+#include "protocol_UART.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#if UART_TIMER_ENGINE
+
+UART *UART::instancesTimerTx[MAX_TIMER_TX_UARTS] = {nullptr};
+uint8_t UART::countTimerTx = 0;
+UART *volatile UART::txActive = nullptr;
+volatile uint8_t UART::txShiftReg = 0;
+volatile uint8_t UART::txBitIndex = 0;
+UART *UART::instancesTimerRx[MAX_TIMER_RX_UARTS] = {nullptr};
+uint8_t UART::countTimerRx = 0;
+
+// Ticks between arming the TX timer and the first start bit edge
+static const uint16_t TX_START_LEAD_TICKS = 128;
+// RX bits due within this many ticks are sampled now instead of re-arming COMPB
+static const int16_t RX_SAMPLE_SLACK_TICKS = 48;
+
+// Timer1 free-running in normal mode at clk/1 (shared by TX COMPA and RX COMPB)
+static inline void timer1FreeRun() {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+}
+
+// -------- Timer TX engine --------
+bool UART::setTxMode(TxMode mode) {
+    if (mode == txEngine) return true;
+
+    if (mode == TxMode::Blocking) {
+        flushTx();
+        txEngine = TxMode::Blocking;
+        return true;
+    }
+
+    // Register once; instances stay registered so queued bytes are always found
+    bool registered = false;
+    for (uint8_t i = 0; i < countTimerTx; i++) {
+        if (instancesTimerTx[i] == this) registered = true;
+    }
+    if (!registered) {
+        if (countTimerTx >= MAX_TIMER_TX_UARTS) return false;
+        instancesTimerTx[countTimerTx++] = this;
+    }
+    txHead = txTail = 0;
+    txEngine = TxMode::Timer;
+    return true;
+}
+
+uint8_t UART::txPending() const {
+    uint8_t sreg = SREG; cli();
+    uint8_t pending = (uint8_t)((TX_BUF_SIZE + txHead - txTail) % TX_BUF_SIZE);
+    if (txActive == this && txBitIndex != 0) pending++; // byte still on the wire
+    SREG = sreg;
+    return pending;
+}
+
+void UART::flushTx() {
+    if (txEngine != TxMode::Timer) return;
+    while (txPending()) {
+        // With interrupts off the compare ISR can't run; service it by polling
+        if (!(SREG & (1 << SREG_I)) && (TIFR1 & (1 << OCF1A))) {
+            TIFR1 = (1 << OCF1A);
+            onTxTimer();
+        }
+    }
+}
+
+void UART::queueTx(uint8_t data) {
+    uint8_t next = (uint8_t)((txHead + 1) % TX_BUF_SIZE);
+    while (next == txTail) {
+        // Buffer full: wait for the engine, polling it if interrupts are off
+        if (!(SREG & (1 << SREG_I)) && (TIFR1 & (1 << OCF1A))) {
+            TIFR1 = (1 << OCF1A);
+            onTxTimer();
+        }
+    }
+    txBuf[txHead] = data;
+
+    uint8_t sreg = SREG; cli();
+    txHead = next;
+    if (txActive == nullptr) {
+        startTxTimer(this);
+    }
+    SREG = sreg;
+}
+
+// Must be called with interrupts disabled
+void UART::startTxTimer(UART *u) {
+    txActive = u;
+    txBitIndex = 0;
+
+    timer1FreeRun();
+
+    OCR1A = (uint16_t)(TCNT1 + TX_START_LEAD_TICKS);
+    TIFR1 = (1 << OCF1A);
+    TIMSK1 |= (1 << OCIE1A);
+}
+
+// Round-robin search for another timer-TX UART with queued bytes
+UART *UART::nextPendingTx(UART *current) {
+    uint8_t start = 0;
+    for (uint8_t i = 0; i < countTimerTx; i++) {
+        if (instancesTimerTx[i] == current) start = (uint8_t)(i + 1);
+    }
+    for (uint8_t n = 0; n < countTimerTx; n++) {
+        UART *u = instancesTimerTx[(start + n) % countTimerTx];
+        if (u && u->txHead != u->txTail) return u;
+    }
+    return nullptr;
+}
+
+// Called from TIMER1_COMPA at every bit boundary; emits one bit per call
+void UART::onTxTimer() {
+    UART *u = txActive;
+    if (!u) {
+        TIMSK1 &= (uint8_t)~(1 << OCIE1A);
+        return;
+    }
+
+    uint8_t idx = txBitIndex;
+    if (idx == 0) {
+        // Frame boundary: load the next byte, possibly from another UART
+        if (u->txHead == u->txTail) {
+            u = nextPendingTx(u);
+            if (!u) {
+                txActive = nullptr;
+                TIMSK1 &= (uint8_t)~(1 << OCIE1A);
+                return;
+            }
+            txActive = u;
+        }
+        txShiftReg = u->txBuf[u->txTail];
+        u->txTail = (uint8_t)((u->txTail + 1) % TX_BUF_SIZE);
+        *u->TX_PORT &= ~(1 << u->TX_PIN); // start bit
+    } else if (idx <= 8) {
+        uint8_t bits = txShiftReg;
+        if (bits & 0x01) {
+            *u->TX_PORT |= (1 << u->TX_PIN);
+        } else {
+            *u->TX_PORT &= ~(1 << u->TX_PIN);
+        }
+        txShiftReg = (uint8_t)(bits >> 1);
+    } else if (idx == 9) {
+        *u->TX_PORT |= (1 << u->TX_PIN); // stop bit
+    }
+    // idx > 9: inter-byte gap, line stays high
+
+    idx++;
+    if (idx >= (uint8_t)(10 + u->interByteGapBits)) idx = 0;
+    txBitIndex = idx;
+
+    // Schedule from the previous compare value so bit edges don't accumulate ISR latency
+    OCR1A += u->bitTicks;
+}
+
+// -------- Timer RX engine --------
+bool UART::setRxMode(RxMode mode) {
+    if (mode == rxEngine) return true;
+
+    uint8_t sreg = SREG; cli();
+    if (mode == RxMode::Timer) {
+        bool registered = false;
+        for (uint8_t i = 0; i < countTimerRx; i++) {
+            if (instancesTimerRx[i] == this) registered = true;
+        }
+        if (!registered) {
+            if (countTimerRx >= MAX_TIMER_RX_UARTS) {
+                SREG = sreg;
+                return false;
+            }
+            instancesTimerRx[countTimerRx++] = this;
+        }
+        timer1FreeRun();
+    }
+    // Abandon any frame in progress and listen for a fresh start edge
+    rxBitIndex = 0;
+    rxEngine = mode;
+    rearmRxPinChange();
+    SREG = sreg;
+    return true;
+}
+
+// Sample one bit at its center (COMPB ISR context)
+void UART::sampleRxBit() {
+    bool high = (*RX_PIN_REG & rxMask) != 0;
+    uint8_t idx = rxBitIndex;
+
+    if (idx == 1) {
+        if (high) {
+            // Glitch; not a real start bit
+            rxBitIndex = 0;
+            rearmRxPinChange();
+            return;
+        }
+    } else if (idx <= 9) {
+        // Data bits arrive LSB first
+        rxShiftReg = (uint8_t)(rxShiftReg >> 1);
+        if (high) rxShiftReg |= 0x80;
+    } else {
+        // Stop bit (should be high)
+        if (high) {
+            storeRx(rxShiftReg);
+        } else {
+            rxFrameErrorCount++;
+        }
+        rxBitIndex = 0;
+        rearmRxPinChange();
+        return;
+    }
+
+    rxBitIndex = (uint8_t)(idx + 1);
+    rxNextSample += bitTicks;
+}
+
+// Called from TIMER1_COMPB: sample every receiver whose bit center is due,
+// then arm COMPB for the nearest remaining one
+void UART::onRxTimer() {
+    for (;;) {
+        uint16_t now = TCNT1;
+        UART *nearest = nullptr;
+        int16_t nearestDelta = 0;
+
+        for (uint8_t i = 0; i < countTimerRx; i++) {
+            UART *u = instancesTimerRx[i];
+            if (!u || u->rxBitIndex == 0) continue;
+
+            int16_t delta = (int16_t)(u->rxNextSample - now);
+            if (delta <= RX_SAMPLE_SLACK_TICKS) {
+                u->sampleRxBit();
+                if (u->rxBitIndex == 0) continue;
+                delta = (int16_t)(u->rxNextSample - now);
+            }
+            if (!nearest || delta < nearestDelta) {
+                nearest = u;
+                nearestDelta = delta;
+            }
+        }
+
+        if (!nearest) {
+            TIMSK1 &= (uint8_t)~(1 << OCIE1B);
+            return;
+        }
+
+        // Re-arm only if the deadline is safely ahead; otherwise sample again now
+        if ((int16_t)(nearest->rxNextSample - TCNT1) > RX_SAMPLE_SLACK_TICKS) {
+            OCR1B = nearest->rxNextSample;
+            TIFR1 = (1 << OCF1B);
+            TIMSK1 |= (1 << OCIE1B);
+            return;
+        }
+    }
+}
+
+// -------- Timer Interrupt Vectors --------
+ISR(TIMER1_COMPA_vect) {
+    UART::onTxTimer();
+}
+
+ISR(TIMER1_COMPB_vect) {
+    UART::onRxTimer();
+}
+
+#else
+
+bool UART::setTxMode(TxMode mode) {
+    return mode == TxMode::Blocking;
+}
+
+uint8_t UART::txPending() const {
+    return 0;
+}
+
+void UART::flushTx() {
+}
+
+bool UART::setRxMode(RxMode mode) {
+    return mode == RxMode::Blocking;
+}
+
+#endif // UART_TIMER_ENGINE
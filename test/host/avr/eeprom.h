@@ -0,0 +1,23 @@
+// Host stand-in for <avr/eeprom.h>: EEPROM is the hostEeprom array, indexed by
+// the address the caller passes.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define EEMEM
+
+extern uint8_t hostEeprom[1024];
+
+inline uint8_t eeprom_read_byte(const uint8_t *address) {
+    return hostEeprom[reinterpret_cast<uintptr_t>(address)];
+}
+inline void eeprom_update_byte(uint8_t *address, uint8_t value) {
+    hostEeprom[reinterpret_cast<uintptr_t>(address)] = value;
+}
+inline void eeprom_read_block(void *destination, const void *address, size_t length) {
+    memcpy(destination, &hostEeprom[reinterpret_cast<uintptr_t>(address)], length);
+}
+inline void eeprom_update_block(const void *source, void *address, size_t length) {
+    memcpy(&hostEeprom[reinterpret_cast<uintptr_t>(address)], source, length);
+}
@@ -0,0 +1,9 @@
+// Host stand-in for <avr/interrupt.h>. Tests call ISRs directly and run on
+// a single thread, so cli()/sei() have nothing to mask.
+#pragma once
+#include <avr/io.h>
+
+#define ISR(vector, ...) extern "C" void vector(void); void vector(void)
+
+inline void cli() {}
+inline void sei() {}
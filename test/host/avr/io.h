@@ -0,0 +1,142 @@
+// Host stand-in for <avr/io.h>: the ATmega328P registers the library touches
+// are plain variables (defined in host.cpp) so sources compile unchanged.
+#pragma once
+#include <stdint.h>
+
+#define HOST_SFR(name) extern volatile uint8_t name;
+HOST_SFR(PINB) HOST_SFR(DDRB) HOST_SFR(PORTB)
+HOST_SFR(PINC) HOST_SFR(DDRC) HOST_SFR(PORTC)
+HOST_SFR(PIND) HOST_SFR(DDRD) HOST_SFR(PORTD)
+HOST_SFR(PCICR) HOST_SFR(PCMSK0) HOST_SFR(PCMSK1) HOST_SFR(PCMSK2) HOST_SFR(PCIFR)
+HOST_SFR(SREG) HOST_SFR(EICRA) HOST_SFR(EIMSK) HOST_SFR(EIFR)
+HOST_SFR(TCCR1A) HOST_SFR(TCCR1B) HOST_SFR(TCCR1C) HOST_SFR(TIMSK1)
+HOST_SFR(TCCR2A) HOST_SFR(TCCR2B) HOST_SFR(TIMSK2) HOST_SFR(TIFR2)
+HOST_SFR(OCR2A) HOST_SFR(OCR2B) HOST_SFR(TCNT2) HOST_SFR(GTCCR)
+HOST_SFR(TWBR) HOST_SFR(TWSR) HOST_SFR(TWDR) HOST_SFR(TWAR)
+HOST_SFR(PRR)
+#undef HOST_SFR
+extern volatile uint16_t OCR1A;
+extern volatile uint16_t OCR1B;
+extern volatile uint16_t ICR1;
+
+// Registers whose accesses have side effects on the chip (writing SPDR
+// starts a transfer, SPE in SPCR hands the pins to the peripheral, TCNT1
+// counts, a 1 written to TIFR1 clears the flag). They act as plain memory
+// until a simulator in sim/ installs hooks.
+template <class T>
+struct HostRegister {
+    T value;
+    T (*read)();
+    void (*write)(T value);
+
+    operator T() const {
+        return read ? read() : value;
+    }
+    HostRegister &operator=(T newValue) {
+        if (write) {
+            write(newValue);
+        } else {
+            value = newValue;
+        }
+        return *this;
+    }
+    HostRegister &operator=(const HostRegister &other) {
+        return *this = static_cast<T>(other);
+    }
+    HostRegister &operator|=(T bits) {
+        return *this = static_cast<T>(*this | bits);
+    }
+    HostRegister &operator&=(T bits) {
+        return *this = static_cast<T>(*this & bits);
+    }
+};
+extern HostRegister<uint8_t> TIFR1;
+extern HostRegister<uint16_t> TCNT1;
+extern HostRegister<uint8_t> SPCR;
+extern HostRegister<uint8_t> SPSR;
+extern HostRegister<uint8_t> SPDR;
+extern HostRegister<uint8_t> TWCR;
+
+#define _SFR_IO_ADDR(x) 0
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PC0 0
+#define PC4 4
+#define PC5 5
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCIF0 0
+#define PCIF1 1
+#define PCIF2 2
+#define INT0 0
+#define INT1 1
+#define INTF0 0
+#define INTF1 1
+#define ISC00 0
+#define ISC01 1
+#define ISC10 2
+#define ISC11 3
+
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define OCIE1A 1
+#define OCIE1B 2
+#define OCF1A 1
+#define OCF1B 2
+#define TOV1 0
+#define WGM20 0
+#define WGM21 1
+#define WGM22 3
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define OCIE2A 1
+#define OCIE2B 2
+#define OCF2A 1
+#define OCF2B 2
+
+#define SPE 6
+#define MSTR 4
+#define SPIE 7
+#define DORD 5
+#define CPOL 3
+#define CPHA 2
+#define SPR0 0
+#define SPR1 1
+#define SPIF 7
+#define WCOL 6
+#define SPI2X 0
+
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWEN 2
+#define TWIE 0
+#define TWPS0 0
+#define TWPS1 1
+
+#define PRTWI 7
+#define PRSPI 2
+#define E2END 1023
+#define SREG_I 7
@@ -0,0 +1,7 @@
+// Host stand-in for <avr/pgmspace.h>: flash and RAM share one address space.
+#pragma once
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t *>(address))
+#define pgm_read_word(address) (*reinterpret_cast<const uint16_t *>(address))
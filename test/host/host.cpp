@@ -0,0 +1,45 @@
+#include "host.h"
+#include <avr/eeprom.h>
+#include <avr/io.h>
+
+#define HOST_SFR(name) volatile uint8_t name;
+HOST_SFR(PINB) HOST_SFR(DDRB) HOST_SFR(PORTB)
+HOST_SFR(PINC) HOST_SFR(DDRC) HOST_SFR(PORTC)
+HOST_SFR(PIND) HOST_SFR(DDRD) HOST_SFR(PORTD)
+HOST_SFR(PCICR) HOST_SFR(PCMSK0) HOST_SFR(PCMSK1) HOST_SFR(PCMSK2) HOST_SFR(PCIFR)
+HOST_SFR(SREG) HOST_SFR(EICRA) HOST_SFR(EIMSK) HOST_SFR(EIFR)
+HOST_SFR(TCCR1A) HOST_SFR(TCCR1B) HOST_SFR(TCCR1C) HOST_SFR(TIMSK1)
+HOST_SFR(TCCR2A) HOST_SFR(TCCR2B) HOST_SFR(TIMSK2) HOST_SFR(TIFR2)
+HOST_SFR(OCR2A) HOST_SFR(OCR2B) HOST_SFR(TCNT2) HOST_SFR(GTCCR)
+HOST_SFR(TWBR) HOST_SFR(TWSR) HOST_SFR(TWDR) HOST_SFR(TWAR)
+HOST_SFR(PRR)
+#undef HOST_SFR
+volatile uint16_t OCR1A;
+volatile uint16_t OCR1B;
+volatile uint16_t ICR1;
+
+HostRegister<uint8_t> TIFR1;
+HostRegister<uint16_t> TCNT1;
+HostRegister<uint8_t> SPCR;
+HostRegister<uint8_t> SPSR;
+HostRegister<uint8_t> SPDR;
+HostRegister<uint8_t> TWCR;
+
+uint8_t hostEeprom[1024];
+
+thread_local double hostTimeUs = 0;
+thread_local void (*hostDelayHook)() = nullptr;
+int hostFailureCount = 0;
+
+static thread_local uint64_t randomState = 88172645463325252ULL;
+
+double hostRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return static_cast<double>(randomState >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void hostSeed(uint64_t seed) {
+    randomState = seed ? seed : 88172645463325252ULL;
+}
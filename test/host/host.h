@@ -0,0 +1,36 @@
+// Simulated time and helpers shared by the host tests. Time only moves when
+// the code under test waits (_delay_us/_delay_ms) or a simulator adds to it.
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+
+// Per thread, so tests can run independent simulated devices side by side
+extern thread_local double hostTimeUs;
+// Called after every delay; simulators hook in here to raise interrupts
+extern thread_local void (*hostDelayHook)();
+
+inline void hostAdvanceUs(double microseconds) {
+    hostTimeUs += microseconds;
+    if (hostDelayHook) {
+        hostDelayHook();
+    }
+}
+
+// Deterministic xorshift in [0, 1); tests reseed it for repeatable runs
+double hostRandom();
+void hostSeed(uint64_t seed);
+
+// Test reporting: EXPECT logs the failing condition and marks the run failed;
+// main() returns hostFailures() so make stops on a failing test
+extern int hostFailureCount;
+#define EXPECT(condition)                                                         \
+    do {                                                                          \
+        if (!(condition)) {                                                       \
+            printf("%s:%d: expected %s\n", __FILE__, __LINE__, #condition);       \
+            ++hostFailureCount;                                                   \
+        }                                                                         \
+    } while (0)
+inline int hostFailures() {
+    printf(hostFailureCount ? "FAIL\n" : "ok\n");
+    return hostFailureCount ? 1 : 0;
+}
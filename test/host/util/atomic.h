@@ -0,0 +1,5 @@
+// Host stand-in for <util/atomic.h>: the block body runs once.
+#pragma once
+
+#define ATOMIC_BLOCK(type) for (int hostAtomicOnce = 0; hostAtomicOnce < 1; ++hostAtomicOnce)
+#define ATOMIC_RESTORESTATE
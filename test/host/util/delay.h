@@ -0,0 +1,12 @@
+// Host stand-in for <util/delay.h>: a delay advances the simulated clock and
+// gives the attached simulators a chance to run.
+#pragma once
+#include <util/delay_basic.h>
+#include "host.h"
+
+inline void _delay_us(double microseconds) {
+    hostAdvanceUs(microseconds);
+}
+inline void _delay_ms(double milliseconds) {
+    hostAdvanceUs(milliseconds * 1000.0);
+}
@@ -0,0 +1,13 @@
+// Host stand-in for <util/delay_basic.h>: a busy loop advances the simulated
+// clock by the cycles it would burn (3 per _delay_loop_1 count, 4 per
+// _delay_loop_2 count, 0 counting as 256 or 65536) and runs the delay hook.
+#pragma once
+#include <stdint.h>
+#include "host.h"
+
+inline void _delay_loop_1(uint8_t count) {
+    hostAdvanceUs((count ? count : 256UL) * 3.0 / (F_CPU / 1000000.0));
+}
+inline void _delay_loop_2(uint16_t count) {
+    hostAdvanceUs((count ? count : 65536UL) * 4.0 / (F_CPU / 1000000.0));
+}
@@ -0,0 +1,86 @@
+// writeThenRead() and the register helpers on the hardware TWI backend, as
+// the simulated bus sees them. A register read must be START, SLA+W,
+// register, repeated START, SLA+R, data with NACK on the last byte, and a
+// single STOP: no STOP or fresh START between the write and the read, so
+// the slave's register pointer carries over. A write with nothing to read
+// ends without a repeated START; a NACK on the address or a register byte
+// stops there and reports false, and readMessage() reads on from the
+// pointer. The combined read must also be shorter on the bus than the
+// writeMessage() + readMessage() pair it replaces.
+#include <string.h>
+#include <protocol_I2C.h>
+#include "twi_sim.h"
+
+static bool check(const char *what, bool ok, const char *expected) {
+    bool traceOk = simTwiBus.trace == expected;
+    printf("%-28s %-6s %s\n", what, ok ? "true" : "false", simTwiBus.trace.c_str());
+    simTwiBus.trace.clear();
+    return traceOk;
+}
+
+int main() {
+    SimTwiSlave slave;
+    for (int i = 0; i < 256; ++i) {
+        slave.regs[i] = static_cast<uint8_t>(i ^ 0x5A);
+    }
+    simTwiBus.attach();
+    simTwiBus.addSlave(&slave);
+
+    I2C i2c(&PINC, &DDRC, &PORTC, PC4, &PINC, &DDRC, &PORTC, PC5);
+    EXPECT(i2c.setBackend(I2C::Backend::Hardware));
+    i2c.setClock(400000UL);
+
+    uint8_t data[4] = {0, 0, 0, 0};
+    bool ok = i2c.readRegisters(0x68, 0x3B, data, 3);
+    EXPECT(check("readRegisters(0x3B, 3)", ok, "S D0+ 3B+ Sr D1+ r+ r+ r- P"));
+    EXPECT(ok && data[0] == (0x3B ^ 0x5A) && data[1] == (0x3C ^ 0x5A) && data[2] == (0x3D ^ 0x5A));
+
+    uint8_t value = 0;
+    double start = hostTimeUs;
+    ok = i2c.readRegister(0x68, 0x75, value);
+    double combinedUs = hostTimeUs - start;
+    EXPECT(check("readRegister(0x75)", ok, "S D0+ 75+ Sr D1+ r- P"));
+    EXPECT(ok && value == (0x75 ^ 0x5A));
+
+    // Register pointer, one register written, then read back from there on
+    const uint8_t tx[2] = {0x10, 0xA5};
+    ok = i2c.writeThenRead(0x68, tx, 2, data, 2);
+    EXPECT(check("writeThenRead(2 out, 2 in)", ok, "S D0+ 10+ A5+ Sr D1+ r+ r- P"));
+    EXPECT(ok && slave.regs[0x10] == 0xA5 && data[0] == (0x11 ^ 0x5A) && data[1] == (0x12 ^ 0x5A));
+
+    ok = i2c.writeThenRead(0x68, tx, 2, nullptr, 0);
+    EXPECT(check("writeThenRead(2 out, 0 in)", ok, "S D0+ 10+ A5+ P"));
+    EXPECT(ok);
+
+    ok = i2c.writeRegister(0x68, 0x6B, 0x00);
+    EXPECT(check("writeRegister(0x6B)", ok, "S D0+ 6B+ 00+ P"));
+    EXPECT(ok && slave.regs[0x6B] == 0x00);
+
+    ok = i2c.readMessage(0x68, data, 2);
+    EXPECT(check("readMessage(2)", ok, "S D1+ r+ r- P"));
+    EXPECT(ok && data[0] == (0x6C ^ 0x5A) && data[1] == (0x6D ^ 0x5A));
+
+    // Failures end the transfer where they happen
+    ok = i2c.readRegister(0x50, 0x75, value);
+    EXPECT(check("readRegister, no device", ok, "S A0- P"));
+    EXPECT(!ok);
+    slave.nackAt = 0;
+    ok = i2c.readRegisters(0x68, 0x3B, data, 2);
+    EXPECT(check("readRegisters, register NACK", ok, "S D0+ 3B- P"));
+    EXPECT(!ok);
+    slave.nackAt = 1;
+    ok = i2c.writeThenRead(0x68, tx, 2, data, 2);
+    EXPECT(check("writeThenRead, data NACK", ok, "S D0+ 10+ A5- P"));
+    EXPECT(!ok);
+    slave.nackAt = -1;
+
+    // The same register read as two messages
+    start = hostTimeUs;
+    const uint8_t reg = 0x75;
+    ok = i2c.writeMessage(0x68, &reg, 1) && i2c.readMessage(0x68, &value, 1);
+    double splitUs = hostTimeUs - start;
+    EXPECT(check("writeMessage + readMessage", ok, "S D0+ 75+ P S D1+ r- P"));
+    printf("register read: %.2f us with the repeated START, %.2f us as two messages\n", combinedUs, splitUs);
+    EXPECT(combinedUs < splitUs);
+    return hostFailures();
+}
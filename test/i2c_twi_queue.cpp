@@ -0,0 +1,234 @@
+// The interrupt-driven TWI queue on the simulated peripheral. The main loop
+// submits, then only does 10 us of "other work" at a time while TWI_vect
+// runs the queue from the delay hook.
+//
+// chain: an IMU burst (write register, repeated START, read 14), a write to
+// a second device and a read-only transaction, submitted together, plus one
+// the first callback submits. All must finish in order with their data, a
+// STOP + START between each and the main loop never re-entering the driver.
+// errors: an absent address, a data byte NACKed and a bus error in the
+// middle of a chain; each ends with its status and the next transaction
+// still runs (after a bus error with a plain START, the bus being lost).
+// blocking: a blocking read from a completion callback fails instead of
+// spinning with interrupts off; once the queue is idle it works, and
+// MPU6050::startReadAllSensors() / collectAllSensors() deliver a sample.
+#include <string.h>
+#include <string>
+#include <device_MPU6050.h>
+#include "twi_sim.h"
+
+static const uint8_t IMU = 0x68;
+static const uint8_t MAG = 0x1E;
+
+struct Log {
+    I2C::Transaction *named[4];
+    std::string order;
+    I2C::Transaction *followUp;
+    I2C *bus;
+    bool blockingResult;
+};
+
+static void logDone(I2C::Transaction &t) {
+    Log *log = static_cast<Log *>(t.context);
+    char name = '?';
+    for (int i = 0; i < 4; ++i) {
+        if (log->named[i] == &t) {
+            name = static_cast<char>('A' + i);
+        }
+    }
+    log->order += name;
+    if (log->followUp) {
+        I2C::Transaction *next = log->followUp;
+        log->followUp = nullptr;
+        next->context = log;
+        log->bus->submit(*next);
+    }
+}
+
+static void name(Log &log, I2C::Transaction *a, I2C::Transaction *b, I2C::Transaction *c = nullptr,
+                 I2C::Transaction *d = nullptr) {
+    I2C::Transaction *named[4] = {a, b, c, d};
+    memcpy(log.named, named, sizeof(named));
+    log.order.clear();
+}
+
+static void tryBlocking(I2C::Transaction &t) {
+    Log *log = static_cast<Log *>(t.context);
+    uint8_t value = 0;
+    log->blockingResult = log->bus->readRegister(IMU, 0x75, value);
+}
+
+static I2C::Transaction transaction(uint8_t address, const uint8_t *tx, uint8_t txLength, uint8_t *rx,
+                                    uint8_t rxLength, void (*callback)(I2C::Transaction &), void *context) {
+    I2C::Transaction t = {address, tx, txLength, rx, rxLength, callback, context,
+                          I2C::TransactionStatus::Idle, nullptr};
+    return t;
+}
+
+// Other work in 10 us slices until the queue is idle; returns the slices
+static long work() {
+    long slices = 0;
+    while (I2C::transactionsPending() && slices < 100000) {
+        _delay_us(10);
+        ++slices;
+    }
+    _delay_us(100); // let the last STOP go out
+    return slices;
+}
+
+static void fillRamp(SimTwiSlave &slave, uint8_t from, uint8_t length, uint8_t seed) {
+    for (uint8_t i = 0; i < length; ++i) {
+        slave.regs[from + i] = static_cast<uint8_t>(seed + 3 * i);
+    }
+}
+
+static void chain(I2C &i2c, SimTwiSlave &imu, SimTwiSlave &mag) {
+    Log log = {{nullptr}, "", nullptr, &i2c, false};
+    const uint8_t burstReg = 0x3B;
+    const uint8_t magConfig[2] = {0x00, 0x70};
+    const uint8_t whoAmI = 0x75;
+    uint8_t burst[14];
+    uint8_t magData[6];
+    uint8_t id = 0;
+    fillRamp(imu, burstReg, 14, 0x10);
+    imu.regs[whoAmI] = 0x68;
+    fillRamp(mag, 0x03, 6, 0x80);
+
+    I2C::Transaction a = transaction(IMU, &burstReg, 1, burst, sizeof(burst), logDone, &log);
+    I2C::Transaction b = transaction(MAG, magConfig, 2, nullptr, 0, logDone, &log);
+    I2C::Transaction c = transaction(MAG, nullptr, 0, magData, sizeof(magData), logDone, &log);
+    I2C::Transaction d = transaction(IMU, &whoAmI, 1, &id, 1, logDone, &log);
+    name(log, &a, &b, &c, &d);
+    log.followUp = &d;
+    simTwiBus.trace.clear();
+    long interruptsBefore = simTwiBus.interrupts;
+    double start = hostTimeUs;
+    bool submitted = i2c.submit(a) && i2c.submit(b) && i2c.submit(c);
+    bool resubmit = i2c.submit(a); // still queued
+    long slices = work();
+
+    // b's write moves the magnetometer's pointer to 0x01 before c reads
+    std::string expected = "S D0+ 3B+ Sr D1+";
+    for (int i = 0; i < 13; ++i) {
+        expected += " r+";
+    }
+    expected += " r- P S 3C+ 00+ 70+ P S 3D+ r+ r+ r+ r+ r+ r- P S D0+ 75+ Sr D1+ r- P";
+    uint8_t burstExpected[14];
+    for (uint8_t i = 0; i < 14; ++i) {
+        burstExpected[i] = static_cast<uint8_t>(0x10 + 3 * i);
+    }
+    bool statusOk = a.status == I2C::TransactionStatus::Done && b.status == I2C::TransactionStatus::Done &&
+                    c.status == I2C::TransactionStatus::Done && d.status == I2C::TransactionStatus::Done;
+    bool dataOk = memcmp(burst, burstExpected, sizeof(burst)) == 0 && mag.regs[0x00] == 0x70 &&
+                  magData[0] == mag.regs[0x01] && magData[2] == 0x80 && magData[5] == 0x89 && id == 0x68;
+    printf("chain: order %s, status %s, data %s, %ld interrupts, %ld slices of main-loop work in %.0f us\n",
+           log.order.c_str(), statusOk ? "ok" : "BAD", dataOk ? "ok" : "BAD",
+           simTwiBus.interrupts - interruptsBefore, slices, hostTimeUs - start);
+    printf("       bus %s\n", simTwiBus.trace.c_str());
+    EXPECT(submitted && !resubmit);
+    EXPECT(log.order == "ABCD" && statusOk && dataOk);
+    EXPECT(simTwiBus.trace == expected);
+    // One interrupt per START and byte, and the chain's bus time (31 bytes
+    // and 10 conditions) all spent in the main loop's work
+    EXPECT(simTwiBus.interrupts - interruptsBefore == 19 + 4 + 8 + 6);
+    EXPECT(slices * 10.0 + 10.0 >= (31 * 9 + 10) * SimTwiBus::sclPeriodUs());
+}
+
+static void errors(I2C &i2c, SimTwiSlave &imu, SimTwiSlave &mag) {
+    Log log = {{nullptr}, "", nullptr, &i2c, false};
+    const uint8_t reg = 0x75;
+    const uint8_t magConfig[3] = {0x00, 0x70, 0x20};
+    uint8_t id[4] = {0, 0, 0, 0};
+    mag.nackAt = 2;
+    imu.regs[reg] = 0x68;
+
+    I2C::Transaction absent = transaction(0x50, &reg, 1, id, 1, logDone, &log);
+    I2C::Transaction afterAbsent = transaction(IMU, &reg, 1, id + 1, 1, logDone, &log);
+    I2C::Transaction nacked = transaction(MAG, magConfig, 3, nullptr, 0, logDone, &log);
+    I2C::Transaction afterNack = transaction(IMU, &reg, 1, id + 2, 1, logDone, &log);
+    name(log, &absent, &afterAbsent, &nacked, &afterNack);
+    simTwiBus.trace.clear();
+    i2c.submit(absent);
+    i2c.submit(afterAbsent);
+    i2c.submit(nacked);
+    i2c.submit(afterNack);
+    work();
+    printf("errors: absent address %s, data NACK %s, following transactions %s\n",
+           absent.status == I2C::TransactionStatus::AddressNack ? "AddressNack" : "BAD",
+           nacked.status == I2C::TransactionStatus::DataNack ? "DataNack" : "BAD",
+           afterAbsent.status == I2C::TransactionStatus::Done && afterNack.status == I2C::TransactionStatus::Done
+               ? "done" : "BAD");
+    printf("        bus %s\n", simTwiBus.trace.c_str());
+    EXPECT(absent.status == I2C::TransactionStatus::AddressNack && id[0] == 0);
+    EXPECT(nacked.status == I2C::TransactionStatus::DataNack && mag.regs[0x00] == 0x70 && mag.regs[0x01] != 0x20);
+    EXPECT(afterAbsent.status == I2C::TransactionStatus::Done && afterNack.status == I2C::TransactionStatus::Done);
+    EXPECT(id[1] == 0x68 && id[2] == 0x68 && log.order == "ABCD");
+    EXPECT(simTwiBus.trace == "S A0- P S D0+ 75+ Sr D1+ r- P S 3C+ 00+ 70+ 20- P S D0+ 75+ Sr D1+ r- P");
+    mag.nackAt = -1;
+
+    // Bus error on the address byte of the first one
+    I2C::Transaction lost = transaction(IMU, &reg, 1, id, 1, logDone, &log);
+    I2C::Transaction afterLost = transaction(IMU, &reg, 1, id + 3, 1, logDone, &log);
+    name(log, &lost, &afterLost);
+    simTwiBus.trace.clear();
+    i2c.submit(lost);
+    i2c.submit(afterLost);
+    simTwiBus.busErrorNext = true;
+    work();
+    printf("        bus error %s, next %s, bus %s\n",
+           lost.status == I2C::TransactionStatus::BusError ? "BusError" : "BAD",
+           afterLost.status == I2C::TransactionStatus::Done ? "done" : "BAD", simTwiBus.trace.c_str());
+    EXPECT(lost.status == I2C::TransactionStatus::BusError);
+    EXPECT(afterLost.status == I2C::TransactionStatus::Done && id[3] == 0x68 && log.order == "AB");
+    EXPECT(simTwiBus.trace == "S E S D0+ 75+ Sr D1+ r- P");
+}
+
+static void blocking(MPU6050 &mpu, I2C &i2c, SimTwiSlave &imu) {
+    Log log = {{nullptr}, "", nullptr, &i2c, true};
+    const uint8_t reg = 0x75;
+    uint8_t id = 0;
+    SREG = 0; // as inside the ISR
+    I2C::Transaction t = transaction(IMU, &reg, 1, &id, 1, tryBlocking, &log);
+    i2c.submit(t);
+    work();
+    uint8_t later = 0;
+    bool afterwards = i2c.readRegister(IMU, reg, later);
+
+    // MPU6050's own queued burst
+    fillRamp(imu, 0x3B, 14, 0x01);
+    MPU6050::MPU6050_Fixed sample;
+    bool started = mpu.startReadAllSensors();
+    bool early = mpu.collectAllSensors(sample);
+    work();
+    bool collected = mpu.collectAllSensors(sample);
+    bool again = mpu.collectAllSensors(sample);
+    printf("blocking: from a callback %s, afterwards %s; MPU6050 async read: started %s, collected %s\n",
+           log.blockingResult ? "RAN" : "refused", afterwards && later == 0x68 ? "ok" : "BAD",
+           started ? "yes" : "no", collected && !early && !again ? "once" : "BAD");
+    EXPECT(!log.blockingResult && t.status == I2C::TransactionStatus::Done && id == 0x68);
+    EXPECT(afterwards && later == 0x68);
+    EXPECT(started && !early && collected && !again);
+    EXPECT(sample.accel_x != 0 && !I2C::transactionsPending());
+}
+
+int main() {
+    SimTwiSlave imu;
+    SimTwiSlave mag;
+    mag.address = MAG;
+    simTwiBus.attach();
+    simTwiBus.addSlave(&imu);
+    simTwiBus.addSlave(&mag);
+
+    MPU6050 mpu(&PINC, &DDRC, &PORTC, PC4, &PINC, &DDRC, &PORTC, PC5);
+    I2C i2c(&PINC, &DDRC, &PORTC, PC4, &PINC, &DDRC, &PORTC, PC5);
+    I2C::Transaction early = transaction(IMU, nullptr, 0, nullptr, 0, nullptr, nullptr);
+    EXPECT(!i2c.submit(early)); // software backend
+    EXPECT(i2c.setBackend(I2C::Backend::Hardware) && mpu.setBackend(I2C::Backend::Hardware));
+    i2c.setClock(400000UL);
+    mpu.setClock(400000UL);
+
+    chain(i2c, imu, mag);
+    errors(i2c, imu, mag);
+    blocking(mpu, i2c, imu);
+    return hostFailures();
+}
@@ -0,0 +1,93 @@
+// MPU6050 on the hardware TWI backend: the real protocol_I2C.cpp driving the
+// simulated TWI peripheral, with a register-file slave at 0x68. initialize()
+// and every readAllSensors() must put the expected conditions and bytes on
+// the bus (one repeated START, ACK on all but the last byte, one STOP), and
+// the 14-byte burst must decode to the values in the sample registers.
+//
+// Then the benchmark from the backend's request: back-to-back
+// readAllSensors() for one simulated second at 100 kHz and 400 kHz. A read
+// is 156 SCL periods on the bus (START, three address/register bytes,
+// repeated START, 14 data bytes, STOP at 9 periods a byte), so 400 kHz must
+// give just under four times the 100 kHz rate.
+#include <math.h>
+#include <string>
+#include <device_MPU6050.h>
+#include "twi_sim.h"
+
+static const uint8_t REG_ACCEL_CONFIG = 0x1C;
+static const uint8_t REG_ACCEL_XOUT_H = 0x3B;
+static const uint8_t REG_PWR_MGMT_1 = 0x6B;
+static const double READ_PERIODS = 156;
+
+static std::string burstTrace() {
+    std::string expected = "S D0+ 3B+ Sr D1+";
+    for (int i = 0; i < 13; ++i) {
+        expected += " r+";
+    }
+    return expected + " r- P";
+}
+
+static void setWord(SimTwiSlave &slave, uint8_t reg, int16_t value) {
+    slave.regs[reg] = static_cast<uint8_t>(static_cast<uint16_t>(value) >> 8);
+    slave.regs[reg + 1] = static_cast<uint8_t>(value & 0xFF);
+}
+
+static double measure(MPU6050 &imu, uint32_t hz, uint8_t twbr) {
+    imu.setClock(hz);
+    MPU6050::MPU6050_Data data;
+    simTwiBus.trace.clear();
+    bool first = imu.readAllSensors(data);
+    bool traceOk = simTwiBus.trace == burstTrace();
+    bool dataOk = fabs(data.accel_x - 1.0f) < 1e-4f && fabs(data.accel_y + 0.5f) < 1e-4f &&
+                  fabs(data.accel_z - 0.25f) < 1e-4f && fabs(data.gyro_x - 1.0f) < 1e-3f &&
+                  fabs(data.gyro_y + 2.0f) < 1e-3f && fabs(data.gyro_z - 100.0f) < 1e-3f;
+
+    long samples = 0;
+    long failures = 0;
+    double start = hostTimeUs;
+    while (hostTimeUs - start < 1000000.0) {
+        simTwiBus.trace.clear();
+        if (imu.readAllSensors(data)) {
+            ++samples;
+        } else {
+            ++failures;
+        }
+    }
+    double usPerRead = (hostTimeUs - start) / (samples + failures);
+    double busUs = READ_PERIODS * SimTwiBus::sclPeriodUs();
+    printf("TWI %3lu kHz: TWBR %u, SCL %.1f kHz, %ld samples/s, %ld failed, %.1f us per read (%.1f us on the bus)\n",
+           static_cast<unsigned long>(hz / 1000), TWBR, 1000.0 / SimTwiBus::sclPeriodUs(), samples, failures,
+           usPerRead, busUs);
+    EXPECT(first && traceOk && dataOk);
+    EXPECT(TWBR == twbr && failures == 0);
+    // Polling TWINT adds at most one poll per condition or byte
+    EXPECT(usPerRead >= busUs && usPerRead < busUs + 20 * simTwiBus.pollCycles / 16.0);
+    return samples;
+}
+
+int main() {
+    SimTwiSlave sensor;
+    sensor.regs[REG_PWR_MGMT_1] = 0x40; // asleep after reset
+    sensor.regs[REG_ACCEL_CONFIG] = 0x08; // ±4g: 8192 counts per g
+    setWord(sensor, REG_ACCEL_XOUT_H, 8192);
+    setWord(sensor, REG_ACCEL_XOUT_H + 2, -4096);
+    setWord(sensor, REG_ACCEL_XOUT_H + 4, 2048);
+    setWord(sensor, REG_ACCEL_XOUT_H + 8, 131);
+    setWord(sensor, REG_ACCEL_XOUT_H + 10, -262);
+    setWord(sensor, REG_ACCEL_XOUT_H + 12, 13100);
+    simTwiBus.attach();
+    simTwiBus.addSlave(&sensor);
+
+    MPU6050 imu(&PINC, &DDRC, &PORTC, PC4, &PINC, &DDRC, &PORTC, PC5);
+    EXPECT(imu.setBackend(I2C::Backend::Hardware));
+    bool initialized = imu.initialize();
+    printf("initialize(): %s, bus %s\n", initialized ? "ok" : "FAILED", simTwiBus.trace.c_str());
+    EXPECT(initialized && sensor.regs[REG_PWR_MGMT_1] == 0x00);
+    EXPECT(simTwiBus.trace == "S D0+ 6B+ 00+ P S D0+ 1C+ Sr D1+ r- P S D0+ 1B+ Sr D1+ r- P");
+
+    double slow = measure(imu, 100000UL, 72);
+    double fast = measure(imu, 400000UL, 12);
+    printf("400 kHz gives %.2fx the 100 kHz sample rate\n", fast / slow);
+    EXPECT(fast / slow > 3.8 && fast / slow < 4.0);
+    return hostFailures();
+}
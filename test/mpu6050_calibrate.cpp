@@ -0,0 +1,165 @@
+// MPU6050::calibrate() against the simulated sensor lying still with a
+// bias on every axis and factory values in its offset registers. For each
+// accel/gyro range calibrate() must move the offset registers so the mean
+// reading is 0 (1 g on Z) to within half an offset register step at that
+// range and the rounding of its mean, which only holds if the bias is
+// converted to the registers' ±16g / ±1000°/s scale correctly, and must
+// leave the reserved bit 0 of the accel offsets as the sensor had it, as
+// must writeOffsets().
+//
+// saveOffsets() / restoreOffsets(): after a power cycle (factory values
+// back) a saved record restores the calibrated registers; a record with a
+// flipped data byte, a bad checksum or no marker must be refused without
+// touching the sensor.
+#include <math.h>
+#include <string.h>
+#include <avr/eeprom.h>
+#include "mpu6050_sim.h"
+
+static const uint8_t REG_XA_OFFS_H = 0x06;
+static const uint8_t REG_XG_OFFS_USRH = 0x13;
+static const int16_t FACTORY_ACCEL[3] = {-2301, 1450, 1201}; // bit 0: 1, 0, 1
+static const int16_t FACTORY_GYRO[3] = {12, -7, 3};
+static const uint16_t RECORD = 16;
+
+static void setWord(uint8_t reg, int16_t value) {
+    simMpu.regs[reg] = static_cast<uint8_t>(static_cast<uint16_t>(value) >> 8);
+    simMpu.regs[reg + 1] = static_cast<uint8_t>(value & 0xFF);
+}
+
+static int16_t word(uint8_t reg) {
+    return static_cast<int16_t>((simMpu.regs[reg] << 8) | simMpu.regs[reg + 1]);
+}
+
+static void factoryOffsets() {
+    for (int axis = 0; axis < 3; ++axis) {
+        setWord(static_cast<uint8_t>(REG_XA_OFFS_H + 2 * axis), FACTORY_ACCEL[axis]);
+        setWord(static_cast<uint8_t>(REG_XG_OFFS_USRH + 2 * axis), FACTORY_GYRO[axis]);
+    }
+}
+
+// Mean accel and gyro counts over samples the sensor produces, off the bus
+static void mean(double *values, int samples) {
+    memset(values, 0, 6 * sizeof(double));
+    for (int i = 0; i < samples; ++i) {
+        hostTimeUs += 1000;
+        simMpu.advance();
+        for (int axis = 0; axis < 3; ++axis) {
+            values[axis] += word(static_cast<uint8_t>(0x3B + 2 * axis));
+            values[3 + axis] += word(static_cast<uint8_t>(0x43 + 2 * axis));
+        }
+    }
+    for (int axis = 0; axis < 6; ++axis) {
+        values[axis] /= samples;
+    }
+}
+
+static bool sameOffsets(const int16_t *accel, const int16_t *gyro) {
+    for (int axis = 0; axis < 3; ++axis) {
+        if (word(static_cast<uint8_t>(REG_XA_OFFS_H + 2 * axis)) != accel[axis] ||
+            word(static_cast<uint8_t>(REG_XG_OFFS_USRH + 2 * axis)) != gyro[axis]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void calibrateAt(int accelRange, int gyroRange, int16_t *accel, int16_t *gyro) {
+    simMpu = SimMpu6050();
+    simMpu.still = true;
+    simMpu.noise = 6;
+    const int16_t accelBias[3] = {2401, -1310, -1101}; // factory offsets leave 100, 140, 100
+    const int16_t gyroBias[3] = {-52, 32, 87};
+    memcpy(simMpu.accelBias, accelBias, sizeof(accelBias));
+    memcpy(simMpu.gyroBias, gyroBias, sizeof(gyroBias));
+    factoryOffsets();
+
+    MPU6050 imu(&PINC, &DDRC, &PORTC, 4, &PINC, &DDRC, &PORTC, 5);
+    EXPECT(imu.initialize() && imu.setAccelRange(accelRange) && imu.setGyroRange(gyroRange));
+    double before[6];
+    mean(before, 500);
+    bool ok = imu.calibrate(200);
+    double after[6];
+    mean(after, 2000);
+
+    // One offset register step at this range: 2 ±16g counts (bit 0 is
+    // reserved) for accel, 1 ±1000°/s count for gyro. calibrate() can leave
+    // half a step, plus up to a count from its truncated mean and the noise
+    double accelStep = 2 << (3 - accelRange);
+    double gyroStep = 4.0 / (1 << gyroRange);
+    double gravity = 16384 >> accelRange;
+    double accelWorst = 0;
+    double gyroWorst = 0;
+    bool bitsKept = true;
+    for (int axis = 0; axis < 3; ++axis) {
+        double a = fabs(after[axis] - (axis == 2 ? gravity : 0));
+        double g = fabs(after[3 + axis]);
+        accelWorst = a > accelWorst ? a : accelWorst;
+        gyroWorst = g > gyroWorst ? g : gyroWorst;
+        accel[axis] = word(static_cast<uint8_t>(REG_XA_OFFS_H + 2 * axis));
+        gyro[axis] = word(static_cast<uint8_t>(REG_XG_OFFS_USRH + 2 * axis));
+        bitsKept = bitsKept && (accel[axis] & 1) == (FACTORY_ACCEL[axis] & 1);
+    }
+    printf("accel ±%2dg, gyro ±%4d°/s: accel X before %7.1f after %5.2f counts (worst %5.2f, step %3.0f), "
+           "gyro Z before %6.1f after %5.2f (worst %5.2f, step %.1f), bit 0 %s\n",
+           2 << accelRange, 250 << gyroRange, before[0], after[0], accelWorst, accelStep, before[5], after[5],
+           gyroWorst, gyroStep, bitsKept ? "kept" : "CHANGED");
+    EXPECT(ok);
+    EXPECT(fabs(before[0]) > 10 * accelStep && fabs(before[5]) > 10 * gyroStep);
+    EXPECT(accelWorst <= accelStep / 2 + 1.5 && gyroWorst <= gyroStep / 2 + 1.5);
+    EXPECT(bitsKept);
+}
+
+// writeOffsets() with bit 0 the other way round must not change it
+static void reservedBit() {
+    factoryOffsets();
+    MPU6050 imu(&PINC, &DDRC, &PORTC, 4, &PINC, &DDRC, &PORTC, 5);
+    MPU6050::Offsets offsets = {-2310, 1451, 1210, 5, 6, 7};
+    bool written = imu.writeOffsets(offsets);
+    const int16_t accel[3] = {-2309, 1450, 1211};
+    const int16_t gyro[3] = {5, 6, 7};
+    bool kept = sameOffsets(accel, gyro);
+    printf("writeOffsets() with bit 0 flipped: %s\n", written && kept ? "bit 0 kept, rest written" : "BAD");
+    EXPECT(written && kept);
+}
+
+static void eepromRecord(const int16_t *accel, const int16_t *gyro) {
+    MPU6050 imu(&PINC, &DDRC, &PORTC, 4, &PINC, &DDRC, &PORTC, 5);
+    memset(hostEeprom, 0xFF, sizeof(hostEeprom));
+    bool saved = imu.saveOffsets(RECORD);
+    uint8_t record[14];
+    memcpy(record, &hostEeprom[RECORD], sizeof(record));
+
+    factoryOffsets(); // power cycle
+    bool restored = imu.restoreOffsets(RECORD) && sameOffsets(accel, gyro);
+
+    // Each bad record leaves the factory values in place
+    const char *names[3] = {"flipped data bit", "bad checksum", "no marker"};
+    const int bytes[3] = {5, 13, 0};
+    bool refused[3];
+    for (int i = 0; i < 3; ++i) {
+        memcpy(&hostEeprom[RECORD], record, sizeof(record));
+        hostEeprom[RECORD + bytes[i]] ^= 0x10;
+        factoryOffsets();
+        refused[i] = !imu.restoreOffsets(RECORD) && sameOffsets(FACTORY_ACCEL, FACTORY_GYRO);
+        printf("EEPROM record with %-16s %s\n", names[i], refused[i] ? "refused" : "ACCEPTED");
+        EXPECT(refused[i]);
+    }
+    bool blank = !imu.restoreOffsets(200) && sameOffsets(FACTORY_ACCEL, FACTORY_GYRO);
+    printf("EEPROM record saved %s, restored after power cycle %s, blank EEPROM %s\n", saved ? "ok" : "FAILED",
+           restored ? "ok" : "BAD", blank ? "refused" : "ACCEPTED");
+    EXPECT(saved && restored && blank);
+}
+
+int main() {
+    hostSeed(24);
+    int16_t accel[3];
+    int16_t gyro[3];
+    for (int range = 0; range < 4; ++range) {
+        calibrateAt(range, 3 - range, accel, gyro);
+    }
+    calibrateAt(1, 1, accel, gyro);
+    eepromRecord(accel, gyro);
+    reservedBit();
+    return hostFailures();
+}
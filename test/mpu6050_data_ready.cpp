@@ -0,0 +1,100 @@
+// MPU6050 data-ready interrupt at 500 Hz against the simulated sensor: the
+// INT pulse lands on INT0 and the main loop reads one sample per pulse
+// with readReadySample(), between 0 and 1.2 ms of other work. Every sample
+// the sensor produces must be delivered once, none reported skipped.
+#include <protocol_ExtInt.h>
+#include "mpu6050_sim.h"
+
+struct Delivery {
+    uint32_t produced;
+    long delivered;
+    long duplicates;
+    long missed;
+    long corrupt;
+    uint16_t skipped;
+};
+
+// Time passes in 5 us steps so the sensor samples, and pulses, on time
+static void work(double microseconds) {
+    double end = hostTimeUs + microseconds;
+    while (hostTimeUs < end) {
+        hostTimeUs += 5;
+        simMpu.advance();
+    }
+}
+
+static Delivery run(double stallChance, double stallMaxMs) {
+    simMpu = SimMpu6050();
+    simMpu.onInterrupt = [] { ExtInt::dispatch(ExtInt::Line::Int0); };
+    hostSeed(9);
+    MPU6050 imu(&PINC, &DDRC, &PORTC, 4, &PINC, &DDRC, &PORTC, 5, &PIND, &DDRD, &PORTD, 2);
+    imu.setClock(400000);
+    EXPECT(imu.initialize());
+    EXPECT(imu.setDigitalLowPass(1));
+    EXPECT(imu.setSampleRate(500));
+    EXPECT(imu.enableInterrupt());
+
+    Delivery d = {0, 0, 0, 0, 0, 0};
+    uint32_t last = 0;
+    bool first = true;
+    double start = hostTimeUs;
+    uint32_t firstCounter = simMpu.counter;
+    while (hostTimeUs - start < 10e6) {
+        while (!imu.dataReady()) {
+            work(5);
+        }
+        MPU6050::RawSample sample;
+        if (imu.readReadySample(sample)) {
+            uint32_t counter;
+            if (!SimMpu6050::decode(sample, counter)) {
+                ++d.corrupt;
+            } else {
+                if (!first) {
+                    if (counter <= last) {
+                        ++d.duplicates;
+                    } else {
+                        d.missed += counter - last - 1;
+                    }
+                }
+                first = false;
+                last = counter;
+                ++d.delivered;
+            }
+        }
+
+        double workUs = hostRandom() * 1200;
+        if (hostRandom() < stallChance) {
+            workUs = stallMaxMs * 1000 * hostRandom();
+        }
+        work(workUs);
+    }
+    d.produced = simMpu.counter - firstCounter;
+    d.skipped = imu.skippedSamples();
+    return d;
+}
+
+static void report(const char *name, const Delivery &d) {
+    printf("%-32s produced %u delivered %ld duplicates %ld missed %ld corrupt %ld skippedSamples() %u\n", name,
+           d.produced, d.delivered, d.duplicates, d.missed, d.corrupt, d.skipped);
+}
+
+int main() {
+    Delivery d = run(0, 0);
+    report("500 Hz, 0-1.2 ms of work", d);
+    EXPECT(d.duplicates == 0);
+    EXPECT(d.skipped == 0);
+    EXPECT(d.missed == 0);
+    EXPECT(d.corrupt == 0);
+    EXPECT(d.delivered + 1 >= static_cast<long>(d.produced));
+
+    // 20 ms stalls on 2% of passes: samples are lost, and the driver must
+    // account for each one rather than repeat the last
+    d = run(0.02, 20);
+    report("plus stalls up to 20 ms", d);
+    EXPECT(d.duplicates == 0);
+    EXPECT(d.corrupt == 0);
+    EXPECT(d.missed > 0);
+    EXPECT(d.skipped == d.missed);
+
+    return hostFailures();
+}
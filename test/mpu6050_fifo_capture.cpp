@@ -0,0 +1,97 @@
+// MPU6050 FIFO capture at 1 kHz against the simulated sensor, with a main
+// loop that drains every 10 ms but now and then stalls (a blocking command
+// to another device). Every sample must arrive exactly once while the
+// FIFO keeps up; once it overflows, the driver must notice, reset and
+// never hand out a torn frame.
+#include "mpu6050_sim.h"
+
+struct Capture {
+    long samples;
+    long lost;
+    long gapEvents;
+    long repeated;
+    long corrupt;
+    uint16_t overflows;
+    double seconds;
+};
+
+static Capture run(uint32_t busHz, double stallChance, double stallMaxMs) {
+    simMpu = SimMpu6050();
+    hostSeed(5);
+    MPU6050 imu(&PINC, &DDRC, &PORTC, 4, &PINC, &DDRC, &PORTC, 5);
+    imu.setClock(busHz);
+    EXPECT(imu.initialize());
+    EXPECT(imu.setDigitalLowPass(1));
+    EXPECT(imu.setSampleRate(1000));
+
+    static MPU6050::RawSample storage[128];
+    MPU6050::SampleRing ring = {storage, 128, 0, 0};
+    EXPECT(imu.startFifo());
+
+    Capture capture = {0, 0, 0, 0, 0, 0, 0};
+    uint32_t last = 0;
+    bool first = true;
+    double start = hostTimeUs;
+    while (hostTimeUs - start < 10e6) {
+        imu.drainFifo(ring);
+        MPU6050::RawSample sample;
+        while (ring.pop(sample)) {
+            uint32_t counter;
+            if (!SimMpu6050::decode(sample, counter)) {
+                ++capture.corrupt;
+                continue;
+            }
+            if (!first) {
+                if (counter <= last) {
+                    ++capture.repeated;
+                } else if (counter != last + 1) {
+                    ++capture.gapEvents;
+                    capture.lost += counter - last - 1;
+                }
+            }
+            first = false;
+            last = counter;
+            ++capture.samples;
+        }
+
+        double workUs = hostRandom() < stallChance ? stallMaxMs * 1000 * hostRandom() : 10000;
+        hostTimeUs += workUs;
+    }
+    capture.seconds = (hostTimeUs - start) / 1e6;
+    capture.overflows = imu.fifoOverflows();
+    return capture;
+}
+
+static void report(const char *name, const Capture &c) {
+    printf("%-34s %4.0f samples/s  lost %5ld (%ld gaps)  repeated %ld  corrupt %ld  overflows %u\n", name,
+           c.samples / c.seconds, c.lost, c.gapEvents, c.repeated, c.corrupt, c.overflows);
+}
+
+int main() {
+    Capture c = run(400000, 0.1, 40);
+    report("400 kHz, stalls up to 40 ms", c);
+    EXPECT(c.lost == 0);
+    EXPECT(c.repeated == 0);
+    EXPECT(c.corrupt == 0);
+    EXPECT(c.overflows == 0);
+    EXPECT(c.samples / c.seconds > 990);
+
+    // 85 ms of frames fit: longer stalls overflow. Each one must be seen
+    // and cost a gap, never a duplicate or a torn frame.
+    c = run(400000, 0.1, 120);
+    report("400 kHz, stalls up to 120 ms", c);
+    EXPECT(c.overflows > 0);
+    EXPECT(c.gapEvents <= c.overflows);
+    EXPECT(c.repeated == 0);
+    EXPECT(c.corrupt == 0);
+
+    // A bus slower than the fill rate: the FIFO can't be kept up with
+    c = run(100000, 0.1, 40);
+    report("100 kHz, stalls up to 40 ms", c);
+    EXPECT(c.overflows > 0);
+    EXPECT(c.gapEvents <= c.overflows);
+    EXPECT(c.repeated == 0);
+    EXPECT(c.corrupt == 0);
+
+    return hostFailures();
+}
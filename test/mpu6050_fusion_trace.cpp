@@ -0,0 +1,175 @@
+// MPU6050Fusion against a double-precision Mahony filter with the same
+// gains, both fed the trace in data/mpu6050_trace200.csv (raw samples at
+// 200 Hz, ±2 g / ±250 °/s, one "ax,ay,az,gx,gy,gz" line each, '#' lines are
+// comments). The trace is synthetic, not recorded: 60 °/s motion integrated
+// finely, with noise and quantization. It runs twice: proportional only, and
+// with Ki 0.1 and a 0.5 °/s gyro bias added, so the integral term has
+// something to take out. Once both have settled, the fixed-point Euler
+// angles must stay within 0.07° of the reference, and the atan2 building
+// block within 0.014° of the library one.
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include <device_MPU6050Fusion.h>
+#include "host.h"
+
+static const uint16_t RATE_HZ = 200;
+static const double SETTLE_S = 5;
+
+// Same update as the library: q += q * (0, h), h = gyro * dt / 2 plus the
+// gravity error scaled by Kp * dt / 2 and its integral (Ki * dt^2 / 2 per
+// step), then renormalized
+struct Reference {
+    double q[4];
+    double integral[3];
+    double dt;
+    double kp;
+    double ki;
+
+    void update(const double *gyro, const double *accel) {
+        double h[3] = {gyro[0] * dt / 2, gyro[1] * dt / 2, gyro[2] * dt / 2};
+        double n = sqrt(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+        if (n > 0) {
+            double ax = accel[0] / n, ay = accel[1] / n, az = accel[2] / n;
+            double vx = 2 * (q[1] * q[3] - q[0] * q[2]);
+            double vy = 2 * (q[0] * q[1] + q[2] * q[3]);
+            double vz = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+            double e[3] = {ay * vz - az * vy, az * vx - ax * vz, ax * vy - ay * vx};
+            for (int i = 0; i < 3; ++i) {
+                integral[i] += ki * e[i] * dt * dt / 2;
+                h[i] += kp * e[i] * dt / 2 + integral[i];
+            }
+        }
+        double q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+        q[0] += -q1 * h[0] - q2 * h[1] - q3 * h[2];
+        q[1] += q0 * h[0] + q2 * h[2] - q3 * h[1];
+        q[2] += q0 * h[1] - q1 * h[2] + q3 * h[0];
+        q[3] += q0 * h[2] + q1 * h[1] - q2 * h[0];
+        double length = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        for (int i = 0; i < 4; ++i) {
+            q[i] /= length;
+        }
+    }
+
+    void euler(double *angles) const {
+        angles[0] = atan2(2 * (q[2] * q[3] + q[0] * q[1]), q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3]);
+        double s = -2 * (q[1] * q[3] - q[0] * q[2]);
+        angles[1] = asin(s > 1 ? 1 : s < -1 ? -1 : s);
+        angles[2] = atan2(2 * (q[1] * q[2] + q[0] * q[3]), q[0] * q[0] + q[1] * q[1] - q[2] * q[2] - q[3] * q[3]);
+        for (int i = 0; i < 3; ++i) {
+            angles[i] *= 180 / M_PI;
+        }
+    }
+};
+
+static double wrap(double degrees) {
+    while (degrees > 180) {
+        degrees -= 360;
+    }
+    while (degrees < -180) {
+        degrees += 360;
+    }
+    return degrees;
+}
+
+static bool loadTrace(const char *path, std::vector<MPU6050::RawSample> &trace) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        int v[6];
+        if (line[0] == '#' || sscanf(line, "%d,%d,%d,%d,%d,%d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 6) {
+            continue;
+        }
+        MPU6050::RawSample sample;
+        sample.accel_x = static_cast<int16_t>(v[0]);
+        sample.accel_y = static_cast<int16_t>(v[1]);
+        sample.accel_z = static_cast<int16_t>(v[2]);
+        sample.gyro_x = static_cast<int16_t>(v[3]);
+        sample.gyro_y = static_cast<int16_t>(v[4]);
+        sample.gyro_z = static_cast<int16_t>(v[5]);
+        trace.push_back(sample);
+    }
+    fclose(file);
+    return true;
+}
+
+static void checkAtan2() {
+    double worst = 0;
+    for (int y = -32767; y <= 32767; y += 97) {
+        for (int x = -32767; x <= 32767; x += 89) {
+            double exact = atan2(static_cast<double>(y), static_cast<double>(x)) * 180 / M_PI;
+            double error = fabs(wrap(MPU6050Fusion::atan2Centi(static_cast<int16_t>(y), static_cast<int16_t>(x)) / 100.0 - exact));
+            worst = fmax(worst, error);
+        }
+    }
+    printf("atan2Centi max error %.4f°\n", worst);
+    EXPECT(worst <= 0.014);
+}
+
+static void checkTrace(const std::vector<MPU6050::RawSample> &trace, uint16_t kiMilli, int16_t gyroBias) {
+    MPU6050Fusion fusion;
+    EXPECT(fusion.begin(RATE_HZ, 0));
+    EXPECT(fusion.setGains(1000, kiMilli));
+    Reference reference = {{1, 0, 0, 0}, {0, 0, 0}, 1.0 / RATE_HZ, 1.0, kiMilli / 1000.0};
+
+    double worst[3] = {0, 0, 0};
+    double squares[3] = {0, 0, 0};
+    long compared[3] = {0, 0, 0};
+    for (size_t k = 0; k < trace.size(); ++k) {
+        MPU6050::RawSample sample = trace[k];
+        sample.gyro_x = static_cast<int16_t>(sample.gyro_x + gyroBias);
+        sample.gyro_y = static_cast<int16_t>(sample.gyro_y - gyroBias);
+        sample.gyro_z = static_cast<int16_t>(sample.gyro_z + gyroBias);
+        fusion.update(sample);
+        // 131 counts per °/s at ±250 °/s
+        double gyro[3] = {sample.gyro_x / 131.0 * M_PI / 180, sample.gyro_y / 131.0 * M_PI / 180, sample.gyro_z / 131.0 * M_PI / 180};
+        double accel[3] = {static_cast<double>(sample.accel_x), static_cast<double>(sample.accel_y), static_cast<double>(sample.accel_z)};
+        reference.update(gyro, accel);
+        if (k < SETTLE_S * RATE_HZ) {
+            continue;
+        }
+
+        int16_t roll, pitch, yaw;
+        fusion.getEulerAngles(roll, pitch, yaw);
+        double fixed[3] = {roll / 100.0, pitch / 100.0, yaw / 100.0};
+        double exact[3];
+        reference.euler(exact);
+        for (int axis = 0; axis < 3; ++axis) {
+            // Roll and yaw are undefined at gimbal lock
+            if (axis != 1 && fabs(exact[1]) > 85) {
+                continue;
+            }
+            double error = fabs(wrap(fixed[axis] - exact[axis]));
+            worst[axis] = fmax(worst[axis], error);
+            squares[axis] += error * error;
+            ++compared[axis];
+        }
+    }
+
+    static const char *const NAMES[3] = {"roll", "pitch", "yaw"};
+    for (int axis = 0; axis < 3; ++axis) {
+        double rms = compared[axis] ? sqrt(squares[axis] / compared[axis]) : 0;
+        printf("Ki %.1f, bias %3d: %-5s fixed vs double: max %.4f°, rms %.4f° over %ld samples\n", kiMilli / 1000.0,
+               gyroBias, NAMES[axis], worst[axis], rms, compared[axis]);
+        EXPECT(compared[axis] > 0);
+        EXPECT(worst[axis] <= 0.07);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : TEST_DATA_DIR "/mpu6050_trace200.csv";
+    std::vector<MPU6050::RawSample> trace;
+    EXPECT(loadTrace(path, trace));
+    EXPECT(trace.size() > SETTLE_S * RATE_HZ);
+
+    checkAtan2();
+    if (!trace.empty()) {
+        printf("%zu samples from %s\n", trace.size(), path);
+        checkTrace(trace, 0, 0);
+        checkTrace(trace, 100, 66); // 0.5 °/s at 131 counts per °/s
+    }
+    return hostFailures();
+}
@@ -0,0 +1,112 @@
+// Fixed vs adaptive retransmit settings on a simulated 2 Mbps link: a
+// write() loop runs for 2 s of simulated time per case and the delivered
+// and failed packets per second are compared.
+#include "nrf24_air.h"
+
+enum class Retries : uint8_t { Default, Short, Adaptive };
+
+struct Result {
+    double delivered;
+    double failed;
+};
+
+static NRF24 *receiver;
+static double drainPeriodUs;
+static double nextDrainUs;
+
+static void drainReceiver() {
+    uint8_t payload[32];
+    while (receiver->read(payload, 32)) {
+    }
+}
+
+static void drainOnSchedule() {
+    if (hostTimeUs >= nextDrainUs) {
+        drainReceiver();
+        nextDrainUs = hostTimeUs + drainPeriodUs;
+    }
+}
+
+// loss: per-attempt loss rate; drainMs: 0 drains the receiver on every
+// packet, otherwise the receiving application only reads that often
+static Result run(Retries retries, double loss, double drainMs) {
+    airReset();
+    hostSeed(7);
+    NRF24 tx = SIM_NRF24(7);
+    NRF24 rx = SIM_NRF24(6);
+    receiver = &rx;
+
+    const uint8_t address[5] = {'N', 'R', 'F', '2', '4'};
+    tx.begin(true, 76, 32);
+    rx.begin(true, 76, 32);
+    tx.setDataRate(NRF24::DataRate::Rate2Mbps);
+    rx.setDataRate(NRF24::DataRate::Rate2Mbps);
+    tx.openWritingPipe(address, 5);
+    rx.openReadingPipe(0, address, 5);
+    rx.startListening();
+    tx.stopListening();
+    if (retries == Retries::Short) {
+        tx.setRetries(250, 15);
+    } else if (retries == Retries::Adaptive) {
+        tx.setAdaptiveRetries(true);
+    }
+
+    airLoss = [loss](uint8_t, int) { return loss; };
+    if (drainMs == 0) {
+        airRadios[1]->service = drainReceiver;
+    } else {
+        drainPeriodUs = drainMs * 1000.0;
+        nextDrainUs = hostTimeUs;
+        airTick = drainOnSchedule;
+    }
+
+    uint8_t payload[32] = {0};
+    long delivered = 0;
+    long failed = 0;
+    double start = hostTimeUs;
+    while (hostTimeUs - start < 2e6) {
+        ++payload[0];
+        if (tx.write(payload, 32)) {
+            ++delivered;
+        } else {
+            ++failed;
+        }
+        if (drainMs != 0) {
+            drainOnSchedule();
+        }
+    }
+    Result result = {delivered / 2.0, failed / 2.0};
+    return result;
+}
+
+static void compare(const char *name, double loss, double drainMs, Result out[3]) {
+    out[0] = run(Retries::Default, loss, drainMs);
+    out[1] = run(Retries::Short, loss, drainMs);
+    out[2] = run(Retries::Adaptive, loss, drainMs);
+    printf("%-28s %6.0f (%3.0f)  %6.0f (%3.0f)  %6.0f (%3.0f)\n", name, out[0].delivered, out[0].failed,
+           out[1].delivered, out[1].failed, out[2].delivered, out[2].failed);
+}
+
+int main() {
+    printf("delivered/s (failed/s)        1250x15       250x15        adaptive\n");
+    Result r[3];
+
+    static const double losses[] = {0.1, 0.3, 0.5};
+    for (double loss : losses) {
+        char name[32];
+        snprintf(name, sizeof(name), "random loss %.0f%%", loss * 100);
+        compare(name, loss, 0, r);
+        // Adaptive finds the short delay on a lossy but responsive link
+        EXPECT(r[2].delivered > r[0].delivered * 1.1);
+        EXPECT(r[2].delivered > r[1].delivered * 0.95);
+    }
+
+    // A receiver that reads every 12 ms fills its FIFO: short fixed delays
+    // run out of retries, adaptive backs off instead of failing
+    compare("receiver drains every 12 ms", 0, 12, r);
+    EXPECT(r[1].failed > 0);
+    EXPECT(r[2].failed == 0);
+    EXPECT(r[2].delivered > r[1].delivered);
+
+    return hostFailures();
+}
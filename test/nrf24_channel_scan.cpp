@@ -0,0 +1,64 @@
+// scanChannels() against a simulated band, and what it leaves behind: the
+// channel, listening or power-down state, and packets already received.
+#include "nrf24_air.h"
+
+static bool busy(uint8_t channel) {
+    // Wi-Fi 1/6/11 (22 MHz wide) busy 60/40/50%, a narrow carrier on 95,
+    // 2% background elsewhere
+    double p = 0.02;
+    if (channel >= 1 && channel <= 23) {
+        p = 0.6;
+    } else if (channel >= 26 && channel <= 48) {
+        p = 0.4;
+    } else if (channel >= 51 && channel <= 73) {
+        p = 0.5;
+    } else if (channel == 95) {
+        p = 0.9;
+    }
+    return hostRandom() < p;
+}
+
+int main() {
+    NRF24 tx = SIM_NRF24(7);
+    NRF24 rx = SIM_NRF24(6);
+    SimRadio *rxSim = airRadios[1];
+    const uint8_t address[5] = {'N', 'R', 'F', '2', '4'};
+    tx.begin(true, 76, 32);
+    rx.begin(true, 76, 32);
+    tx.openWritingPipe(address, 5);
+    rx.openReadingPipe(1, address, 5);
+    rx.startListening();
+    tx.stopListening();
+
+    // A packet waiting in the RX FIFO must survive the scan
+    uint8_t payload[32] = {42};
+    EXPECT(tx.write(payload, 32));
+
+    airCarrier = busy;
+    uint8_t histogram[NRF24::CHANNEL_COUNT];
+    double start = hostTimeUs;
+    EXPECT(rx.scanChannels(histogram, 8));
+    printf("scan of 8 passes: %.0f ms\n", (hostTimeUs - start) / 1000);
+    for (uint8_t ch = 0; ch < NRF24::CHANNEL_COUNT; ++ch) {
+        putchar(histogram[ch] == 0 ? '.' : histogram[ch] < 10 ? '0' + histogram[ch] : '+');
+    }
+    putchar('\n');
+
+    uint8_t quiet = NRF24::quietestChannel(histogram, 0, 83);
+    printf("quietest in 0..83: %u\n", quiet);
+    EXPECT(quiet >= 74 && quiet <= 83);
+    EXPECT(histogram[95] >= 5);
+
+    EXPECT(rxSim->channel() == 76);
+    EXPECT(rxSim->primaryRx() && rxSim->poweredUp());
+    uint8_t received[32] = {0};
+    EXPECT(rx.read(received, 32) && received[0] == 42);
+
+    // Powered down before the scan: powered down after it
+    rx.powerDown();
+    EXPECT(rx.scanChannels(histogram, 1));
+    EXPECT(!rxSim->poweredUp());
+    EXPECT(rxSim->channel() == 76);
+
+    return hostFailures();
+}
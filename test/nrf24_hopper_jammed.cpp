@@ -0,0 +1,206 @@
+// NRF24Hopper over eight channels with one of them jammed, against a pair
+// fixed on that channel. The transmitter sends a 16-byte message every
+// 10 ms; the receiver must see every message once, in order.
+//
+// Transmitter and receiver run on their own threads, each with its own
+// simulated clock. Whichever clock is behind runs, so the two advance in
+// step without a shared event loop.
+#include <protocol_NRF24Hopper.h>
+#include <util/delay.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "nrf24_air.h"
+
+static const int MESSAGES = 300;
+static const uint8_t JAMMED = 50;
+static const uint8_t CHANNELS[8] = {5, 20, 35, 50, 65, 80, 95, 110};
+
+static std::mutex schedulerLock;
+static std::condition_variable schedulerWake;
+static double clocks[2];
+static bool finished[2];
+static thread_local int self = -1;
+
+static void runWhenBehind() {
+    if (self < 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> guard(schedulerLock);
+    clocks[self] = hostTimeUs;
+    schedulerWake.notify_all();
+    int other = 1 - self;
+    schedulerWake.wait(guard, [other] {
+        return finished[other] || clocks[self] < clocks[other] || (clocks[self] == clocks[other] && self == 0);
+    });
+}
+
+static void finish() {
+    std::lock_guard<std::mutex> guard(schedulerLock);
+    finished[self] = true;
+    schedulerWake.notify_all();
+}
+
+struct Scenario {
+    const char *name;
+    bool hopping;
+    double loss;
+    bool carrierVisible; // jammer strong enough to trip RPD
+};
+
+struct Outcome {
+    int delivered;
+    long unique;
+    long duplicates;
+    long missing;
+    double meanMs;
+    double maxMs;
+};
+
+static Outcome run(const Scenario &scenario) {
+    airReset();
+    hostSeed(11);
+    clocks[0] = clocks[1] = 0;
+    finished[0] = finished[1] = false;
+    double loss = scenario.loss;
+    bool visible = scenario.carrierVisible;
+    airLoss = [loss](uint8_t channel, int) { return channel == JAMMED ? 1.0 : loss; };
+    airCarrier = [visible](uint8_t channel) { return visible && channel == JAMMED; };
+
+    NRF24 tx = SIM_NRF24(7);
+    NRF24 rx = SIM_NRF24(6);
+    NRF24Hopper txHopper(tx);
+    NRF24Hopper rxHopper(rx);
+    const uint8_t address[5] = {'N', 'R', 'F', '2', '4'};
+    tx.begin(true, 76, 32);
+    rx.begin(true, 76, 32);
+    tx.setDataRate(NRF24::DataRate::Rate2Mbps);
+    rx.setDataRate(NRF24::DataRate::Rate2Mbps);
+    tx.setDynamicPayloads(true);
+    rx.setDynamicPayloads(true);
+    tx.openWritingPipe(address, 5);
+    rx.openReadingPipe(0, address, 5);
+    if (scenario.hopping) {
+        txHopper.begin(CHANNELS, 8, 0x1234);
+        rxHopper.begin(CHANNELS, 8, 0x1234);
+        rxHopper.startReceiving();
+    } else {
+        tx.setChannel(JAMMED);
+        rx.setChannel(JAMMED);
+        rx.startListening();
+    }
+    airTick = runWhenBehind;
+
+    Outcome outcome = {0, 0, 0, 0, 0, 0};
+    std::atomic<bool> stop(false);
+
+    std::thread receiver([&] {
+        self = 1;
+        hostTimeUs = 0;
+        hostDelayHook = runWhenBehind;
+        int last = -1;
+        uint8_t buffer[32];
+        while (!stop) {
+            bool got = false;
+            if (scenario.hopping) {
+                uint8_t length;
+                got = rxHopper.receive(buffer, sizeof(buffer), length, 20);
+            } else {
+                for (int i = 0; i < 400 && !(got = rx.read(buffer, 32)); ++i) {
+                    _delay_us(50);
+                }
+            }
+            if (!got) {
+                continue;
+            }
+            int sequence = buffer[0] | (buffer[1] << 8);
+            if (sequence <= last) {
+                ++outcome.duplicates;
+                continue;
+            }
+            outcome.missing += sequence - last - 1;
+            last = sequence;
+            ++outcome.unique;
+        }
+        finish();
+    });
+
+    std::thread transmitter([&] {
+        self = 0;
+        hostTimeUs = 0;
+        hostDelayHook = runWhenBehind;
+        double total = 0;
+        for (int k = 0; k < MESSAGES; ++k) {
+            uint8_t payload[16] = {static_cast<uint8_t>(k), static_cast<uint8_t>(k >> 8)};
+            double start = hostTimeUs;
+            bool ok = scenario.hopping ? txHopper.send(payload, sizeof(payload)) : tx.write(payload, sizeof(payload));
+            if (ok) {
+                double latency = hostTimeUs - start;
+                ++outcome.delivered;
+                total += latency;
+                outcome.maxMs = std::max(outcome.maxMs, latency / 1000);
+            }
+            _delay_ms(10);
+        }
+        outcome.meanMs = outcome.delivered ? total / outcome.delivered / 1000 : 0;
+        stop = true;
+        finish();
+    });
+
+    transmitter.join();
+    receiver.join();
+    airTick = nullptr;
+
+    printf("%-32s delivered %3d/%d  received %3ld dup %ld missing %3ld  latency mean %5.2f max %5.2f ms\n",
+           scenario.name, outcome.delivered, MESSAGES, outcome.unique, outcome.duplicates, outcome.missing,
+           outcome.meanMs, outcome.maxMs);
+    return outcome;
+}
+
+static void expectClean(const Outcome &outcome, double maxLatencyMs) {
+    EXPECT(outcome.delivered == MESSAGES);
+    EXPECT(outcome.unique == MESSAGES);
+    EXPECT(outcome.duplicates == 0);
+    EXPECT(outcome.missing == 0);
+    EXPECT(outcome.maxMs < maxLatencyMs);
+}
+
+// A silent dwell above 3276 ms used to wrap in 16 bits and hop far too early
+static void longSilentDwell() {
+    airReset();
+    self = -1;
+    hostDelayHook = nullptr;
+    NRF24 rx = SIM_NRF24(6);
+    NRF24Hopper hopper(rx);
+    rx.begin(true, 76, 32);
+    hopper.begin(CHANNELS, 8, 0x1234);
+    hopper.setSilentDwell(5000);
+    hopper.startReceiving();
+    uint8_t position = hopper.position();
+    uint8_t length;
+    EXPECT(!hopper.receive(nullptr, 0, length, 4000));
+    printf("idle 4 s with a 5 s silent dwell: position %u -> %u\n", position, hopper.position());
+    EXPECT(hopper.position() == position);
+}
+
+int main() {
+    Scenario fixed = {"fixed on the jammed channel", false, 0, true};
+    Outcome outcome = run(fixed);
+    EXPECT(outcome.delivered == 0);
+
+    Scenario hopping = {"hopping, 1 of 8 jammed", true, 0, true};
+    expectClean(run(hopping), 10);
+
+    Scenario lossy = {"hopping, plus 20% random loss", true, 0.2, true};
+    expectClean(run(lossy), 10);
+
+    // Nothing for RPD to see: the receiver leaves the jammed channel on the
+    // silent dwell alone
+    Scenario weak = {"hopping, jammer below RPD", true, 0, false};
+    expectClean(run(weak), 100);
+
+    longSilentDwell();
+    return hostFailures();
+}
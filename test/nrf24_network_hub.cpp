@@ -0,0 +1,108 @@
+// NRF24Network star: five children (nodes 1..5) send 28-byte messages to
+// the hub in turn for 2 s of simulated time. The hub's aggregate messages/s
+// is reported. Every child's sequence must arrive in order and without
+// duplicates, also when lost ACKs make children resend; a gap is only
+// allowed where send() reported a failure.
+#include <protocol_NRF24Network.h>
+#include <new>
+#include <string.h>
+#include "nrf24_air.h"
+
+static const int CHILDREN = 5;
+
+static NRF24Network *hub;
+static long received[CHILDREN + 1];
+static int lastSequence[CHILDREN + 1];
+static long outOfOrder;
+static long gaps;
+
+static void drainHub() {
+    hub->update();
+    NRF24Network::Message message;
+    while (hub->read(message)) {
+        int sequence = message.data[0] | (message.data[1] << 8);
+        if (message.from < 1 || message.from > CHILDREN) {
+            ++outOfOrder;
+            continue;
+        }
+        if (sequence <= lastSequence[message.from]) {
+            ++outOfOrder;
+        } else {
+            gaps += sequence - lastSequence[message.from] - 1;
+        }
+        lastSequence[message.from] = sequence;
+        ++received[message.from];
+    }
+}
+
+static void run(const char *name, double loss, double ackLoss, double minRate) {
+    airReset();
+    hostSeed(3);
+    memset(received, 0, sizeof(received));
+    memset(lastSequence, 0xFF, sizeof(lastSequence));
+    outOfOrder = 0;
+    gaps = 0;
+    airLoss = [loss](uint8_t, int) { return loss; };
+    airAckLoss = [ackLoss](uint8_t, int) { return ackLoss; };
+
+    static uint8_t storage[CHILDREN + 1][sizeof(NRF24)];
+    static uint8_t networkStorage[CHILDREN + 1][sizeof(NRF24Network)];
+    NRF24 *radios[CHILDREN + 1];
+    NRF24Network *nodes[CHILDREN + 1];
+    for (int i = 0; i <= CHILDREN; ++i) {
+        radios[i] = new (storage[i]) SIM_NRF24(7);
+        radios[i]->begin(true, 76, 32);
+        radios[i]->setDataRate(NRF24::DataRate::Rate2Mbps);
+        radios[i]->setRetries(250, 15);
+        nodes[i] = new (networkStorage[i]) NRF24Network(*radios[i]);
+        EXPECT(nodes[i]->begin(static_cast<uint8_t>(i)));
+    }
+    hub = nodes[0];
+    airRadios[0]->service = drainHub;
+
+    uint16_t sequence[CHILDREN + 1] = {0};
+    long sent = 0;
+    long failed = 0;
+    double start = hostTimeUs;
+    while (hostTimeUs - start < 2e6) {
+        for (int i = 1; i <= CHILDREN; ++i) {
+            uint8_t payload[28] = {static_cast<uint8_t>(sequence[i]), static_cast<uint8_t>(sequence[i] >> 8)};
+            if (nodes[i]->send(0, 1, payload, sizeof(payload))) {
+                ++sent;
+            } else {
+                ++failed; // may still have arrived: only the ACKs were lost
+            }
+            ++sequence[i];
+            drainHub();
+        }
+    }
+    double seconds = (hostTimeUs - start) / 1e6;
+
+    long total = 0;
+    for (int i = 1; i <= CHILDREN; ++i) {
+        total += received[i];
+    }
+    printf("%-36s hub %5.0f msgs/s (", name, total / seconds);
+    for (int i = 1; i <= CHILDREN; ++i) {
+        printf("%s%ld", i > 1 ? " " : "", received[i]);
+    }
+    printf(") failed %ld, gaps %ld, duplicates dropped %u\n", failed, gaps, hub->duplicates());
+
+    EXPECT(total / seconds >= minRate);
+    EXPECT(total >= sent && total <= sent + failed);
+    EXPECT(gaps <= failed);
+    EXPECT(outOfOrder == 0);
+    for (int i = 1; i <= CHILDREN; ++i) {
+        EXPECT(received[i] * CHILDREN * 2 > total); // no child starved
+    }
+    if (ackLoss > 0) {
+        EXPECT(hub->duplicates() > 0);
+    }
+}
+
+int main() {
+    run("5 children", 0, 0, 1000);
+    run("5 children, 20% loss", 0.2, 0, 850);
+    run("5 children, 10% loss + 20% ACK loss", 0.1, 0.2, 700);
+    return hostFailures();
+}
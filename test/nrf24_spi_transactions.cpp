@@ -0,0 +1,70 @@
+// SPI transactions (CSN assertions) per NRF24 call, against the budgets the
+// register cache was built for. A regression that re-reads a register the
+// driver already knows shows up here as one transaction too many.
+#include "nrf24_air.h"
+
+static uint32_t transactionsFor(SimRadio *radio, uint32_t before) {
+    return radio->transactions - before;
+}
+
+int main() {
+    NRF24 tx = SIM_NRF24(7);
+    NRF24 rx = SIM_NRF24(6);
+    SimRadio *txSim = airRadios[0];
+    SimRadio *rxSim = airRadios[1];
+
+    const uint8_t address[5] = {'N', 'R', 'F', '2', '4'};
+    tx.begin(true, 76, 32);
+    rx.begin(true, 76, 32);
+    tx.openWritingPipe(address, 5);
+    rx.openReadingPipe(1, address, 5);
+    rx.startListening();
+    tx.stopListening();
+
+    uint8_t payload[32] = {0};
+    uint32_t before = txSim->transactions;
+    EXPECT(tx.write(payload, 32));
+    uint32_t writeStandby = transactionsFor(txSim, before);
+
+    // read() with RX_DR set: payload command plus the flag clear
+    before = rxSim->transactions;
+    EXPECT(rx.read(payload, 32));
+    uint32_t readOne = transactionsFor(rxSim, before);
+
+    EXPECT(tx.write(payload, 32));
+    before = rxSim->transactions;
+    EXPECT(rx.available());
+    uint32_t availableOne = transactionsFor(rxSim, before);
+    EXPECT(rx.read(payload, 32));
+
+    // A listening transmitter: stop, send, resume
+    tx.startListening();
+    before = txSim->transactions;
+    EXPECT(tx.write(payload, 32));
+    uint32_t writeListening = transactionsFor(txSim, before);
+
+    before = txSim->transactions;
+    tx.setDataRate(NRF24::DataRate::Rate2Mbps);
+    tx.setPowerLevel(NRF24::PowerLevel::Low);
+    uint32_t rfSetup = transactionsFor(txSim, before);
+
+    before = txSim->transactions;
+    tx.startListening();
+    tx.stopListening();
+    uint32_t modeSwitch = transactionsFor(txSim, before);
+
+    printf("write() from standby          %u\n", writeStandby);
+    printf("write() while listening       %u\n", writeListening);
+    printf("read() one packet             %u\n", readOne);
+    printf("available() with a packet     %u\n", availableOne);
+    printf("setDataRate+setPowerLevel     %u\n", rfSetup);
+    printf("startListening+stopListening  %u\n", modeSwitch);
+
+    EXPECT(writeStandby <= 4);
+    EXPECT(writeListening <= 6);
+    EXPECT(readOne <= 2);
+    EXPECT(availableOne <= 1);
+    EXPECT(rfSetup <= 2);
+    EXPECT(modeSwitch <= 4);
+    return hostFailures();
+}
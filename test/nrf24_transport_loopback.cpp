@@ -0,0 +1,76 @@
+// NRF24Transport over a simulated radio pair at 2 Mbps: 20 messages of 1 KB
+// per loss rate. Every message must arrive intact; goodput is payload bytes
+// over simulated time and must stay above a floor per loss rate.
+#include <protocol_NRF24Transport.h>
+#include <string.h>
+#include "nrf24_air.h"
+
+static const int MESSAGES = 20;
+static const uint16_t MESSAGE_SIZE = 1024;
+
+static NRF24Transport *receiver;
+
+static void runLoss(double loss, double minGoodput) {
+    airReset();
+    hostSeed(1);
+    NRF24 tx = SIM_NRF24(7);
+    NRF24 rx = SIM_NRF24(6);
+    NRF24Transport sender(tx);
+    NRF24Transport listener(rx);
+    receiver = &listener;
+    airLoss = [loss](uint8_t, int) { return loss; };
+
+    const uint8_t address[5] = {'N', 'R', 'F', '2', '4'};
+    tx.begin(true, 76, 32);
+    rx.begin(true, 76, 32);
+    tx.setDataRate(NRF24::DataRate::Rate2Mbps);
+    rx.setDataRate(NRF24::DataRate::Rate2Mbps);
+    sender.begin();
+    listener.begin();
+    tx.openWritingPipe(address, 5);
+    rx.openReadingPipe(0, address, 5);
+    static uint8_t rxBuffer[2048];
+    listener.setReceiveBuffer(rxBuffer, sizeof(rxBuffer));
+    rx.startListening();
+    tx.stopListening();
+    // The receiving application polls as packets land
+    airRadios[1]->service = [] { receiver->poll(); };
+
+    uint8_t message[MESSAGE_SIZE];
+    for (uint16_t i = 0; i < MESSAGE_SIZE; ++i) {
+        message[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+
+    int sent = 0;
+    int verified = 0;
+    long fragments = 0;
+    double start = hostTimeUs;
+    for (int k = 0; k < MESSAGES; ++k) {
+        message[0] = static_cast<uint8_t>(k);
+        if (sender.send(message, MESSAGE_SIZE, 8)) {
+            ++sent;
+        }
+        listener.poll();
+        fragments += sender.fragmentsSent();
+        if (listener.messageReady() && listener.messageLength() == MESSAGE_SIZE &&
+            memcmp(rxBuffer, message, MESSAGE_SIZE) == 0) {
+            ++verified;
+        }
+        listener.releaseMessage();
+    }
+
+    double seconds = (hostTimeUs - start) / 1e6;
+    double goodput = MESSAGES * MESSAGE_SIZE / seconds;
+    printf("loss %.1f: sent %d/%d verified %d fragments/message %.1f goodput %.0f B/s\n", loss, sent, MESSAGES,
+           verified, static_cast<double>(fragments) / MESSAGES, goodput);
+    EXPECT(sent == MESSAGES);
+    EXPECT(verified == MESSAGES);
+    EXPECT(goodput >= minGoodput);
+}
+
+int main() {
+    runLoss(0.0, 40000);
+    runLoss(0.3, 15000);
+    runLoss(0.8, 2500);
+    return hostFailures();
+}
@@ -0,0 +1,301 @@
+#include "mpu6050_sim.h"
+#include <protocol_I2C.h>
+#include <math.h>
+#include <string.h>
+
+SimMpu6050 simMpu;
+
+static const uint8_t REG_XA_OFFS_H = 0x06;
+static const uint8_t REG_XG_OFFS_USRH = 0x13;
+static const uint8_t REG_SMPLRT_DIV = 0x19;
+static const uint8_t REG_CONFIG = 0x1A;
+static const uint8_t REG_GYRO_CONFIG = 0x1B;
+static const uint8_t REG_ACCEL_CONFIG = 0x1C;
+static const uint8_t REG_FIFO_EN = 0x23;
+static const uint8_t REG_INT_PIN_CFG = 0x37;
+static const uint8_t REG_INT_ENABLE = 0x38;
+static const uint8_t REG_INT_STATUS = 0x3A;
+static const uint8_t REG_ACCEL_XOUT_H = 0x3B;
+static const uint8_t REG_USER_CTRL = 0x6A;
+static const uint8_t REG_PWR_MGMT_1 = 0x6B;
+static const uint8_t REG_FIFO_COUNT_H = 0x72;
+static const uint8_t REG_FIFO_COUNT_L = 0x73;
+static const uint8_t REG_FIFO_R_W = 0x74;
+static const uint8_t REG_WHO_AM_I = 0x75;
+
+static const uint8_t INT_DATA_RDY = 0x01;
+static const uint8_t INT_FIFO_OFLOW = 0x10;
+static const uint8_t INT_LATCH = 0x20;
+static const uint8_t PWR_SLEEP = 0x40;
+static const uint8_t USER_FIFO_EN = 0x40;
+static const uint8_t USER_FIFO_RESET = 0x04;
+
+static int16_t sampleValue(uint32_t counter, int word) {
+    switch (word) {
+    case 0:
+        return static_cast<int16_t>(counter & 0xFFFF);
+    case 1:
+        return static_cast<int16_t>(counter >> 16);
+    default:
+        return static_cast<int16_t>(static_cast<uint16_t>(counter * 7 + word * 1000));
+    }
+}
+
+SimMpu6050::SimMpu6050() {
+    memset(regs, 0, sizeof(regs));
+    regs[REG_PWR_MGMT_1] = PWR_SLEEP;
+    regs[REG_WHO_AM_I] = 0x68;
+}
+
+// 8 kHz gyro output with the DLPF off, 1 kHz with it on
+double SimMpu6050::samplePeriodUs() const {
+    uint8_t dlpf = regs[REG_CONFIG] & 0x07;
+    double baseUs = (dlpf == 0 || dlpf == 7) ? 125.0 : 1000.0;
+    return baseUs * (1 + regs[REG_SMPLRT_DIV]);
+}
+
+void SimMpu6050::advance() {
+    if (regs[REG_PWR_MGMT_1] & PWR_SLEEP) {
+        nextSampleUs = hostTimeUs;
+        return;
+    }
+    while (nextSampleUs <= hostTimeUs) {
+        produce();
+        nextSampleUs += samplePeriodUs();
+    }
+}
+
+void SimMpu6050::push(uint8_t byte, bool &overflowed) {
+    if (fifoCount == sizeof(fifo)) {
+        fifoHead = static_cast<uint16_t>((fifoHead + 1) % sizeof(fifo));
+        --fifoCount;
+        regs[REG_INT_STATUS] |= INT_FIFO_OFLOW;
+        overflowed = true;
+    }
+    fifo[(fifoHead + fifoCount) % sizeof(fifo)] = byte;
+    ++fifoCount;
+}
+
+void SimMpu6050::produce() {
+    ++counter;
+    uint8_t sample[14];
+    for (int word = 0; word < 7; ++word) {
+        // Word 3 is the temperature, between accel and gyro
+        int axis = word < 3 ? word : word - 1;
+        int16_t value = word == 3 ? static_cast<int16_t>(counter & 0x3FF)
+                                  : still ? stillValue(axis) : sampleValue(counter, axis);
+        sample[2 * word] = static_cast<uint8_t>(value >> 8);
+        sample[2 * word + 1] = static_cast<uint8_t>(value);
+    }
+
+    bool overflowed = false;
+    uint8_t fifoEnable = regs[REG_FIFO_EN];
+    if ((regs[REG_USER_CTRL] & USER_FIFO_EN) && fifoEnable) {
+        if (fifoEnable & 0x08) { // ACCEL
+            for (int i = 0; i < 6; ++i) {
+                push(sample[i], overflowed);
+            }
+        }
+        for (int i = 0; i < 4; ++i) { // TEMP, XG, YG, ZG
+            if (fifoEnable & (0x80 >> i)) {
+                push(sample[6 + 2 * i], overflowed);
+                push(sample[7 + 2 * i], overflowed);
+            }
+        }
+    }
+
+    bool pulses = !(regs[REG_INT_PIN_CFG] & INT_LATCH);
+    if (frozen) {
+        // Registers and DATA_RDY wait for the burst to end
+        memcpy(held, sample, sizeof(held));
+        pending = true;
+        if (overflowed && pulses && (regs[REG_INT_ENABLE] & INT_FIFO_OFLOW) && onInterrupt) {
+            onInterrupt();
+        }
+        return;
+    }
+
+    memcpy(&regs[REG_ACCEL_XOUT_H], sample, sizeof(sample));
+    regs[REG_INT_STATUS] |= INT_DATA_RDY;
+    if (pulses) {
+        bool fire = (regs[REG_INT_ENABLE] & INT_DATA_RDY) || (overflowed && (regs[REG_INT_ENABLE] & INT_FIFO_OFLOW));
+        if (fire && onInterrupt) {
+            onInterrupt();
+        }
+        return;
+    }
+    raiseDataReady();
+}
+
+// Axis 0..2 accel, 3..5 gyro, as the still sensor reads at the current range
+int16_t SimMpu6050::stillValue(int axis) const {
+    double counts;
+    if (axis < 3) {
+        const uint8_t *offs = &regs[REG_XA_OFFS_H + 2 * axis];
+        int16_t offset = static_cast<int16_t>(((offs[0] << 8) | offs[1]) & ~1);
+        uint8_t range = (regs[REG_ACCEL_CONFIG] >> 3) & 0x03;
+        counts = static_cast<double>(accelBias[axis] + offset) * (1 << (3 - range));
+        if (axis == 2) {
+            counts += 16384 >> range;
+        }
+    } else {
+        const uint8_t *offs = &regs[REG_XG_OFFS_USRH + 2 * (axis - 3)];
+        int16_t offset = static_cast<int16_t>((offs[0] << 8) | offs[1]);
+        uint8_t range = (regs[REG_GYRO_CONFIG] >> 3) & 0x03;
+        counts = (gyroBias[axis - 3] + offset) * 4.0 / (1 << range);
+    }
+    counts += noise * (2 * hostRandom() - 1);
+    counts = counts > 32767 ? 32767 : counts < -32768 ? -32768 : counts;
+    return static_cast<int16_t>(lround(counts));
+}
+
+void SimMpu6050::raiseDataReady() {
+    bool asserted = (regs[REG_INT_ENABLE] & regs[REG_INT_STATUS]) != 0;
+    if (asserted && !intLevel && onInterrupt) {
+        intLevel = true;
+        onInterrupt();
+    }
+    intLevel = asserted;
+}
+
+void SimMpu6050::beginBurst() {
+    advance();
+    frozen = true;
+}
+
+void SimMpu6050::endBurst() {
+    frozen = false;
+    if (!pending) {
+        return;
+    }
+    memcpy(&regs[REG_ACCEL_XOUT_H], held, sizeof(held));
+    pending = false;
+    regs[REG_INT_STATUS] |= INT_DATA_RDY;
+    if (!(regs[REG_INT_ENABLE] & INT_DATA_RDY)) {
+        return;
+    }
+    if (!(regs[REG_INT_PIN_CFG] & INT_LATCH)) {
+        if (onInterrupt) {
+            onInterrupt();
+        }
+    } else {
+        raiseDataReady();
+    }
+}
+
+uint8_t SimMpu6050::read(uint8_t reg) {
+    advance();
+    switch (reg) {
+    case REG_FIFO_R_W: {
+        if (fifoCount == 0) {
+            return 0xFF;
+        }
+        uint8_t value = fifo[fifoHead];
+        fifoHead = static_cast<uint16_t>((fifoHead + 1) % sizeof(fifo));
+        --fifoCount;
+        return value;
+    }
+    case REG_FIFO_COUNT_H:
+        return static_cast<uint8_t>(fifoCount >> 8);
+    case REG_FIFO_COUNT_L:
+        return static_cast<uint8_t>(fifoCount);
+    case REG_INT_STATUS: {
+        uint8_t value = regs[REG_INT_STATUS];
+        regs[REG_INT_STATUS] = 0; // cleared on read
+        intLevel = false;
+        return value;
+    }
+    default:
+        return regs[reg & 0x7F];
+    }
+}
+
+void SimMpu6050::write(uint8_t reg, uint8_t value) {
+    advance();
+    if (reg == REG_USER_CTRL) {
+        if ((value & USER_FIFO_RESET) && !(value & USER_FIFO_EN)) {
+            fifoHead = 0;
+            fifoCount = 0;
+        }
+        value &= static_cast<uint8_t>(~USER_FIFO_RESET);
+    }
+    if (reg == REG_PWR_MGMT_1 && (regs[REG_PWR_MGMT_1] & PWR_SLEEP) && !(value & PWR_SLEEP)) {
+        nextSampleUs = hostTimeUs + samplePeriodUs();
+    }
+    regs[reg & 0x7F] = value;
+}
+
+bool SimMpu6050::decode(const MPU6050::RawSample &sample, uint32_t &counter) {
+    counter = static_cast<uint16_t>(sample.accel_x) | (static_cast<uint32_t>(static_cast<uint16_t>(sample.accel_y)) << 16);
+    return sample.accel_z == sampleValue(counter, 2) && sample.gyro_x == sampleValue(counter, 3) &&
+           sample.gyro_y == sampleValue(counter, 4) && sample.gyro_z == sampleValue(counter, 5);
+}
+
+// protocol_I2C.cpp replacement: blocking register access to simMpu at the
+// configured bus speed. The interrupt-driven queue is not simulated.
+
+I2C::Transaction *volatile I2C::twiQueueHead = nullptr;
+I2C::Transaction *volatile I2C::twiQueueTail = nullptr;
+volatile bool I2C::twiBusy = false;
+uint8_t I2C::twiIndex = 0;
+bool I2C::twiReading = false;
+
+I2C::I2C(volatile uint8_t *, volatile uint8_t *, volatile uint8_t *, uint8_t,
+         volatile uint8_t *, volatile uint8_t *, volatile uint8_t *, uint8_t) {}
+
+void I2C::setClock(uint32_t frequencyHz) {
+    simMpu.byteUs = 9e6 / frequencyHz;
+}
+
+bool I2C::setBackend(Backend) { return true; }
+
+static void busBytes(unsigned count) {
+    hostTimeUs += count * simMpu.byteUs;
+    simMpu.bytes += count;
+}
+
+bool I2C::writeThenRead(uint8_t address, const uint8_t *tx, unsigned int txLength, uint8_t *rx, unsigned int rxLength) {
+    if (address != 0x68 || txLength == 0) {
+        return false;
+    }
+    ++simMpu.transactions;
+    uint8_t reg = tx[0];
+    busBytes(1 + txLength);
+    for (unsigned i = 1; i < txLength; ++i) {
+        simMpu.write(static_cast<uint8_t>(reg + i - 1), tx[i]);
+    }
+    if (rxLength == 0) {
+        return true;
+    }
+
+    busBytes(1); // repeated START + address
+    simMpu.beginBurst();
+    for (unsigned i = 0; i < rxLength; ++i) {
+        busBytes(1);
+        rx[i] = simMpu.read(reg);
+        if (reg != 0x74) { // FIFO_R_W does not auto-increment
+            ++reg;
+        }
+    }
+    simMpu.endBurst();
+    return true;
+}
+
+bool I2C::writeMessage(uint8_t address, const uint8_t *data, unsigned int length) {
+    return writeThenRead(address, data, length, nullptr, 0);
+}
+
+bool I2C::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, unsigned int length) {
+    return writeThenRead(address, &reg, 1, data, length);
+}
+
+bool I2C::readRegister(uint8_t address, uint8_t reg, uint8_t &value) {
+    return writeThenRead(address, &reg, 1, &value, 1);
+}
+
+bool I2C::writeRegister(uint8_t address, uint8_t reg, uint8_t value) {
+    uint8_t data[2] = {reg, value};
+    return writeMessage(address, data, 2);
+}
+
+bool I2C::submit(Transaction &) { return false; }
@@ -0,0 +1,69 @@
+// Simulated MPU6050 at register level behind a host I2C. Linked in place of
+// protocol_I2C.cpp, so MPU6050 runs unmodified against it.
+//
+// The sensor samples on the simulated clock (SMPLRT_DIV, DLPF_CFG) whenever
+// the bus touches it. Each sample carries a running counter, so a test can
+// tell lost, repeated and torn samples apart:
+//   accel_x = counter low word, accel_y = counter high word,
+//   accel_z / gyro_x..z = counter * 7 + 2000 / 3000 / 4000 / 5000.
+// During a burst read the sample registers hold still and DATA_RDY waits, as
+// on the part; the FIFO (1024 bytes) drops its oldest bytes on overflow and
+// sets FIFO_OFLOW_INT.
+//
+// With still set the sensor lies flat instead: every sample is its bias plus
+// the offset registers (XA_OFFS_H.., XG_OFFS_USRH..) at their own scale,
+// converted to the current range, 1 g on Z and up to +-noise counts. As on
+// the part, bit 0 of an accel offset register is reserved and not added.
+#pragma once
+#include <device_MPU6050.h>
+#include <functional>
+#include "host.h"
+
+struct SimMpu6050 {
+    uint8_t regs[128];
+    uint8_t fifo[1024];
+    uint16_t fifoHead = 0;
+    uint16_t fifoCount = 0;
+    uint32_t counter = 0; // samples produced
+    double nextSampleUs = 0;
+    bool intLevel = false;
+
+    bool still = false;
+    int16_t accelBias[3] = {0, 0, 0}; // ±16g counts, 2048 per g
+    int16_t gyroBias[3] = {0, 0, 0};  // ±1000°/s counts, 32.8 per °/s
+    double noise = 0;
+
+    // Bus statistics, including the time each byte took
+    double byteUs = 22.5; // 9 bit times at 400 kHz
+    uint32_t transactions = 0;
+    uint32_t bytes = 0;
+
+    // INT pin rising edge (pulse or latched level, per INT_PIN_CFG)
+    std::function<void()> onInterrupt;
+
+    SimMpu6050();
+    // Produces every sample due by hostTimeUs
+    void advance();
+    double samplePeriodUs() const;
+
+    uint8_t read(uint8_t reg);
+    void write(uint8_t reg, uint8_t value);
+    void beginBurst();
+    void endBurst();
+
+    // Decodes the running counter, as MPU6050 delivered it; false if the
+    // sample does not match its own counter (torn or corrupt)
+    static bool decode(const MPU6050::RawSample &sample, uint32_t &counter);
+
+private:
+    void produce();
+    int16_t stillValue(int axis) const;
+    void push(uint8_t byte, bool &overflowed);
+    void raiseDataReady();
+
+    bool frozen = false;
+    bool pending = false;
+    uint8_t held[14];
+};
+
+extern SimMpu6050 simMpu;
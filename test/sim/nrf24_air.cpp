@@ -0,0 +1,331 @@
+#include "nrf24_air.h"
+#include <map>
+#include <string.h>
+
+std::vector<SimRadio *> airRadios;
+std::function<double(uint8_t, int)> airLoss;
+std::function<double(uint8_t, int)> airAckLoss;
+std::function<bool(uint8_t)> airCarrier;
+std::function<void()> airTick;
+
+static std::map<const SPI *, SimRadio *> radioBySpi;
+static bool inTick = false;
+
+static const uint8_t STATUS_RX_DR = 0x40;
+static const uint8_t STATUS_TX_DS = 0x20;
+static const uint8_t STATUS_MAX_RT = 0x10;
+
+// Preamble, address, 9-bit packet control field, payload and CRC at 2 Mbps,
+// after the 130 us TX settle
+double airPacketTimeUs(uint8_t length) {
+    return 130.0 + ((1 + 5 + length + 2) * 8 + 9) / 2.0;
+}
+
+void airReset() {
+    for (auto &entry : radioBySpi) {
+        delete entry.second;
+    }
+    radioBySpi.clear();
+    airRadios.clear();
+    airLoss = nullptr;
+    airAckLoss = nullptr;
+    airCarrier = nullptr;
+    airTick = nullptr;
+}
+
+// Power-on register values from the datasheet
+SimRadio::SimRadio() {
+    memset(regs, 0, sizeof(regs));
+    regs[0x00] = 0x08;
+    regs[0x01] = 0x3F;
+    regs[0x02] = 0x03;
+    regs[0x03] = 0x03;
+    regs[0x04] = 0x03;
+    regs[0x05] = 0x02;
+    regs[0x06] = 0x0F;
+    for (int pipe = 0; pipe < 6; ++pipe) {
+        memset(address[pipe], pipe == 0 ? 0xE7 : 0xC2, 5);
+    }
+    for (int pipe = 2; pipe < 6; ++pipe) {
+        address[pipe][0] = static_cast<uint8_t>(0xC1 + pipe);
+    }
+    memset(txAddress, 0xE7, 5);
+    id = static_cast<int>(airRadios.size());
+    airRadios.push_back(this);
+}
+
+uint8_t SimRadio::statusByte() const {
+    uint8_t status = flags & (STATUS_RX_DR | STATUS_TX_DS | STATUS_MAX_RT);
+    status |= rxFifo.empty() ? 0x0E : static_cast<uint8_t>(rxFifo.front().pipe << 1);
+    if (txFifo.size() >= 3) {
+        status |= 0x01;
+    }
+    return status;
+}
+
+void SimRadio::select() {
+    ++transactions;
+    position = 0;
+    count = 0;
+}
+
+void SimRadio::deselect() {
+    bool payload = command == 0xA0 || command == 0xB0 || (command & 0xF8) == 0xA8;
+    if (payload && count > 0 && txFifo.size() < 3) {
+        AirPacket packet;
+        packet.pipe = (command & 0xF8) == 0xA8 ? (command & 0x07) : 0;
+        packet.length = count;
+        memcpy(packet.data, buffer, count);
+        packet.noAck = command == 0xB0;
+        txFifo.push_back(packet);
+    }
+
+    if (command >= 0x20 && command < 0x40 && count > 0) {
+        uint8_t reg = command & 0x1F;
+        if (reg == 0x07) {
+            flags &= static_cast<uint8_t>(~(buffer[0] & 0x70));
+        } else if (reg == 0x0A || reg == 0x0B) {
+            memcpy(address[reg - 0x0A], buffer, count);
+        } else if (reg >= 0x0C && reg <= 0x0F) {
+            address[reg - 0x0A][0] = buffer[0];
+        } else if (reg == 0x10) {
+            memcpy(txAddress, buffer, count);
+        } else {
+            if (reg == 0x05) {
+                lostCount = 0; // writing RF_CH resets PLOS_CNT
+            }
+            regs[reg] = buffer[0];
+        }
+    }
+
+    if (command == 0x61 && count > 0 && !rxFifo.empty()) {
+        rxFifo.pop_front();
+    }
+    if (command == 0xE1) {
+        txFifo.clear();
+    }
+    if (command == 0xE2) {
+        rxFifo.clear();
+    }
+    position = -1;
+    transmit();
+}
+
+uint8_t SimRadio::transfer(uint8_t byte) {
+    if (position == 0) {
+        command = byte;
+        position = 1;
+        return statusByte();
+    }
+
+    uint8_t index = count;
+    if (count < sizeof(buffer)) {
+        buffer[count++] = byte;
+    }
+
+    if (command < 0x20) {
+        switch (command) {
+        case 0x07:
+            return statusByte();
+        case 0x08:
+            return static_cast<uint8_t>((lostCount << 4) | retryCount);
+        case 0x09:
+            return (airCarrier && airCarrier(channel())) ? 1 : 0;
+        case 0x0A:
+        case 0x0B:
+            return address[command - 0x0A][index % 5];
+        case 0x10:
+            return txAddress[index % 5];
+        case 0x17:
+            return static_cast<uint8_t>((rxFifo.empty() ? 0x01 : 0) | (rxFifo.size() >= 3 ? 0x02 : 0) |
+                                        (txFifo.empty() ? 0x10 : 0) | (txFifo.size() >= 3 ? 0x20 : 0));
+        default:
+            return regs[command];
+        }
+    }
+    if (command == 0x60) {
+        return rxFifo.empty() ? 0 : rxFifo.front().length;
+    }
+    if (command == 0x61) {
+        return (!rxFifo.empty() && index < rxFifo.front().length) ? rxFifo.front().data[index] : 0;
+    }
+    return 0;
+}
+
+int SimRadio::matchPipe(const uint8_t *air) const {
+    int width = addressWidth();
+    for (int pipe = 0; pipe < 6; ++pipe) {
+        if (!(regs[0x02] & (1 << pipe))) {
+            continue;
+        }
+        // Pipes 2..5 share bytes 1.. with pipe 1
+        if (pipe >= 2 && air[0] != address[pipe][0]) {
+            continue;
+        }
+        const uint8_t *upper = pipe >= 2 ? address[1] : address[pipe];
+        bool match = true;
+        for (int i = pipe >= 2 ? 1 : 0; i < width; ++i) {
+            if (upper[i] != air[i]) {
+                match = false;
+                break;
+            }
+        }
+        if (match) {
+            return pipe;
+        }
+    }
+    return -1;
+}
+
+void SimRadio::runService() {
+    if (service && !inService) {
+        inService = true;
+        service();
+        inService = false;
+    }
+}
+
+// Sends the whole TX FIFO with auto-retransmit; stops at MAX_RT like the
+// real radio until the flag is cleared
+void SimRadio::transmit() {
+    while (!hold && !primaryRx() && poweredUp() && !txFifo.empty() && !(flags & STATUS_MAX_RT)) {
+        AirPacket &packet = txFifo.front();
+        int retries = regs[0x04] & 0x0F;
+        double retryDelayUs = 250.0 * (1 + (regs[0x04] >> 4));
+        bool acked = false;
+        int attempt = 0;
+
+        for (; attempt <= retries; ++attempt) {
+            if (airTick && !inTick) {
+                inTick = true;
+                airTick();
+                inTick = false;
+            }
+            hostTimeUs += airPacketTimeUs(packet.length);
+
+            SimRadio *target = nullptr;
+            int pipe = -1;
+            for (SimRadio *radio : airRadios) {
+                if (radio == this || !radio->primaryRx() || !radio->poweredUp() || radio->channel() != channel()) {
+                    continue;
+                }
+                pipe = radio->matchPipe(txAddress);
+                if (pipe >= 0) {
+                    target = radio;
+                    break;
+                }
+            }
+
+            bool lost = airLoss && hostRandom() < airLoss(channel(), id);
+            bool landed = target && !lost && target->rxFifo.size() < 3;
+            if (landed) {
+                AirPacket in = packet;
+                in.pipe = static_cast<uint8_t>(pipe);
+                target->rxFifo.push_back(in);
+                target->flags |= STATUS_RX_DR;
+                ++target->received;
+            }
+            if (packet.noAck) {
+                acked = true;
+                if (landed) {
+                    target->runService();
+                }
+                break;
+            }
+            if (landed && airAckLoss && hostRandom() < airAckLoss(channel(), id)) {
+                hostTimeUs += retryDelayUs;
+                continue;
+            }
+            if (landed) {
+                hostTimeUs += 130 + 40;
+                // The ACK carries the payload queued for that pipe, if any
+                for (auto it = target->txFifo.begin(); it != target->txFifo.end(); ++it) {
+                    if (it->pipe == pipe) {
+                        if (rxFifo.size() < 3) {
+                            AirPacket reply = *it;
+                            reply.pipe = 0;
+                            rxFifo.push_back(reply);
+                            flags |= STATUS_RX_DR;
+                        }
+                        hostTimeUs += it->length * 4;
+                        target->txFifo.erase(it);
+                        break;
+                    }
+                }
+                acked = true;
+                target->runService();
+                break;
+            }
+            hostTimeUs += retryDelayUs;
+        }
+
+        if (acked) {
+            retryCount = static_cast<uint8_t>(packet.noAck ? 0 : attempt);
+            txFifo.pop_front();
+            flags |= STATUS_TX_DS;
+        } else {
+            retryCount = static_cast<uint8_t>(retries);
+            if (lostCount < 15) {
+                ++lostCount;
+            }
+            flags |= STATUS_MAX_RT;
+        }
+    }
+}
+
+// protocol_SPI.cpp replacement: each SPI instance talks to its own SimRadio
+
+SPI::SPI(volatile uint8_t *, volatile uint8_t *, volatile uint8_t *, uint8_t,
+         volatile uint8_t *, volatile uint8_t *, volatile uint8_t *, uint8_t,
+         volatile uint8_t *, volatile uint8_t *, volatile uint8_t *, uint8_t,
+         volatile uint8_t *, volatile uint8_t *, volatile uint8_t *, uint8_t) {
+    radioBySpi[this] = new SimRadio();
+}
+
+void SPI::begin(bool) {}
+void SPI::setBitOrder(BitOrder) {}
+void SPI::setDataMode(uint8_t) {}
+void SPI::setDataMode(ClockPolarity, ClockPhase) {}
+void SPI::setClockHz(uint32_t) {}
+void SPI::setDelayLoops(uint16_t, uint16_t) {}
+void SPI::setAutoChipSelect(bool) {}
+bool SPI::setBackend(Backend) { return true; }
+void SPI::computeHardwareConfig() {}
+
+void SPI::select() {
+    radioBySpi[this]->select();
+    hostTimeUs += 1;
+}
+
+void SPI::deselect() {
+    radioBySpi[this]->deselect();
+}
+
+// About 1 us per byte, as with the hardware backend at F_CPU/2
+uint8_t SPI::transferByte(uint8_t data) {
+    hostTimeUs += 1;
+    return radioBySpi[this]->transfer(data);
+}
+
+void SPI::transferBytes(const uint8_t *tx, uint8_t *rx, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t value = transferByte(tx ? tx[i] : 0xFF);
+        if (rx) {
+            rx[i] = value;
+        }
+    }
+}
+
+void SPI::writeBytes(const uint8_t *data, size_t length) {
+    transferBytes(data, nullptr, length);
+}
+
+void SPI::readBytes(uint8_t *rx, size_t length) {
+    transferBytes(nullptr, rx, length);
+}
+
+void SPI::readBytes(ByteHandler handler, void *context, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        handler(i, transferByte(0xFF), context);
+    }
+}
@@ -0,0 +1,81 @@
+// Simulated nRF24L01+ radios on a shared channel space ("the air"). Linked in
+// place of protocol_SPI.cpp: every SPI object becomes one SimRadio that
+// decodes the command set at register level, so NRF24 runs unmodified.
+//
+// Timing is approximate (2 Mbps air time, 130 us settle, ARD waits) and
+// charged to the caller's hostTimeUs. A transmitter sends as soon as a
+// command leaves a payload in its TX FIFO; there is no CE model.
+#pragma once
+#include <device_NRF24.h>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "host.h"
+
+struct AirPacket {
+    uint8_t pipe;
+    uint8_t length;
+    uint8_t data[32];
+    bool noAck;
+};
+
+struct SimRadio {
+    int id;
+    uint8_t regs[0x20];
+    uint8_t address[6][5];
+    uint8_t txAddress[5];
+    uint8_t flags = 0; // RX_DR/TX_DS/MAX_RT as in STATUS
+    std::deque<AirPacket> rxFifo;
+    std::deque<AirPacket> txFifo;
+    uint8_t lostCount = 0;
+    uint8_t retryCount = 0;
+
+    // Test hooks and counters
+    uint32_t transactions = 0; // CSN assertions
+    uint32_t received = 0;     // payloads that landed in rxFifo
+    bool hold = false;         // keep the TX FIFO parked
+    // Receiver application, run right after a payload lands
+    std::function<void()> service;
+
+    SimRadio();
+    bool primaryRx() const { return regs[0x00] & 0x01; }
+    bool poweredUp() const { return regs[0x00] & 0x02; }
+    uint8_t channel() const { return regs[0x05]; }
+    int addressWidth() const { return (regs[0x03] & 0x03) + 2; }
+
+    uint8_t statusByte() const;
+    void select();
+    void deselect();
+    uint8_t transfer(uint8_t byte);
+    void transmit();
+
+private:
+    int matchPipe(const uint8_t *air) const;
+    void runService();
+
+    int position = -1;
+    uint8_t command = 0;
+    uint8_t buffer[40];
+    uint8_t count = 0;
+    bool inService = false;
+};
+
+// Radios in SPI construction order
+extern std::vector<SimRadio *> airRadios;
+// Probability that one attempt on `channel` from radio `from` is lost
+extern std::function<double(uint8_t channel, int from)> airLoss;
+// Probability that a delivered packet's ACK is lost (the sender retries)
+extern std::function<double(uint8_t channel, int from)> airAckLoss;
+// RPD: whether a carrier above -64 dBm is present on `channel`
+extern std::function<bool(uint8_t channel)> airCarrier;
+// Runs before every transmit attempt, e.g. to interleave other radios
+extern std::function<void()> airTick;
+
+// On-air time of one packet at 2 Mbps, settle included
+double airPacketTimeUs(uint8_t length);
+// Drops all radios and hooks so a test can build a fresh scene
+void airReset();
+
+// Same pins for every radio; the air tells them apart by SPI object
+#define SIM_NRF24(cePin) NRF24(&PINB, &DDRB, &PORTB, 3, &PINB, &DDRB, &PORTB, 4, &PINB, &DDRB, &PORTB, 5, \
+                               &PINB, &DDRB, &PORTB, 2, &PIND, &DDRD, &PORTD, cePin)
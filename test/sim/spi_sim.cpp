@@ -0,0 +1,310 @@
+#include "spi_sim.h"
+#include <stdlib.h>
+
+void SimSpiSlave::pins(bool cs, bool sck, bool mosi) {
+    bool idleHigh = (mode & 0x02) != 0;
+    bool trailingSample = (mode & 0x01) != 0;
+    bool nowActive = cs != csActiveLow;
+
+    if (nowActive != active) {
+        active = nowActive;
+        if (sck != idleHigh) {
+            ++idleErrors;
+        }
+        if (active) {
+            ++transactions;
+            bits = 0;
+            if (!trailingSample) {
+                present(0);
+            }
+        } else if (bits) {
+            ++partialBytes;
+        }
+        lastSck = sck;
+        return;
+    }
+    if (!active || sck == lastSck) {
+        lastSck = sck;
+        return;
+    }
+    lastSck = sck;
+
+    bool leading = sck != idleHigh;
+    if (leading != trailingSample) {
+        if (lsbFirst) {
+            shiftIn = static_cast<uint8_t>((shiftIn >> 1) | (mosi ? 0x80 : 0x00));
+        } else {
+            shiftIn = static_cast<uint8_t>((shiftIn << 1) | (mosi ? 0x01 : 0x00));
+        }
+        if (++bits == 8) {
+            received.push_back(shiftIn);
+            bits = 0;
+        }
+    } else {
+        present(bits);
+    }
+}
+
+// MISO for bit index of the byte being shifted; index 0 loads the reply
+void SimSpiSlave::present(uint8_t index) {
+    if (index == 0) {
+        shiftOut = replies.empty() ? 0xFF : replies[received.size() % replies.size()];
+    }
+    miso = ((lsbFirst ? shiftOut >> index : shiftOut >> (7 - index)) & 0x01) != 0;
+}
+
+static HostRegister<uint8_t> pinReg;
+static HostRegister<uint8_t> ddrReg;
+static HostRegister<uint8_t> portReg;
+static SimSpiSlave *wired = nullptr;
+static bool lastSck = false;
+static bool timing = false;
+static double lastEdgeUs = 0;
+
+double SimSpiPort::minHighUs = 0;
+double SimSpiPort::minLowUs = 0;
+
+HostRegister<uint8_t> &SimSpiPort::pin() { return pinReg; }
+HostRegister<uint8_t> &SimSpiPort::ddr() { return ddrReg; }
+HostRegister<uint8_t> &SimSpiPort::port() { return portReg; }
+
+static void update() {
+    bool cs = (portReg.value & (1 << SimSpiPort::CS)) != 0;
+    bool sck = (portReg.value & (1 << SimSpiPort::SCK)) != 0;
+    bool mosi = (portReg.value & (1 << SimSpiPort::MOSI)) != 0;
+    bool wasSelected = wired->selected();
+    wired->pins(cs, sck, mosi);
+
+    if (!wired->selected()) {
+        timing = false;
+    } else if (!wasSelected) {
+        // The first phase runs from select, not from an edge; skip it
+        timing = false;
+        lastSck = sck;
+    } else if (sck != lastSck) {
+        if (timing) {
+            double phase = hostTimeUs - lastEdgeUs;
+            double &shortest = lastSck ? SimSpiPort::minHighUs : SimSpiPort::minLowUs;
+            if (shortest < 0 || phase < shortest) {
+                shortest = phase;
+            }
+        }
+        timing = true;
+        lastEdgeUs = hostTimeUs;
+        lastSck = sck;
+    }
+}
+
+// Writing 1 to a PINx bit toggles the PORTx bit
+static void writePin(uint8_t value) {
+    portReg.value ^= value;
+    update();
+}
+
+static void writePort(uint8_t value) {
+    portReg.value = value;
+    update();
+}
+
+static uint8_t readPin() {
+    uint8_t value = static_cast<uint8_t>(portReg.value & ~(1 << SimSpiPort::MISO));
+    if (wired->miso) {
+        value |= static_cast<uint8_t>(1 << SimSpiPort::MISO);
+    }
+    return value;
+}
+
+void SimSpiPort::attach(SimSpiSlave *slave) {
+    wired = slave;
+    pinReg.read = readPin;
+    pinReg.write = writePin;
+    portReg.write = writePort;
+    portReg.value = slave->csActiveLow ? static_cast<uint8_t>(1 << CS) : 0;
+    ddrReg.value = 0;
+    lastSck = false;
+    timing = false;
+    minHighUs = -1;
+    minLowUs = -1;
+}
+
+SimSpiBus simSpiBus;
+
+void SimSpiBus::attach() {
+    *this = SimSpiBus();
+    SPCR.value = 0;
+    SPCR.write = writeSpcr;
+    SPSR.value = 0;
+    SPSR.read = readSpsr;
+    SPSR.write = writeSpsr;
+    SPDR.value = 0;
+    SPDR.read = readSpdr;
+    SPDR.write = writeSpdr;
+    hostDelayHook = onDelay;
+}
+
+void SimSpiBus::addSlave(SimSpiSlave *slave, volatile uint8_t *csPort, uint8_t csBit) {
+    slaves.push_back(Wired{slave, csPort, static_cast<uint8_t>(1U << csBit)});
+}
+
+void SimSpiBus::wireSoftware(volatile uint8_t *sckPortParam, volatile uint8_t *sckPinParam, uint8_t sckBit,
+                             volatile uint8_t *mosiPortParam, uint8_t mosiBit, volatile uint8_t *misoPinParam,
+                             uint8_t misoBit) {
+    sckPort = sckPortParam;
+    sckPin = sckPinParam;
+    sckMask = static_cast<uint8_t>(1U << sckBit);
+    mosiPort = mosiPortParam;
+    mosiMask = static_cast<uint8_t>(1U << mosiBit);
+    misoPin = misoPinParam;
+    misoMask = static_cast<uint8_t>(1U << misoBit);
+}
+
+// SCK as the pin has it: the peripheral holds CPOL while it is enabled
+bool SimSpiBus::sckLevel() const {
+    if (SPCR.value & (1 << SPE)) {
+        return (SPCR.value & (1 << CPOL)) != 0;
+    }
+    return sckPort ? (*sckPort & sckMask) != 0 : lastSck;
+}
+
+// Chip select edges since the last look, before SCK moves again
+void SimSpiBus::syncSelects() {
+    bool sck = sckLevel();
+    for (size_t i = 0; i < slaves.size(); ++i) {
+        Wired &w = slaves[i];
+        bool cs = (*w.csPort & w.csMask) != 0;
+        if (w.slave->selected() != (cs != w.slave->csActiveLow)) {
+            w.slave->pins(cs, sck, lastMosi);
+        }
+    }
+}
+
+// Levels to every slave; returns MISO (pulled up when nobody drives it)
+bool SimSpiBus::feed(bool sck, bool mosi) {
+    lastSck = sck;
+    lastMosi = mosi;
+    bool miso = true;
+    for (size_t i = 0; i < slaves.size(); ++i) {
+        Wired &w = slaves[i];
+        w.slave->pins((*w.csPort & w.csMask) != 0, sck, mosi);
+        if (w.slave->selected()) {
+            miso = w.slave->miso;
+        }
+    }
+    return miso;
+}
+
+int SimSpiBus::selectedSlave() const {
+    for (size_t i = 0; i < slaves.size(); ++i) {
+        if (slaves[i].slave->selected()) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// One byte clocked by the peripheral in SPCR's mode and bit order
+uint8_t SimSpiBus::shift(uint8_t out) {
+    bool idleHigh = (SPCR & (1 << CPOL)) != 0;
+    bool trailingSample = (SPCR & (1 << CPHA)) != 0;
+    bool lsbFirst = (SPCR & (1 << DORD)) != 0;
+    uint8_t in = 0;
+    syncSelects();
+    feed(idleHigh, lastMosi);
+    for (uint8_t i = 0; i < 8; ++i) {
+        bool mosi = ((lsbFirst ? out >> i : out >> (7 - i)) & 0x01) != 0;
+        bool miso;
+        if (!trailingSample) {
+            feed(idleHigh, mosi);
+            miso = feed(!idleHigh, mosi);
+            feed(idleHigh, mosi);
+        } else {
+            feed(!idleHigh, mosi);
+            miso = feed(idleHigh, mosi);
+        }
+        if (miso) {
+            in |= static_cast<uint8_t>(lsbFirst ? 1U << i : 0x80U >> i);
+        }
+    }
+    return in;
+}
+
+void SimSpiBus::onDelay() {
+    SimSpiBus &bus = simSpiBus;
+    if (!bus.sckPin) {
+        return;
+    }
+    bus.syncSelects();
+    uint8_t toggles = static_cast<uint8_t>(*bus.sckPin & bus.sckMask);
+    *bus.sckPin &= static_cast<uint8_t>(~bus.sckMask);
+    *bus.sckPort ^= toggles;
+
+    bool hardwarePins = bus.sckPort == &PORTB && bus.sckMask == (1 << PB5);
+    if (hardwarePins && (SPCR & (1 << SPE))) {
+        return;
+    }
+    bool miso = bus.feed((*bus.sckPort & bus.sckMask) != 0, (*bus.mosiPort & bus.mosiMask) != 0);
+    if (miso) {
+        *bus.misoPin |= bus.misoMask;
+    } else {
+        *bus.misoPin &= static_cast<uint8_t>(~bus.misoMask);
+    }
+}
+
+void SimSpiBus::writeSpcr(uint8_t value) {
+    simSpiBus.syncSelects();
+    SPCR.value = value;
+}
+
+uint8_t SimSpiBus::readSpsr() {
+    SimSpiBus &bus = simSpiBus;
+    bus.cycles += bus.pollCycles;
+    if (bus.shifting && bus.cycles >= bus.doneAt) {
+        bus.shifting = false;
+        SPDR.value = bus.shifted;
+        SPSR.value |= static_cast<uint8_t>(1 << SPIF);
+    }
+    // Waiting for a byte that never started (SPDR written with SPE clear)
+    // would spin forever on the chip; fail the test instead
+    if (bus.shifting || (SPSR.value & (1 << SPIF))) {
+        bus.idlePolls = 0;
+    } else if (++bus.idlePolls > 100000) {
+        printf("SPSR polled with no transfer running (SPCR 0x%02X)\n", SPCR.value);
+        exit(1);
+    }
+    return SPSR.value;
+}
+
+// Only SPI2X is writable
+void SimSpiBus::writeSpsr(uint8_t value) {
+    SPSR.value = static_cast<uint8_t>((SPSR.value & ~(1 << SPI2X)) | (value & (1 << SPI2X)));
+}
+
+uint8_t SimSpiBus::readSpdr() {
+    SPSR.value &= static_cast<uint8_t>(~((1 << SPIF) | (1 << WCOL)));
+    return SPDR.value;
+}
+
+void SimSpiBus::writeSpdr(uint8_t value) {
+    SimSpiBus &bus = simSpiBus;
+    if (!(SPCR & (1 << SPE))) {
+        SPDR.value = value;
+        return;
+    }
+    if (bus.busy()) {
+        ++bus.collisions;
+        SPSR.value |= static_cast<uint8_t>(1 << WCOL);
+        return;
+    }
+    SPSR.value &= static_cast<uint8_t>(~((1 << SPIF) | (1 << WCOL)));
+
+    static const uint8_t DIVIDERS[4] = {4, 16, 64, 128};
+    uint32_t divider = DIVIDERS[SPCR & 0x03];
+    if (SPSR.value & (1 << SPI2X)) {
+        divider /= 2;
+    }
+    bus.shifted = bus.shift(value);
+    bus.transfers.push_back(Transfer{bus.cycles, SPCR, static_cast<uint8_t>(SPSR.value & (1 << SPI2X)), value,
+                                     bus.shifted, bus.selectedSlave()});
+    bus.shifting = true;
+    bus.doneAt = bus.cycles + 8 * divider;
+}
@@ -0,0 +1,141 @@
+// Simulated SPI slave for the SPI and SPIPins masters. The slave follows the
+// chip select, SCK and MOSI levels it is fed: it samples MOSI on its sampling
+// edge and moves MISO on the other one, in its own mode and bit order, so a
+// master clocking in the wrong mode or order reads and writes garbage.
+//
+// SimSpiBus is the rest of the bus for the pointer-based SPI class: slaves
+// on GPIO chip selects, the SPI peripheral and, for software masters, the
+// SCK/MOSI/MISO wiring.
+//
+// Chip select changes reach the slaves at the next SPCR write, SPDR write or
+// delay loop, against the SCK level from before it (CPOL while SPE is set).
+// Writing SPDR with SPE set starts a byte lasting 8 SCK periods at the
+// SPCR/SPSR divider, and the peripheral clocks it through the slaves bit by
+// bit in SPCR's mode and bit order. SPIF shows on the first SPSR read after
+// the byte is done; every read costs pollCycles. SPDR written while a byte
+// shifts is a write collision: WCOL is set, the count goes up and the byte is
+// dropped.
+//
+// A software master changes its pins between delay loops, so the bus samples
+// them in the delay hook: SCK toggles stored to PINx are applied to PORTx,
+// the slaves see the levels and MISO goes to its PINx bit. Both phase delays
+// must be nonzero. A PINx toggle store also overwrites MISO when they share
+// a port, which the mode 0/2 kernels never read back, so only those modes may
+// share. While SPE is set the peripheral owns PB3/PB5 and software levels on
+// them never reach the slaves.
+//
+// SimSpiPort is a GPIO port for SPIPins with one slave wired to it the way
+// the hardware pins sit on PORTB (CS bit 2, MOSI 3, MISO 4, SCK 5). Its
+// registers are HostRegisters, so the slave sees every edge, including the
+// ones from the unrolled zero-delay kernels.
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <avr/io.h>
+#include "host.h"
+
+struct SimSpiSlave {
+    uint8_t mode = 0; // CPOL in bit 1, CPHA in bit 0
+    bool lsbFirst = false;
+    bool csActiveLow = true;
+
+    // Byte n shifted out is replies[n % size], or 0xFF with no replies
+    std::vector<uint8_t> replies;
+    std::vector<uint8_t> received;
+    long transactions = 0;
+    long partialBytes = 0; // deselected with a byte half shifted
+    long idleErrors = 0;   // selected or deselected with SCK off its idle level
+    bool miso = true;
+
+    // Current pin levels; edges are found against the previous call
+    void pins(bool cs, bool sck, bool mosi);
+    bool selected() const { return active; }
+
+private:
+    bool active = false;
+    bool lastSck = false;
+    uint8_t bits = 0;
+    uint8_t shiftIn = 0;
+    uint8_t shiftOut = 0xFF;
+
+    void present(uint8_t index);
+};
+
+struct SimSpiPort {
+    static const uint8_t CS = 2;
+    static const uint8_t MOSI = 3;
+    static const uint8_t MISO = 4;
+    static const uint8_t SCK = 5;
+
+    static HostRegister<uint8_t> &pin();
+    static HostRegister<uint8_t> &ddr();
+    static HostRegister<uint8_t> &port();
+
+    // Clears the port, wires the slave and installs the register hooks
+    static void attach(SimSpiSlave *slave);
+
+    // Shortest SCK high and low phases inside a transaction, in microseconds
+    static double minHighUs;
+    static double minLowUs;
+};
+
+struct SimSpiBus {
+    struct Transfer {
+        uint64_t start;
+        uint8_t spcr;
+        uint8_t spsr;
+        uint8_t out;
+        uint8_t in;
+        int slave; // addSlave() index of the selected slave, -1 for none
+    };
+
+    uint64_t cycles = 0;
+    uint32_t pollCycles = 3;
+    long collisions = 0;
+    std::vector<Transfer> transfers;
+
+    // Clears the bus and installs the SPSR/SPDR hooks and the delay hook
+    void attach();
+    void addSlave(SimSpiSlave *slave, volatile uint8_t *csPort, uint8_t csBit);
+    void wireSoftware(volatile uint8_t *sckPort, volatile uint8_t *sckPin, uint8_t sckBit,
+                      volatile uint8_t *mosiPort, uint8_t mosiBit, volatile uint8_t *misoPin, uint8_t misoBit);
+
+    // True while the peripheral is shifting a byte
+    bool busy() const { return shifting && cycles < doneAt; }
+
+private:
+    struct Wired {
+        SimSpiSlave *slave;
+        volatile uint8_t *csPort;
+        uint8_t csMask;
+    };
+    std::vector<Wired> slaves;
+    volatile uint8_t *sckPort = nullptr;
+    volatile uint8_t *sckPin = nullptr;
+    uint8_t sckMask = 0;
+    volatile uint8_t *mosiPort = nullptr;
+    uint8_t mosiMask = 0;
+    volatile uint8_t *misoPin = nullptr;
+    uint8_t misoMask = 0;
+    bool shifting = false;
+    uint64_t doneAt = 0;
+    uint8_t shifted = 0;
+    long idlePolls = 0;
+    bool lastSck = false;
+    bool lastMosi = false;
+
+    bool sckLevel() const;
+    void syncSelects();
+    bool feed(bool sck, bool mosi);
+    int selectedSlave() const;
+    uint8_t shift(uint8_t out);
+
+    static void onDelay();
+    static void writeSpcr(uint8_t value);
+    static uint8_t readSpsr();
+    static void writeSpsr(uint8_t value);
+    static uint8_t readSpdr();
+    static void writeSpdr(uint8_t value);
+};
+
+extern SimSpiBus simSpiBus;
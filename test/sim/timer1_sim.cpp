@@ -0,0 +1,194 @@
+#include "timer1_sim.h"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <protocol_UART.h>
+
+extern "C" void TIMER1_COMPA_vect(void);
+extern "C" void TIMER1_COMPB_vect(void);
+extern "C" void PCINT0_vect(void);
+extern "C" void PCINT1_vect(void);
+extern "C" void PCINT2_vect(void);
+
+SimTimer1 simTimer1;
+
+void SimTimer1::attach() {
+    *this = SimTimer1();
+    TIFR1.value = 0;
+    TIFR1.read = readTifr1;
+    TIFR1.write = writeTifr1;
+    TCNT1.read = readTcnt1;
+    TIMSK1 = 0;
+    OCR1A = 0;
+    OCR1B = 0;
+    PCICR = 0;
+    PCIFR = 0;
+    PCMSK0 = PCMSK1 = PCMSK2 = 0;
+    PINB = PINC = PIND = 0xFF;
+    PORTB = PORTC = PORTD = 0;
+    SREG = 0;
+
+    // Constructors register every UART; start each scenario empty
+    UART::countPCINT0 = UART::countPCINT1 = UART::countPCINT2 = 0;
+    UART::countTimerTx = 0;
+    UART::countTimerRx = 0;
+    UART::txActive = nullptr;
+    UART::txBitIndex = 0;
+    UART::lastPINB = UART::lastPINC = UART::lastPIND = 0xFF;
+}
+
+void SimTimer1::watch(volatile uint8_t *port, uint8_t bit) {
+    uint8_t mask = static_cast<uint8_t>(1U << bit);
+    watched.push_back(Watched{port, mask, (*port & mask) != 0});
+}
+
+void SimTimer1::drive(uint64_t cycle, volatile uint8_t *pinReg, uint8_t bit, bool high) {
+    inputs.insert(std::make_pair(cycle, Drive{pinReg, static_cast<uint8_t>(1U << bit), high}));
+}
+
+uint64_t SimTimer1::driveUartFrame(uint64_t cycle, volatile uint8_t *pinReg, uint8_t bit, uint8_t value,
+                                   double cyclesPerBit) {
+    drive(cycle, pinReg, bit, false);
+    for (uint8_t i = 0; i < 8; ++i) {
+        drive(cycle + static_cast<uint64_t>((i + 1) * cyclesPerBit + 0.5), pinReg, bit, (value >> i) & 1);
+    }
+    drive(cycle + static_cast<uint64_t>(9 * cyclesPerBit + 0.5), pinReg, bit, true);
+    return cycle + static_cast<uint64_t>(10 * cyclesPerBit + 0.5);
+}
+
+// First cycle after the flags' horizon at which TCNT1 equals compare
+uint64_t SimTimer1::nextMatch(uint16_t compare) const {
+    uint16_t ahead = static_cast<uint16_t>(compare - static_cast<uint16_t>(flagsUpTo));
+    return flagsUpTo + (ahead ? ahead : 0x10000);
+}
+
+void SimTimer1::update() {
+    // Compare values are read at the end of the window; windows stay short
+    // because every register access and vector calls update()
+    while (!inputs.empty() && inputs.begin()->first <= cycles) {
+        const Drive &in = inputs.begin()->second;
+        uint8_t before = *in.pinReg;
+        if (in.high) {
+            *in.pinReg |= in.mask;
+        } else {
+            *in.pinReg &= static_cast<uint8_t>(~in.mask);
+        }
+        if (before != *in.pinReg) {
+            if (in.pinReg == &PINB && (PCMSK0 & in.mask)) {
+                PCIFR |= (1 << PCIF0);
+            } else if (in.pinReg == &PINC && (PCMSK1 & in.mask)) {
+                PCIFR |= (1 << PCIF1);
+            } else if (in.pinReg == &PIND && (PCMSK2 & in.mask)) {
+                PCIFR |= (1 << PCIF2);
+            }
+        }
+        inputs.erase(inputs.begin());
+    }
+
+    if (cycles > flagsUpTo) {
+        uint64_t matchA = nextMatch(OCR1A);
+        if (matchA <= cycles) {
+            TIFR1.value |= (1 << OCF1A);
+            lastMatchA = matchA + ((cycles - matchA) & ~0xFFFFULL);
+        }
+        if (nextMatch(OCR1B) <= cycles) {
+            TIFR1.value |= (1 << OCF1B);
+        }
+        if ((flagsUpTo >> 16) != (cycles >> 16)) {
+            TIFR1.value |= (1 << TOV1);
+        }
+        flagsUpTo = cycles;
+    }
+}
+
+void SimTimer1::probe() {
+    for (size_t i = 0; i < watched.size(); ++i) {
+        bool high = (*watched[i].port & watched[i].mask) != 0;
+        if (high != watched[i].high) {
+            watched[i].high = high;
+            edges.push_back(Edge{lastMatchA, static_cast<uint8_t>(i), high});
+        }
+    }
+}
+
+void SimTimer1::vector(void (*handler)(), long &count) {
+    ++count;
+    cycles += isrEntryCycles;
+    update();
+    handler();
+    update();
+    probe();
+    cycles += isrCycles;
+}
+
+// One vector per call, highest priority first
+bool SimTimer1::dispatch() {
+    if (!(SREG & (1 << SREG_I))) {
+        return false;
+    }
+    static void (*const pinChange[3])() = {PCINT0_vect, PCINT1_vect, PCINT2_vect};
+    for (uint8_t group = 0; group < 3; ++group) {
+        if ((PCIFR & (1 << group)) && (PCICR & (1 << group))) {
+            PCIFR &= static_cast<uint8_t>(~(1 << group));
+            vector(pinChange[group], pinChangeVectors);
+            return true;
+        }
+    }
+    if ((TIFR1.value & (1 << OCF1A)) && (TIMSK1 & (1 << OCIE1A))) {
+        TIFR1.value &= static_cast<uint8_t>(~(1 << OCF1A));
+        vector(TIMER1_COMPA_vect, compAVectors);
+        return true;
+    }
+    if ((TIFR1.value & (1 << OCF1B)) && (TIMSK1 & (1 << OCIE1B))) {
+        TIFR1.value &= static_cast<uint8_t>(~(1 << OCF1B));
+        vector(TIMER1_COMPB_vect, compBVectors);
+        return true;
+    }
+    return false;
+}
+
+uint64_t SimTimer1::nextEvent(uint64_t until) const {
+    uint64_t next = until;
+    if (!inputs.empty() && inputs.begin()->first < next) {
+        next = inputs.begin()->first;
+    }
+    if ((TIMSK1 & (1 << OCIE1A)) && nextMatch(OCR1A) < next) {
+        next = nextMatch(OCR1A);
+    }
+    if ((TIMSK1 & (1 << OCIE1B)) && nextMatch(OCR1B) < next) {
+        next = nextMatch(OCR1B);
+    }
+    return next;
+}
+
+void SimTimer1::run(uint64_t until, bool (*idle)()) {
+    for (;;) {
+        update();
+        if (dispatch()) {
+            continue;
+        }
+        if (cycles >= until || (idle && idle())) {
+            return;
+        }
+        uint64_t next = nextEvent(until);
+        cycles = next > cycles ? next : cycles + 1;
+    }
+}
+
+uint8_t SimTimer1::readTifr1() {
+    if (!(SREG & (1 << SREG_I))) {
+        simTimer1.cycles += simTimer1.pollCycles;
+    }
+    simTimer1.update();
+    simTimer1.probe();
+    return TIFR1.value;
+}
+
+void SimTimer1::writeTifr1(uint8_t value) {
+    simTimer1.update();
+    TIFR1.value &= static_cast<uint8_t>(~value);
+}
+
+uint16_t SimTimer1::readTcnt1() {
+    simTimer1.update();
+    return static_cast<uint16_t>(simTimer1.cycles);
+}
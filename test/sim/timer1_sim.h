@@ -0,0 +1,85 @@
+// Simulated Timer1 (normal mode, clk/1) and pin-change interrupts, for the
+// software UART's timer engines. Time is counted in CPU cycles, which are
+// Timer1 ticks at clk/1.
+//
+// TCNT1 reads the cycle counter. OCR1A/OCR1B matches and overflows set
+// their TIFR1 flags, and a 1 written to a flag clears it. run() dispatches
+// PCINT0..2, TIMER1_COMPA and TIMER1_COMPB in AVR priority order while
+// SREG's I bit is set. Each vector costs isrEntryCycles before the handler
+// runs and isrCycles after it returns. With I clear, every TIFR1 read costs
+// pollCycles, so flushTx()-style polling moves the clock on.
+//
+// Inputs are scheduled levels on PINx bits (drive(), driveUartFrame()).
+// Outputs are PORTx bits under watch(). Their edges are stamped with the
+// COMPA match that produced them, which is exact for the TX engine, whose
+// pins only change in the COMPA handler.
+#pragma once
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "host.h"
+
+struct SimTimer1 {
+    uint64_t cycles = 0;
+
+    uint32_t isrEntryCycles = 20;
+    uint32_t isrCycles = 60;
+    uint32_t pollCycles = 8;
+
+    // Vectors dispatched so far
+    long compAVectors = 0;
+    long compBVectors = 0;
+    long pinChangeVectors = 0;
+
+    struct Edge {
+        uint64_t cycle;
+        uint8_t watch; // index into watch() order
+        bool high;
+    };
+    std::vector<Edge> edges;
+
+    // Installs the register hooks and clears all timer, pin-change and
+    // UART registry state
+    void attach();
+
+    void watch(volatile uint8_t *port, uint8_t bit);
+    void drive(uint64_t cycle, volatile uint8_t *pinReg, uint8_t bit, bool high);
+    // 8N1 frame starting at cycle; returns the cycle the stop bit ends
+    uint64_t driveUartFrame(uint64_t cycle, volatile uint8_t *pinReg, uint8_t bit, uint8_t value,
+                            double cyclesPerBit);
+
+    // Runs to the cycle given, or until idle() is true between vectors
+    void run(uint64_t until, bool (*idle)() = nullptr);
+
+    // Brings flags and inputs up to the current cycle
+    void update();
+
+private:
+    struct Watched {
+        volatile uint8_t *port;
+        uint8_t mask;
+        bool high;
+    };
+    struct Drive {
+        volatile uint8_t *pinReg;
+        uint8_t mask;
+        bool high;
+    };
+
+    uint64_t flagsUpTo = 0;
+    uint64_t lastMatchA = 0;
+    std::vector<Watched> watched;
+    std::multimap<uint64_t, Drive> inputs;
+
+    uint64_t nextMatch(uint16_t compare) const;
+    uint64_t nextEvent(uint64_t until) const;
+    bool dispatch();
+    void vector(void (*handler)(), long &count);
+    void probe();
+
+    static uint8_t readTifr1();
+    static void writeTifr1(uint8_t value);
+    static uint16_t readTcnt1();
+};
+
+extern SimTimer1 simTimer1;
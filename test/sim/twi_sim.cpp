@@ -0,0 +1,190 @@
+#include "twi_sim.h"
+#include <string.h>
+
+extern "C" void TWI_vect(void);
+
+SimTwiSlave::SimTwiSlave() {
+    memset(regs, 0, sizeof(regs));
+}
+
+SimTwiBus simTwiBus;
+
+void SimTwiBus::attach() {
+    *this = SimTwiBus();
+    TWCR.value = 0;
+    TWCR.read = readTwcr;
+    TWCR.write = writeTwcr;
+    TWSR = 0xF8;
+    TWDR = 0;
+    hostDelayHook = onDelay;
+}
+
+void SimTwiBus::addSlave(SimTwiSlave *slave) {
+    slaves.push_back(slave);
+}
+
+double SimTwiBus::sclPeriodUs() {
+    uint32_t prescaler = 1UL << (2 * (TWSR & 0x03));
+    return (16 + 2UL * TWBR * prescaler) / (F_CPU / 1000000.0);
+}
+
+void SimTwiBus::note(const char *text) {
+    if (!trace.empty()) {
+        trace += ' ';
+    }
+    trace += text;
+}
+
+// A step written to TWCR at the given time
+void SimTwiBus::start(uint8_t control, double at) {
+    double period = sclPeriodUs();
+    received = false;
+    if (control & (1 << TWSTO)) {
+        if (owner) {
+            note("P");
+        }
+        owner = false;
+        phase = Phase::Idle;
+        at += period;
+        if (!(control & (1 << TWSTA))) {
+            nextStatus = 0xF8;
+            pending = true;
+            doneAt = at;
+            return;
+        }
+    }
+
+    if (busErrorNext) {
+        busErrorNext = false;
+        note("E");
+        owner = false;
+        phase = Phase::Idle;
+        nextStatus = 0x00;
+        at += period;
+    } else if (control & (1 << TWSTA)) {
+        note(owner ? "Sr" : "S");
+        nextStatus = owner ? 0x10 : 0x08;
+        owner = true;
+        phase = Phase::Address;
+        at += period;
+    } else {
+        step(control, at);
+        at += 9 * period;
+    }
+    pending = true;
+    doneAt = at;
+}
+
+// One byte on the bus
+void SimTwiBus::step(uint8_t control, double at) {
+    char text[8];
+    bool ack = false;
+    switch (phase) {
+        case Phase::Address: {
+            bool read = (TWDR & 0x01) != 0;
+            addressed = nullptr;
+            for (size_t i = 0; i < slaves.size(); ++i) {
+                if (slaves[i]->address == (TWDR >> 1)) {
+                    addressed = slaves[i];
+                }
+            }
+            ack = addressed != nullptr;
+            if (ack) {
+                ++addressed->transactions;
+                writeIndex = 0;
+            }
+            snprintf(text, sizeof(text), "%02X%c", TWDR, ack ? '+' : '-');
+            nextStatus = read ? (ack ? 0x40 : 0x48) : (ack ? 0x18 : 0x20);
+            phase = ack ? (read ? Phase::Receive : Phase::Transmit) : Phase::Stopped;
+            break;
+        }
+
+        case Phase::Transmit:
+            ack = writeIndex != addressed->nackAt;
+            if (ack && writeIndex == 0) {
+                addressed->pointer = TWDR;
+            } else if (ack) {
+                addressed->regs[addressed->pointer++] = TWDR;
+            }
+            ++writeIndex;
+            snprintf(text, sizeof(text), "%02X%c", TWDR, ack ? '+' : '-');
+            nextStatus = ack ? 0x28 : 0x30;
+            phase = ack ? Phase::Transmit : Phase::Stopped;
+            break;
+
+        case Phase::Receive:
+            ack = (control & (1 << TWEA)) != 0;
+            nextTwdr = addressed->regs[addressed->pointer++];
+            received = true;
+            snprintf(text, sizeof(text), "r%c", ack ? '+' : '-');
+            nextStatus = ack ? 0x50 : 0x58;
+            phase = ack ? Phase::Receive : Phase::Stopped;
+            break;
+
+        default: // a byte with no addressed slave: nothing on the chip answers
+            snprintf(text, sizeof(text), "?");
+            nextStatus = 0x00;
+            break;
+    }
+    note(text);
+}
+
+void SimTwiBus::finish() {
+    pending = false;
+    TWCR.value &= static_cast<uint8_t>(~(1 << TWSTO));
+    TWSR = static_cast<uint8_t>((TWSR & 0x03) | nextStatus);
+    if (nextStatus == 0xF8) {
+        return; // STOP done, no TWINT
+    }
+    if (received) {
+        TWDR = nextTwdr;
+    }
+    TWCR.value |= static_cast<uint8_t>(1 << TWINT);
+}
+
+void SimTwiBus::onDelay() {
+    SimTwiBus &bus = simTwiBus;
+    while (bus.pending && bus.doneAt <= hostTimeUs) {
+        double at = bus.doneAt;
+        bus.finish();
+        if ((TWCR.value & (1 << TWIE)) && (TWCR.value & (1 << TWINT))) {
+            ++bus.interrupts;
+            bus.inInterrupt = true;
+            bus.interruptAt = at;
+            TWI_vect();
+            bus.inInterrupt = false;
+        }
+    }
+}
+
+uint8_t SimTwiBus::readTwcr() {
+    SimTwiBus &bus = simTwiBus;
+    if (bus.pending && !bus.inInterrupt) {
+        hostTimeUs += bus.pollCycles / (F_CPU / 1000000.0);
+        if (hostTimeUs >= bus.doneAt) {
+            bus.finish();
+        }
+    }
+    return TWCR.value;
+}
+
+// TWINT is cleared by writing a one; with it the write starts a step
+void SimTwiBus::writeTwcr(uint8_t value) {
+    SimTwiBus &bus = simTwiBus;
+    double at = bus.inInterrupt ? bus.interruptAt : hostTimeUs;
+    if (bus.pending) {
+        // Only a STOP can still be going out when the library writes
+        at = bus.doneAt > at ? bus.doneAt : at;
+        bus.finish();
+    }
+    uint8_t flag = (value & (1 << TWINT)) ? 0 : static_cast<uint8_t>(TWCR.value & (1 << TWINT));
+    TWCR.value = static_cast<uint8_t>((value & ~(1 << TWINT)) | flag);
+    if (!(value & (1 << TWEN))) {
+        bus.owner = false;
+        bus.phase = Phase::Idle;
+        return;
+    }
+    if (value & (1 << TWINT)) {
+        bus.start(value, at);
+    }
+}
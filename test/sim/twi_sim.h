@@ -0,0 +1,83 @@
+// Simulated TWI peripheral and I2C bus for the real protocol_I2C.cpp.
+//
+// Writing TWCR with TWINT set starts the step its bits and the bus state ask
+// for: START (status 0x08, or 0x10 while the master still owns the bus), an
+// address or data byte out of TWDR (0x18/0x20, 0x28/0x30, 0x40/0x48), a byte
+// in with ACK or NACK per TWEA (0x50/0x58), or STOP. The step takes bus time
+// from TWBR and the TWSR prescaler (SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS)):
+// one SCL period for a START or STOP condition, nine for a byte. TWINT, TWSR
+// and a received TWDR show when it is done; a STOP clears TWSTO instead.
+//
+// Time moves in two ways. Each TWCR read while a step runs costs pollCycles,
+// so blocking transfers spin the way twiWait() does. Delays (the host delay
+// hook) finish every step due by then and, with TWIE set, run TWI_vect at
+// the time TWINT rose, so the interrupt-driven queue runs behind _delay_us()
+// in a test's main loop. A STOP+START written together, or a START written
+// while a STOP is still going out, follows the STOP.
+//
+// Slaves are register files with an auto-incrementing pointer: the first
+// byte after SLA+W sets it, later bytes write, reads read. Every condition
+// and byte goes to a trace, e.g. readRegisters(0x68, 0x3B, buf, 2) is
+// "S D0+ 3B+ Sr D1+ r+ r- P" (written bytes in hex, read bytes as r, then
+// + for ACK and - for NACK).
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <avr/io.h>
+#include "host.h"
+
+struct SimTwiSlave {
+    uint8_t address = 0x68;
+    uint8_t regs[256];
+    uint8_t pointer = 0;
+    // Byte of a write (0 = register address) the slave NACKs, -1 for none
+    int nackAt = -1;
+    long transactions = 0; // SLA+W or SLA+R it ACKed
+
+    SimTwiSlave();
+};
+
+struct SimTwiBus {
+    uint32_t pollCycles = 5;
+    // The next step ends in a bus error (status 0x00) and loses the bus
+    bool busErrorNext = false;
+    long interrupts = 0;
+    std::string trace;
+
+    // Clears the bus and installs the TWCR hooks and the delay hook
+    void attach();
+    void addSlave(SimTwiSlave *slave);
+
+    // True while a step is on the bus
+    bool busy() const { return pending; }
+    // SCL period from TWBR and the prescaler, in microseconds
+    static double sclPeriodUs();
+
+private:
+    enum class Phase { Idle, Address, Transmit, Receive, Stopped };
+
+    std::vector<SimTwiSlave *> slaves;
+    SimTwiSlave *addressed = nullptr;
+    int writeIndex = 0;
+    Phase phase = Phase::Idle;
+    bool owner = false;
+    bool pending = false;
+    double doneAt = 0;
+    uint8_t nextStatus = 0;
+    uint8_t nextTwdr = 0;
+    bool received = false;
+    bool inInterrupt = false;
+    double interruptAt = 0;
+
+    void note(const char *text);
+    void start(uint8_t control, double at);
+    void step(uint8_t control, double at);
+    void finish();
+
+    static void onDelay();
+    static uint8_t readTwcr();
+    static void writeTwcr(uint8_t value);
+};
+
+extern SimTwiBus simTwiBus;
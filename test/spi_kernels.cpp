@@ -0,0 +1,200 @@
+// SPI class transfer kernels and selectKernel().
+//
+// Paced kernels run on PORTD (CS PD2, MOSI PD3, SCK PD5) with MISO on PC0,
+// sampled bit by bit by SimSpiBus, for every mode and bit order; each byte
+// must take exactly the delay loops its kernel spends per bit. The unrolled
+// zero-delay kernels have no delay for the bus to sample at, so they run
+// with MISO wired back to MOSI: every byte must come back unchanged and take
+// no delay time, which also shows selectKernel() picked them.
+//
+// The hardware bursts (writeBytes(), both readBytes()) run on the
+// peripheral at F_CPU/2: no write collisions, every byte started within one
+// SPSR poll of the previous one finishing, bytes in order both ways, and the
+// readBytes() handler for byte i running while byte i + 1 shifts.
+#include <string.h>
+#include <protocol_SPI.h>
+#include "spi_sim.h"
+
+static const size_t LENGTH = 32;
+
+static double cyclesSince(double startUs) {
+    return (hostTimeUs - startUs) * (F_CPU / 1000000.0);
+}
+
+static void fill(uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        data[i] = static_cast<uint8_t>(hostRandom() * 256);
+    }
+}
+
+static void paced() {
+    const uint16_t LOW = 3;
+    const uint16_t HIGH = 5;
+    for (uint8_t mode = 0; mode < 4; ++mode) {
+        for (uint8_t order = 0; order < 2; ++order) {
+            SimSpiSlave slave;
+            slave.mode = mode;
+            slave.lsbFirst = order;
+            slave.replies.resize(LENGTH);
+            fill(slave.replies.data(), LENGTH);
+            simSpiBus.attach();
+            simSpiBus.wireSoftware(&PORTD, &PIND, PD5, &PORTD, PD3, &PINC, PC0);
+            simSpiBus.addSlave(&slave, &PORTD, PD2);
+            PORTD = PIND = PINC = 0;
+
+            SPI spi(&PIND, &DDRD, &PORTD, PD3, &PINC, &DDRC, &PORTC, PC0, &PIND, &DDRD, &PORTD, PD5,
+                    &PIND, &DDRD, &PORTD, PD2);
+            spi.begin();
+            spi.setDataMode(mode);
+            spi.setBitOrder(order ? SPI::BitOrder::LSBFirst : SPI::BitOrder::MSBFirst);
+            spi.setDelayLoops(LOW, HIGH);
+
+            uint8_t tx[LENGTH];
+            uint8_t rx[LENGTH];
+            fill(tx, LENGTH);
+            double start = hostTimeUs;
+            spi.transferBytes(tx, rx, LENGTH);
+            double perByte = cyclesSince(start) / LENGTH;
+
+            // Leading-edge kernels wait low, high, low per bit; trailing-edge
+            // ones high, low, high
+            double expected = 8 * 4.0 * ((mode & 0x01) ? LOW + 2 * HIGH : 2 * LOW + HIGH);
+            bool sentOk = slave.received.size() == LENGTH && memcmp(slave.received.data(), tx, LENGTH) == 0;
+            bool readOk = memcmp(rx, slave.replies.data(), LENGTH) == 0;
+            printf("paced  mode %u %s  sent %s, read %s, %.0f cycles/byte, idle errors %ld\n", mode,
+                   order ? "LSB" : "MSB", sentOk ? "ok" : "BAD", readOk ? "ok" : "BAD", perByte, slave.idleErrors);
+            EXPECT(sentOk && readOk);
+            EXPECT(slave.transactions == 1 && slave.idleErrors == 0 && slave.partialBytes == 0);
+            EXPECT(perByte > expected - 1e-6 && perByte < expected + 1e-6);
+        }
+    }
+}
+
+static void fast() {
+    simSpiBus.attach();
+    for (uint8_t mode = 0; mode < 4; ++mode) {
+        for (uint8_t order = 0; order < 2; ++order) {
+            PORTD = PIND = 0;
+            // MISO is the MOSI output latch
+            SPI spi(&PIND, &DDRD, &PORTD, PD3, &PORTD, &DDRD, &PORTD, PD3, &PIND, &DDRD, &PORTD, PD5,
+                    &PIND, &DDRD, &PORTD, PD2);
+            spi.begin();
+            spi.setDataMode(mode);
+            spi.setBitOrder(order ? SPI::BitOrder::LSBFirst : SPI::BitOrder::MSBFirst);
+            spi.setDelayLoops(0, 0);
+
+            uint8_t tx[LENGTH];
+            uint8_t rx[LENGTH];
+            fill(tx, LENGTH);
+            double start = hostTimeUs;
+            spi.transferBytes(tx, rx, LENGTH);
+            double fastCycles = cyclesSince(start);
+
+            // Back to paced and fast again: the kernel follows the delays
+            spi.setDelayLoops(1, 1);
+            start = hostTimeUs;
+            uint8_t pacedEcho = spi.transferByte(0xA5);
+            double pacedCycles = cyclesSince(start);
+            spi.setDelayLoops(0, 0);
+            start = hostTimeUs;
+            uint8_t fastEcho = spi.transferByte(0x5A);
+            fastCycles += cyclesSince(start);
+
+            bool echoOk = memcmp(rx, tx, LENGTH) == 0 && pacedEcho == 0xA5 && fastEcho == 0x5A;
+            printf("fast   mode %u %s  loopback %s, delay cycles %.0f (paced byte %.0f)\n", mode,
+                   order ? "LSB" : "MSB", echoOk ? "ok" : "BAD", fastCycles, pacedCycles);
+            EXPECT(echoOk);
+            EXPECT(fastCycles == 0 && pacedCycles > 0);
+        }
+    }
+}
+
+struct HandlerLog {
+    size_t next;
+    bool inOrder;
+    long whileShifting;
+    uint8_t values[LENGTH];
+};
+
+static void logByte(size_t index, uint8_t value, void *context) {
+    HandlerLog *log = static_cast<HandlerLog *>(context);
+    log->inOrder = log->inOrder && index == log->next;
+    log->next = index + 1;
+    log->values[index] = value;
+    if (simSpiBus.busy()) {
+        ++log->whileShifting;
+    }
+}
+
+// Longest gap between one byte finishing and the next starting, in cycles
+static uint64_t longestGap(size_t from, uint64_t byteCycles) {
+    uint64_t longest = 0;
+    for (size_t i = from + 1; i < simSpiBus.transfers.size(); ++i) {
+        uint64_t gap = simSpiBus.transfers[i].start - simSpiBus.transfers[i - 1].start - byteCycles;
+        longest = gap > longest ? gap : longest;
+    }
+    return longest;
+}
+
+static void hardwareBursts() {
+    SimSpiSlave slave;
+    slave.replies.resize(3 * LENGTH);
+    fill(slave.replies.data(), slave.replies.size());
+    simSpiBus.attach();
+    simSpiBus.addSlave(&slave, &PORTB, PB2);
+    PORTB = (1 << PB2);
+
+    SPI spi(&PINB, &DDRB, &PORTB, PB3, &PINB, &DDRB, &PORTB, PB4, &PINB, &DDRB, &PORTB, PB5,
+            &PINB, &DDRB, &PORTB, PB2);
+    spi.begin();
+    EXPECT(spi.setBackend(SPI::Backend::Hardware));
+    spi.setClockHz(8000000UL);
+    const uint64_t byteCycles = 16;
+
+    uint8_t tx[LENGTH];
+    fill(tx, LENGTH);
+    spi.writeBytes(tx, LENGTH);
+    uint64_t writeGap = longestGap(0, byteCycles);
+
+    uint8_t rx[LENGTH];
+    size_t readFrom = simSpiBus.transfers.size();
+    spi.readBytes(rx, LENGTH);
+    uint64_t readGap = longestGap(readFrom, byteCycles);
+
+    HandlerLog log = {0, true, 0, {0}};
+    size_t handlerFrom = simSpiBus.transfers.size();
+    spi.readBytes(logByte, &log, LENGTH);
+    uint64_t handlerGap = longestGap(handlerFrom, byteCycles);
+
+    bool writeOk = slave.received.size() == 3 * LENGTH && memcmp(slave.received.data(), tx, LENGTH) == 0;
+    bool clockedOnes = true;
+    for (size_t i = LENGTH; i < slave.received.size(); ++i) {
+        clockedOnes = clockedOnes && slave.received[i] == 0xFF;
+    }
+    bool readOk = memcmp(rx, slave.replies.data() + LENGTH, LENGTH) == 0;
+    bool handlerOk = log.next == LENGTH && log.inOrder &&
+                     memcmp(log.values, slave.replies.data() + 2 * LENGTH, LENGTH) == 0;
+
+    printf("hardware writeBytes     %s, longest gap %llu cycles\n", writeOk ? "ok" : "BAD",
+           static_cast<unsigned long long>(writeGap));
+    printf("hardware readBytes      %s, longest gap %llu cycles\n", readOk && clockedOnes ? "ok" : "BAD",
+           static_cast<unsigned long long>(readGap));
+    printf("hardware readBytes(fn)  %s, longest gap %llu cycles, %ld of %u handler calls while the next byte "
+           "shifts\n", handlerOk ? "ok" : "BAD", static_cast<unsigned long long>(handlerGap), log.whileShifting,
+           static_cast<unsigned>(LENGTH));
+    printf("write collisions %ld\n", simSpiBus.collisions);
+    EXPECT(writeOk && readOk && clockedOnes && handlerOk);
+    EXPECT(simSpiBus.collisions == 0);
+    EXPECT(slave.transactions == 3 && slave.partialBytes == 0);
+    EXPECT(writeGap < simSpiBus.pollCycles && readGap < simSpiBus.pollCycles &&
+           handlerGap < simSpiBus.pollCycles);
+    EXPECT(log.whileShifting == static_cast<long>(LENGTH) - 1);
+}
+
+int main() {
+    hostSeed(8);
+    paced();
+    fast();
+    hardwareBursts();
+    return hostFailures();
+}
@@ -0,0 +1,159 @@
+// SPI's integer timing helpers. The constexpr results are pinned with
+// static_asserts at each hardware divider (F_CPU/2..F_CPU/128) and on both
+// sides of every rounding edge; sweeps then check the rules for every value
+// around them: the hardware divider is the fastest one not above the
+// request, delay loops never make a phase shorter than asked and are never
+// one loop longer than needed, and out-of-range requests clamp. Also checks
+// that setClock<SPIClock<Hz>>() and setClockHz(Hz) configure the same
+// peripheral setup, and that setDelaysMicroseconds() rejects floating point.
+#include <utility>
+#include <protocol_SPI.h>
+#include "spi_sim.h"
+
+static_assert(F_CPU == 16000000UL, "the pinned values below are for 16 MHz");
+
+// SPR1:SPR0 in bits 1:0, SPI2X in bit 7
+static_assert(SPI::hardwareClockBits(8000000UL) == 0x80, "F_CPU/2");
+static_assert(SPI::hardwareClockBits(4000000UL) == 0x00, "F_CPU/4");
+static_assert(SPI::hardwareClockBits(2000000UL) == 0x81, "F_CPU/8");
+static_assert(SPI::hardwareClockBits(1000000UL) == 0x01, "F_CPU/16");
+static_assert(SPI::hardwareClockBits(500000UL) == 0x82, "F_CPU/32");
+static_assert(SPI::hardwareClockBits(250000UL) == 0x02, "F_CPU/64");
+static_assert(SPI::hardwareClockBits(125000UL) == 0x03, "F_CPU/128");
+static_assert(SPI::hardwareClockBits(7999999UL) == 0x00, "just below F_CPU/2 rounds down");
+static_assert(SPI::hardwareClockBits(4000001UL) == 0x00, "just above F_CPU/4 stays there");
+static_assert(SPI::hardwareClockBits(249999UL) == 0x03, "just below F_CPU/64");
+static_assert(SPI::hardwareClockBits(20000000UL) == 0x80, "above F_CPU/2 clamps");
+static_assert(SPI::hardwareClockBits(1UL) == 0x03, "below F_CPU/128 clamps");
+
+static_assert(SPI::loopsForNanoseconds(0) == 0, "no delay");
+static_assert(SPI::loopsForNanoseconds(1) == 1, "any delay is one loop");
+static_assert(SPI::loopsForNanoseconds(250) == 1, "one loop is 250 ns");
+static_assert(SPI::loopsForNanoseconds(251) == 2, "rounded up");
+static_assert(SPI::loopsForNanoseconds(16383750UL) == 0xFFFF, "longest");
+static_assert(SPI::loopsForNanoseconds(16383751UL) == 0xFFFF, "clamped");
+static_assert(SPI::loopsForNanoseconds(100000000UL) == 0xFFFF, "clamped before overflow");
+static_assert(SPI::loopsForNanoseconds(0xFFFFFFFFUL) == 0xFFFF, "clamped before overflow");
+
+static_assert(SPI::loopsForClockHz(0) == 0xFFFF, "stopped clock is the slowest");
+static_assert(SPI::loopsForClockHz(1000000UL) == 2, "8 cycles per phase");
+static_assert(SPI::loopsForClockHz(2000000UL) == 1, "4 cycles per phase");
+static_assert(SPI::loopsForClockHz(1999999UL) == 2, "just below rounds down");
+static_assert(SPI::loopsForClockHz(8000000UL) == 1, "the loop floor");
+static_assert(SPI::loopsForClockHz(10UL) == 0xFFFF, "clamped");
+
+static_assert(SPIClock<4000000UL>::LOOPS == 1 && SPIClock<4000000UL>::HW_BITS == 0x00, "SPIClock");
+static_assert(SPIClock<125000UL>::LOOPS == 16 && SPIClock<125000UL>::HW_BITS == 0x03, "SPIClock");
+
+// setDelaysMicroseconds() takes integers only
+template <class Low, class High>
+static constexpr auto acceptsDelays(int)
+    -> decltype(std::declval<SPI &>().setDelaysMicroseconds(Low(), High()), true) {
+    return true;
+}
+template <class, class>
+static constexpr bool acceptsDelays(...) {
+    return false;
+}
+static_assert(acceptsDelays<int, int>(0) && acceptsDelays<uint16_t, long>(0), "integers");
+static_assert(!acceptsDelays<double, double>(0), "double");
+static_assert(!acceptsDelays<float, int>(0) && !acceptsDelays<int, float>(0), "mixed");
+
+static const uint16_t DIVIDERS[4] = {4, 16, 64, 128};
+
+static uint16_t divider(uint8_t bits) {
+    return static_cast<uint16_t>(DIVIDERS[bits & 0x03] / ((bits & 0x80) ? 2 : 1));
+}
+
+static long hardwareViolations(uint32_t hz) {
+    uint16_t d = divider(SPI::hardwareClockBits(hz));
+    long bad = 0;
+    if (d != 128 && F_CPU / d > hz) {
+        ++bad; // faster than asked
+    }
+    if (d != 2 && F_CPU / (d / 2) <= hz) {
+        ++bad; // a faster divider would have fit
+    }
+    return bad;
+}
+
+// Phases of loops * 4 cycles against the nanoseconds asked for
+static long loopViolations(uint32_t ns, uint16_t loops) {
+    double cycles = ns * (F_CPU / 1e9);
+    if (ns == 0) {
+        return loops != 0;
+    }
+    if (loops == 0xFFFF) {
+        return cycles < 4.0 * 0xFFFF;
+    }
+    return (4.0 * loops < cycles - 1e-9) + (4.0 * (loops - 1) >= cycles);
+}
+
+static void sweeps() {
+    long hardwareBad = 0;
+    long clockBad = 0;
+    long nsBad = 0;
+    long checked = 0;
+    for (uint8_t step = 0; step < 7; ++step) {
+        uint32_t edge = (F_CPU / 2UL) >> step;
+        for (uint32_t hz = edge - 1000; hz <= edge + 1000; ++hz, ++checked) {
+            hardwareBad += hardwareViolations(hz);
+        }
+    }
+    for (uint32_t hz = 1; hz < 40000000UL; hz += 1 + hz / 1000, ++checked) {
+        hardwareBad += hardwareViolations(hz);
+        // Half period rounded up to whole nanoseconds first
+        uint32_t halfNs = (500000000UL + hz - 1) / hz;
+        uint16_t loops = SPI::loopsForClockHz(hz);
+        clockBad += loopViolations(halfNs, loops);
+        clockBad += 4.0 * loops < F_CPU / 2.0 / hz - 1e-9 && loops != 0xFFFF;
+    }
+    for (uint32_t ns = 0; ns < 20000; ++ns, ++checked) {
+        nsBad += loopViolations(ns, SPI::loopsForNanoseconds(ns));
+    }
+    for (uint32_t ns = 20000; ns < 0xF0000000UL; ns += 1 + ns / 777, ++checked) {
+        nsBad += loopViolations(ns, SPI::loopsForNanoseconds(ns));
+    }
+    printf("sweeps: %ld values, hardware divider %ld, clock loops %ld, nanosecond loops %ld violations\n",
+           checked, hardwareBad, clockBad, nsBad);
+    EXPECT(hardwareBad == 0 && clockBad == 0 && nsBad == 0);
+}
+
+// One byte on the peripheral and one paced software byte for each setup
+template <uint32_t Hz>
+static void sameSetup() {
+    simSpiBus.attach();
+    PORTB = (1 << PB2);
+    SPI byHz(&PINB, &DDRB, &PORTB, PB3, &PINB, &DDRB, &PORTB, PB4, &PINB, &DDRB, &PORTB, PB5,
+             &PINB, &DDRB, &PORTB, PB2);
+    SPI byType(&PINB, &DDRB, &PORTB, PB3, &PINB, &DDRB, &PORTB, PB4, &PINB, &DDRB, &PORTB, PB5,
+               &PINB, &DDRB, &PORTB, PB2);
+    byHz.setClockHz(Hz);
+    byType.setClock<SPIClock<Hz> >();
+
+    double start = hostTimeUs;
+    byHz.transferByte(0x00);
+    double softHz = hostTimeUs - start;
+    start = hostTimeUs;
+    byType.transferByte(0x00);
+    double softType = hostTimeUs - start;
+
+    EXPECT(byHz.setBackend(SPI::Backend::Hardware) && byType.setBackend(SPI::Backend::Hardware));
+    byHz.transferByte(0x00);
+    byType.transferByte(0x00);
+    bool same = simSpiBus.transfers.size() == 2 && simSpiBus.transfers[0].spcr == simSpiBus.transfers[1].spcr &&
+                simSpiBus.transfers[0].spsr == simSpiBus.transfers[1].spsr && softHz == softType;
+    uint8_t spcr = simSpiBus.transfers.empty() ? 0 : simSpiBus.transfers[0].spcr;
+    printf("%8lu Hz  setClockHz() and SPIClock agree: %s (SPR %u, software byte %.2f us)\n",
+           static_cast<unsigned long>(Hz), same ? "yes" : "NO", spcr & 0x03, softHz);
+    EXPECT(same);
+}
+
+int main() {
+    sweeps();
+    sameSetup<8000000UL>();
+    sameSetup<1000000UL>();
+    sameSetup<333333UL>();
+    sameSetup<100000UL>();
+    return hostFailures();
+}
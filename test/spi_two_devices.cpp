@@ -0,0 +1,108 @@
+// Devices with different setups sharing the SPI pins: two Hardware devices
+// (mode 0 MSB first at F_CPU/2, mode 3 LSB first at F_CPU/16) and a Software
+// device bit-banging PB3/PB5 in mode 0, each on its own chip select, all
+// configured up front and then used in turn. Every transfer on the
+// peripheral must run with its own device's SPCR/SPSR, every slave must get
+// its own bytes and replies, and the Software device must get the pins back
+// from the peripheral.
+#include <string.h>
+#include <protocol_SPI.h>
+#include "spi_sim.h"
+
+struct Device {
+    const char *name;
+    SPI *spi;
+    SimSpiSlave slave;
+    uint8_t spcr; // expected on the peripheral, 0 for software
+    uint8_t spsr;
+    std::vector<uint8_t> sent;
+    std::vector<uint8_t> read;
+};
+
+static SPI makeSpi(uint8_t csBit) {
+    return SPI(&PINB, &DDRB, &PORTB, PB3, &PINB, &DDRB, &PORTB, PB4, &PINB, &DDRB, &PORTB, PB5,
+               &PINB, &DDRB, &PORTB, csBit);
+}
+
+int main() {
+    hostSeed(4);
+    simSpiBus.attach();
+    simSpiBus.wireSoftware(&PORTB, &PINB, PB5, &PORTB, PB3, &PINB, PB4);
+    PINB = DDRB = 0;
+    PORTB = (1 << PB2) | (1 << PB1) | (1 << PB0); // every chip select released
+
+    SPI fast = makeSpi(PB2);
+    SPI slow = makeSpi(PB1);
+    SPI soft = makeSpi(PB0);
+    Device devices[3] = {
+        {"hardware, mode 0 MSB, F_CPU/2", &fast, SimSpiSlave(), 0x50, 0x01, {}, {}},
+        {"hardware, mode 3 LSB, F_CPU/16", &slow, SimSpiSlave(), 0x7D, 0x00, {}, {}},
+        {"software, mode 0 MSB, paced", &soft, SimSpiSlave(), 0, 0, {}, {}},
+    };
+    devices[1].slave.mode = 3;
+    devices[1].slave.lsbFirst = true;
+    simSpiBus.addSlave(&devices[0].slave, &PORTB, PB2);
+    simSpiBus.addSlave(&devices[1].slave, &PORTB, PB1);
+    simSpiBus.addSlave(&devices[2].slave, &PORTB, PB0);
+    for (int d = 0; d < 3; ++d) {
+        for (int i = 0; i < 256; ++i) {
+            devices[d].slave.replies.push_back(static_cast<uint8_t>(hostRandom() * 256));
+        }
+    }
+
+    fast.begin();
+    EXPECT(fast.setBackend(SPI::Backend::Hardware));
+    fast.setClockHz(8000000UL);
+    slow.begin();
+    EXPECT(slow.setBackend(SPI::Backend::Hardware));
+    slow.setDataMode(3);
+    slow.setBitOrder(SPI::BitOrder::LSBFirst);
+    slow.setClockHz(1000000UL);
+    soft.begin();
+    soft.setDelayLoops(2, 2);
+
+    // Round robin, so every device follows one with another setup
+    for (int round = 0; round < 8; ++round) {
+        for (int d = 0; d < 3; ++d) {
+            Device &dev = devices[d];
+            uint8_t tx[8];
+            uint8_t rx[8];
+            for (size_t i = 0; i < sizeof(tx); ++i) {
+                tx[i] = static_cast<uint8_t>(hostRandom() * 256);
+            }
+            size_t length = 1 + (round + d) % sizeof(tx);
+            dev.spi->transferBytes(tx, rx, length);
+            dev.sent.insert(dev.sent.end(), tx, tx + length);
+            dev.read.insert(dev.read.end(), rx, rx + length);
+        }
+    }
+
+    // Each byte on the peripheral with the setup of the device selected
+    long wrongSetup = 0;
+    size_t hardwareBytes = 0;
+    for (size_t i = 0; i < simSpiBus.transfers.size(); ++i) {
+        const SimSpiBus::Transfer &t = simSpiBus.transfers[i];
+        if (t.slave < 0 || t.spcr != devices[t.slave].spcr || t.spsr != devices[t.slave].spsr) {
+            ++wrongSetup;
+        }
+    }
+    for (int d = 0; d < 3; ++d) {
+        Device &dev = devices[d];
+        bool sentOk = dev.slave.received == dev.sent;
+        bool readOk = dev.read.size() <= dev.slave.replies.size() &&
+                      memcmp(dev.read.data(), dev.slave.replies.data(), dev.read.size()) == 0;
+        printf("%-32s %2u bytes, sent %s, read %s, transactions %ld, idle errors %ld\n", dev.name,
+               static_cast<unsigned>(dev.sent.size()), sentOk ? "ok" : "BAD", readOk ? "ok" : "BAD",
+               dev.slave.transactions, dev.slave.idleErrors);
+        EXPECT(sentOk && readOk);
+        EXPECT(dev.slave.transactions == 8 && dev.slave.idleErrors == 0 && dev.slave.partialBytes == 0);
+        if (dev.spcr) {
+            hardwareBytes += dev.sent.size();
+        }
+    }
+    printf("peripheral: %u bytes, %ld with another device's setup, %ld write collisions\n",
+           static_cast<unsigned>(simSpiBus.transfers.size()), wrongSetup, simSpiBus.collisions);
+    EXPECT(simSpiBus.transfers.size() == hardwareBytes);
+    EXPECT(wrongSetup == 0 && simSpiBus.collisions == 0);
+    return hostFailures();
+}
@@ -0,0 +1,122 @@
+// Timer1 COMPB RX engine against the simulated Timer1: two senders stream
+// an incrementing counter into two UARTs on PIND, with random idle time
+// between frames, so their start edges and bit centers interleave. The main
+// loop drains both receivers every ~1 ms while a third UART keeps the timer
+// TX engine busy, as in example/UART/dual_rx_bench.cpp. Every byte must
+// arrive once and in order, with no frame errors or buffer overflows.
+//
+// Bit centers closer than RX_SAMPLE_SLACK_TICKS are sampled in one COMPB
+// vector, so fewer vectors than samples run; with the two streams in step
+// (start edges inside the same pin-change vector) about half as many.
+//
+// Each vector costs 80 cycles here. At 38400 baud and above, a start edge
+// stamped one vector late plus a sample held off by another vector lands
+// outside the bit, so the cases stop at 19200.
+#include <protocol_UART.h>
+#include "timer1_sim.h"
+
+struct Stream {
+    UART *uart;
+    uint8_t pin;
+    double cyclesPerBit;
+    uint64_t nextStart;
+    uint8_t nextValue;
+    int last;
+    long received;
+    long misordered;
+    double maxIdle;
+};
+
+struct Scenario {
+    const char *name;
+    unsigned long baudA;
+    unsigned long baudB;
+    double skewA;       // sender bit time / nominal
+    double skewB;
+    uint64_t offsetB;   // first start edge of B after A's, in cycles
+    double maxIdleBits; // random idle time between frames
+    bool busyTx;
+    bool expectShared;  // about one COMPB vector per two samples
+};
+
+static const long FRAMES = 2000;
+
+static void schedule(Stream &s, long &sent) {
+    // Keep about 20 frames ahead of the simulated clock
+    while (sent < FRAMES && s.nextStart < simTimer1.cycles + 20 * 10 * s.cyclesPerBit) {
+        uint64_t end = simTimer1.driveUartFrame(s.nextStart, &PIND, s.pin, s.nextValue, s.cyclesPerBit);
+        s.nextValue = static_cast<uint8_t>(s.nextValue + 1);
+        s.nextStart = end + static_cast<uint64_t>(hostRandom() * s.maxIdle);
+        ++sent;
+    }
+}
+
+static void drain(Stream &s) {
+    int c;
+    while ((c = s.uart->read()) >= 0) {
+        if (s.last >= 0 && c != ((s.last + 1) & 0xFF)) {
+            ++s.misordered;
+        }
+        s.last = c;
+        ++s.received;
+    }
+}
+
+static void run(const Scenario &sc) {
+    simTimer1.attach();
+    hostSeed(41);
+    UART a(&PIND, &DDRD, &PORTD, PD5, &PIND, &DDRD, &PORTD, PD4, sc.baudA);
+    UART b(&PIND, &DDRD, &PORTD, PD6, &PIND, &DDRD, &PORTD, PD3, sc.baudB);
+    UART debug(&PIND, &DDRD, &PORTD, PD1, &PIND, &DDRD, &PORTD, PD0, 57600UL);
+    EXPECT(a.setRxMode(UART::RxMode::Timer));
+    EXPECT(b.setRxMode(UART::RxMode::Timer));
+    if (sc.busyTx) {
+        EXPECT(debug.setTxMode(UART::TxMode::Timer));
+    }
+    SREG = (1 << SREG_I);
+
+    double bitA = 16e6 / sc.baudA * sc.skewA;
+    double bitB = 16e6 / sc.baudB * sc.skewB;
+    Stream sa = {&a, PD4, bitA, 1000, 0, -1, 0, 0, sc.maxIdleBits * bitA};
+    Stream sb = {&b, PD3, bitB, 1000 + sc.offsetB, 0x80, -1, 0, 0, sc.maxIdleBits * bitB};
+    long sentA = 0;
+    long sentB = 0;
+    while (sentA < FRAMES || sentB < FRAMES || simTimer1.cycles < sa.nextStart + 20 * sa.cyclesPerBit ||
+           simTimer1.cycles < sb.nextStart + 20 * sb.cyclesPerBit) {
+        schedule(sa, sentA);
+        schedule(sb, sentB);
+        simTimer1.run(simTimer1.cycles + 16000);
+        drain(sa);
+        drain(sb);
+        if (sc.busyTx && debug.txPending() < 8) {
+            debug.sendString("0123456789");
+        }
+    }
+
+    long samples = (sa.received + sb.received) * 10;
+    printf("%-36s A %ld/%ld B %ld/%ld, misordered %ld/%ld, frame errors %u/%u, overflows %u/%u, COMPB %ld for %ld samples\n",
+           sc.name, sa.received, FRAMES, sb.received, FRAMES, sa.misordered, sb.misordered,
+           a.frameErrorCount(), b.frameErrorCount(), a.overflowCount(), b.overflowCount(),
+           simTimer1.compBVectors, samples);
+    EXPECT(sa.received == FRAMES && sb.received == FRAMES);
+    EXPECT(sa.misordered == 0 && sb.misordered == 0);
+    EXPECT(a.frameErrorCount() == 0 && b.frameErrorCount() == 0);
+    EXPECT(a.overflowCount() == 0 && b.overflowCount() == 0);
+    EXPECT(simTimer1.compBVectors < samples);
+    if (sc.expectShared) {
+        EXPECT(simTimer1.compBVectors < samples * 6 / 10);
+    }
+}
+
+int main() {
+    static const Scenario SCENARIOS[] = {
+        {"9600 + 9600, random phase", 9600UL, 9600UL, 1.0, 1.0, 5003, 2.5, true, false},
+        {"19200 + 19200, senders 1.5% off", 19200UL, 19200UL, 1.015, 0.985, 777, 1.5, true, false},
+        {"9600 + 19200, back to back", 9600UL, 19200UL, 1.0, 1.0, 333, 0.0, true, false},
+        {"19200 + 19200 in step", 19200UL, 19200UL, 1.0, 1.0, 10, 0.0, true, true},
+    };
+    for (size_t i = 0; i < sizeof(SCENARIOS) / sizeof(SCENARIOS[0]); ++i) {
+        run(SCENARIOS[i]);
+    }
+    return hostFailures();
+}
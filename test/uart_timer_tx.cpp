@@ -0,0 +1,182 @@
+// Timer1 COMPA TX engine against the simulated Timer1. The TX pins are
+// watched and every edge is stamped with the compare match that drove it,
+// so the waveform can be checked to the cycle: each frame is a start bit, 8
+// data bits LSB first and a stop bit on the bitTicks grid, followed by
+// interByteGapBits idle bits. Covers one UART, the hand-off between two
+// UARTs with different baud rates and gaps, and flushTx()/queueTx()
+// servicing COMPA by polling with interrupts off.
+#include <string.h>
+#include <vector>
+#include <protocol_UART.h>
+#include "timer1_sim.h"
+
+static const uint16_t LEAD_TICKS = 128; // TX_START_LEAD_TICKS
+
+struct Frames {
+    std::vector<uint8_t> bytes;
+    std::vector<uint64_t> starts;
+    long offGrid;    // edges not on a bit boundary of their frame
+    long badFrames;  // missing stop bit, or the gap cut short
+};
+
+static bool levelAt(uint8_t watch, uint64_t cycle) {
+    bool high = true;
+    for (size_t i = 0; i < simTimer1.edges.size(); ++i) {
+        const SimTimer1::Edge &e = simTimer1.edges[i];
+        if (e.cycle > cycle) {
+            break;
+        }
+        if (e.watch == watch) {
+            high = e.high;
+        }
+    }
+    return high;
+}
+
+// Decodes the frames on one watched pin at the given bit time and gap
+static Frames decode(uint8_t watch, uint16_t bitTicks, uint8_t gapBits) {
+    Frames f = {std::vector<uint8_t>(), std::vector<uint64_t>(), 0, 0};
+    uint64_t frameEnd = 0;
+    uint64_t start = 0;
+    for (size_t i = 0; i < simTimer1.edges.size(); ++i) {
+        const SimTimer1::Edge &e = simTimer1.edges[i];
+        if (e.watch != watch) {
+            continue;
+        }
+        if (e.cycle >= frameEnd && !e.high) {
+            // Start bit; the previous frame's gap must have passed
+            if (!f.starts.empty() && e.cycle < frameEnd + static_cast<uint64_t>(gapBits) * bitTicks) {
+                ++f.badFrames;
+            }
+            start = e.cycle;
+            frameEnd = start + 10ULL * bitTicks;
+            uint8_t value = 0;
+            for (uint8_t bit = 0; bit < 8; ++bit) {
+                if (levelAt(watch, start + (bit + 1) * bitTicks + bitTicks / 2)) {
+                    value |= static_cast<uint8_t>(1U << bit);
+                }
+            }
+            if (!levelAt(watch, start + 9ULL * bitTicks + bitTicks / 2)) {
+                ++f.badFrames;
+            }
+            f.bytes.push_back(value);
+            f.starts.push_back(start);
+        } else if ((e.cycle - start) % bitTicks != 0) {
+            ++f.offGrid;
+        }
+    }
+    return f;
+}
+
+static bool txIdle() {
+    return !(TIMSK1 & (1 << OCIE1A));
+}
+
+static bool spacedBy(const Frames &f, size_t from, size_t to, uint64_t cycles) {
+    for (size_t i = from + 1; i < to; ++i) {
+        if (f.starts[i] - f.starts[i - 1] != cycles) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void singleUart() {
+    simTimer1.attach();
+    UART uart(&PIND, &DDRD, &PORTD, PD3, &PIND, &DDRD, &PORTD, PD2, 57600UL);
+    simTimer1.watch(&PORTD, PD3);
+    EXPECT(uart.setTxMode(UART::TxMode::Timer));
+    SREG = (1 << SREG_I);
+
+    uint64_t armed = simTimer1.cycles;
+    uart.sendString("Hello");
+    EXPECT(uart.txPending() == 5);
+    simTimer1.run(armed + 2000000, txIdle);
+
+    const uint16_t bitTicks = 16000000UL / 57600UL;
+    Frames f = decode(0, bitTicks, 1);
+    printf("one UART, 57600 baud, gap 1       %u frames \"%.*s\", first start +%llu, off grid %ld, bad %ld\n",
+           static_cast<unsigned>(f.bytes.size()), static_cast<int>(f.bytes.size()),
+           reinterpret_cast<const char *>(f.bytes.data()),
+           static_cast<unsigned long long>(f.starts.empty() ? 0 : f.starts[0] - armed), f.offGrid, f.badFrames);
+    EXPECT(f.bytes.size() == 5 && memcmp(f.bytes.data(), "Hello", 5) == 0);
+    EXPECT(!f.starts.empty() && f.starts[0] - armed == LEAD_TICKS);
+    EXPECT(spacedBy(f, 0, f.starts.size(), 11ULL * bitTicks));
+    EXPECT(f.offGrid == 0 && f.badFrames == 0);
+    EXPECT(uart.txPending() == 0);
+    EXPECT(simTimer1.compAVectors == 5 * 11 + 1); // one bit per vector, plus the idle one
+}
+
+static void twoUarts() {
+    simTimer1.attach();
+    UART a(&PIND, &DDRD, &PORTD, PD3, &PIND, &DDRD, &PORTD, PD2, 57600UL);
+    UART b(&PIND, &DDRD, &PORTD, PD4, &PIND, &DDRD, &PORTD, PD5, 38400UL);
+    simTimer1.watch(&PORTD, PD3);
+    simTimer1.watch(&PORTD, PD4);
+    EXPECT(a.setTxMode(UART::TxMode::Timer));
+    EXPECT(b.setTxMode(UART::TxMode::Timer));
+    b.setInterByteGap(2);
+    SREG = (1 << SREG_I);
+
+    const uint16_t ticksA = 16000000UL / 57600UL;
+    const uint16_t ticksB = 16000000UL / 38400UL;
+    a.sendString("AB");
+    b.sendString("xyz");
+    // A more byte for A once B has the line: it waits for B to drain
+    simTimer1.run(simTimer1.cycles + 3 * 11 * ticksA);
+    a.sendString("C");
+    simTimer1.run(simTimer1.cycles + 2000000, txIdle);
+
+    Frames fa = decode(0, ticksA, 1);
+    Frames fb = decode(1, ticksB, 2);
+    printf("two UARTs, 57600/gap 1 + 38400/gap 2  A \"%.*s\" B \"%.*s\", off grid %ld/%ld, bad %ld/%ld\n",
+           static_cast<int>(fa.bytes.size()), reinterpret_cast<const char *>(fa.bytes.data()),
+           static_cast<int>(fb.bytes.size()), reinterpret_cast<const char *>(fb.bytes.data()),
+           fa.offGrid, fb.offGrid, fa.badFrames, fb.badFrames);
+    EXPECT(fa.bytes.size() == 3 && memcmp(fa.bytes.data(), "ABC", 3) == 0);
+    EXPECT(fb.bytes.size() == 3 && memcmp(fb.bytes.data(), "xyz", 3) == 0);
+    EXPECT(fa.offGrid == 0 && fb.offGrid == 0 && fa.badFrames == 0 && fb.badFrames == 0);
+    if (fa.starts.size() == 3 && fb.starts.size() == 3) {
+        // A's queue drains first, B takes over at A's next frame boundary,
+        // and A gets the line back once B is empty
+        EXPECT(fa.starts[1] - fa.starts[0] == 11ULL * ticksA);
+        EXPECT(fb.starts[0] - fa.starts[1] == 11ULL * ticksA);
+        EXPECT(spacedBy(fb, 0, 3, 12ULL * ticksB));
+        EXPECT(fa.starts[2] - fb.starts[2] == 12ULL * ticksB);
+    }
+}
+
+static void pollingWithInterruptsOff() {
+    simTimer1.attach();
+    UART uart(&PIND, &DDRD, &PORTD, PD3, &PIND, &DDRD, &PORTD, PD2, 115200UL);
+    simTimer1.watch(&PORTD, PD3);
+    EXPECT(uart.setTxMode(UART::TxMode::Timer));
+    SREG = 0;
+
+    // 40 bytes overrun the 32-byte queue, so queueTx() polls as well
+    uint8_t data[40];
+    for (uint8_t i = 0; i < sizeof(data); ++i) {
+        data[i] = static_cast<uint8_t>(i * 37 + 5);
+    }
+    uint64_t armed = simTimer1.cycles;
+    uart.sendBytes(data, sizeof(data));
+    uart.flushTx();
+
+    const uint16_t bitTicks = 16000000UL / 115200UL;
+    Frames f = decode(0, bitTicks, 1);
+    printf("interrupts off, 115200 baud       %u of 40 bytes by polling, off grid %ld, bad %ld, pending %u\n",
+           static_cast<unsigned>(f.bytes.size()), f.offGrid, f.badFrames, uart.txPending());
+    EXPECT(f.bytes.size() == sizeof(data) && memcmp(f.bytes.data(), data, sizeof(data)) == 0);
+    EXPECT(!f.starts.empty() && f.starts[0] - armed == LEAD_TICKS);
+    EXPECT(spacedBy(f, 0, f.starts.size(), 11ULL * bitTicks));
+    EXPECT(f.offGrid == 0 && f.badFrames == 0);
+    EXPECT(uart.txPending() == 0);
+    EXPECT(simTimer1.compAVectors == 0);
+}
+
+int main() {
+    singleUart();
+    twoUarts();
+    pollingWithInterruptsOff();
+    return hostFailures();
+}